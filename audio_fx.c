@@ -0,0 +1,394 @@
+#include "audio_fx.h"
+#include "audio_mixer.h"
+#include <string.h>
+
+#define FX_RATE (AUDIO_SAMPLE_RATE / AUDIO_FX_DECIMATE)
+#define FX_MIN_DELAY 256 /* Shortest usable delay line, samples (23ms) */
+#define FX_FADE_STEP 4   /* Return fade-in per step, Q8 (64 steps = 23ms) */
+
+/* Delay line storage: 4-bit ADPCM (default) or plain 16-bit, which is
+ * exact but holds a quarter of the time in the same RAM */
+#ifndef FX_DELAY_16BIT
+#define FX_DELAY_16BIT 0
+#endif
+
+/* IMA ADPCM: 4 bits per sample, decoded in the order it was encoded.
+ * The step never drops below ADPCM_MIN_INDEX so onsets out of silence
+ * are followed within a few samples (idle noise stays near -70dB). */
+#define ADPCM_MIN_INDEX 32
+#define ADPCM_SILENCE 0x80 /* Code pair +step/8, -step/8: decodes to ~0 */
+typedef struct {
+  int16_t predictor;
+  uint8_t index;
+} AdpcmState;
+
+static const int16_t adpcm_steps[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t adpcm_index_step[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+/* Delay line: the sample read back is the one written `length` ago */
+typedef struct {
+  uint8_t *data; /* Two samples per byte (ADPCM) */
+  uint32_t length; /* Even, so the silence pattern leaves no offset */
+  uint32_t pos;
+  AdpcmState writer;
+  AdpcmState reader;
+} DelayLine;
+
+/* Reverb (Schroeder): parallel damped combs into series allpasses */
+#define REVERB_COMBS 4
+#define REVERB_ALLPASSES 2
+static const uint16_t comb_lengths[REVERB_COMBS] = {151, 167, 181, 199};
+static const uint16_t allpass_lengths[REVERB_ALLPASSES] = {61, 29};
+
+typedef struct {
+  int16_t *line;
+  uint16_t length;
+  uint16_t pos;
+  int32_t damped; /* One-pole low-pass in the feedback path */
+} Comb;
+
+typedef struct {
+  int16_t *line;
+  uint16_t length;
+  uint16_t pos;
+} Allpass;
+
+/* Effects RAM layout */
+static DelayLine delay_lines[2];    /* Left, right (ping-pong) */
+static uint32_t delay_capacity = 0; /* Samples per line, 0 = no delay */
+static Comb combs[REVERB_COMBS];
+static Allpass allpasses[REVERB_ALLPASSES];
+static uint8_t reverb_ok = 0;
+static uint32_t ram_used = 0;
+
+/* Settings (main loop), applied at the start of each pass */
+static volatile uint16_t tempo = 120;
+static volatile uint8_t delay_division = AUDIO_FX_DIV_8TH;
+static volatile uint8_t delay_feedback = 128;
+static volatile uint8_t delay_level = 0;
+static volatile uint8_t reverb_size = 128;
+static volatile uint8_t reverb_damping = 128;
+static volatile uint8_t reverb_level = 0;
+
+/* Running state (audio interrupt) */
+static int32_t wet_l = 0; /* Last wet output, for interpolation */
+static int32_t wet_r = 0;
+static int32_t fade = 0;  /* Return gain after a bypass, Q8 */
+static volatile uint32_t stat_bypassed = 0;
+
+static int16_t saturate16(int32_t x) {
+  if (x > 32767)
+    return 32767;
+  if (x < -32768)
+    return -32768;
+  return (int16_t)x;
+}
+
+/**
+ * @brief Update an ADPCM state by one code (shared by coder and decoder)
+ * @return Reconstructed sample
+ */
+static int16_t adpcm_update(AdpcmState *s, uint8_t code) {
+  int32_t step = adpcm_steps[s->index];
+  int32_t diff = step >> 3;
+  if (code & 4)
+    diff += step;
+  if (code & 2)
+    diff += step >> 1;
+  if (code & 1)
+    diff += step >> 2;
+
+  s->predictor = saturate16(s->predictor + ((code & 8) ? -diff : diff));
+
+  int32_t index = s->index + adpcm_index_step[code & 7];
+  if (index < ADPCM_MIN_INDEX)
+    index = ADPCM_MIN_INDEX;
+  s->index = (uint8_t)((index > 88) ? 88 : index);
+  return s->predictor;
+}
+
+static uint8_t adpcm_encode(AdpcmState *s, int16_t sample) {
+  int32_t diff = sample - s->predictor;
+  int32_t step = adpcm_steps[s->index];
+  uint8_t code = 0;
+
+  if (diff < 0) {
+    code = 8;
+    diff = -diff;
+  }
+  if (diff >= step) {
+    code |= 4;
+    diff -= step;
+  }
+  if (diff >= step >> 1) {
+    code |= 2;
+    diff -= step >> 1;
+  }
+  if (diff >= step >> 2)
+    code |= 1;
+
+  adpcm_update(s, code);
+  return code;
+}
+
+/**
+ * @brief Read the oldest sample of a delay line
+ * @details Must be followed by delay_write(), which replaces it.
+ */
+static int16_t delay_read(DelayLine *d) {
+#if FX_DELAY_16BIT
+  return ((int16_t *)d->data)[d->pos];
+#else
+  uint8_t shift = (d->pos & 1) ? 4 : 0;
+  return adpcm_update(&d->reader, (d->data[d->pos >> 1] >> shift) & 0x0F);
+#endif
+}
+
+static void delay_write(DelayLine *d, int16_t in) {
+#if FX_DELAY_16BIT
+  ((int16_t *)d->data)[d->pos] = in;
+#else
+  uint8_t *byte = &d->data[d->pos >> 1];
+  uint8_t shift = (d->pos & 1) ? 4 : 0;
+  uint8_t code = adpcm_encode(&d->writer, in);
+  *byte = (uint8_t)((*byte & ~(0x0F << shift)) | (code << shift));
+#endif
+
+  if (++d->pos >= d->length)
+    d->pos = 0;
+}
+
+/**
+ * @brief Empty a delay line and set its length
+ * @details The reader works through the silence pattern and arrives at
+ *          the writer's first code in the writer's initial state.
+ */
+static void delay_reset(DelayLine *d, uint32_t length) {
+#if FX_DELAY_16BIT
+  memset(d->data, 0, delay_capacity * sizeof(int16_t));
+#else
+  memset(d->data, ADPCM_SILENCE, delay_capacity / 2);
+#endif
+  d->writer.predictor = 0;
+  d->writer.index = ADPCM_MIN_INDEX;
+  d->reader = d->writer;
+  d->length = length;
+  d->pos = 0;
+}
+
+/**
+ * @brief Delay length for the current tempo and division
+ * @details Halved until it fits, so it stays on the beat grid.
+ */
+static uint32_t delay_length(void) {
+  static const uint8_t sixteenths[] = {1, 2, 3, 4};
+  uint8_t division = delay_division;
+  if (division > AUDIO_FX_DIV_4TH)
+    division = AUDIO_FX_DIV_4TH;
+
+  uint32_t bpm = tempo ? tempo : 120;
+  uint32_t length = sixteenths[division] * 15 * FX_RATE / bpm;
+  while (length > delay_capacity)
+    length /= 2;
+  return (length & ~1u) ? (length & ~1u) : 2;
+}
+
+int AudioFx_Init(void *ram, uint32_t bytes) {
+  uint8_t *p = (uint8_t *)ram;
+
+  /* Reverb first: fixed size */
+  uint32_t reverb_bytes = 0;
+  for (int i = 0; i < REVERB_COMBS; i++)
+    reverb_bytes += comb_lengths[i] * sizeof(int16_t);
+  for (int i = 0; i < REVERB_ALLPASSES; i++)
+    reverb_bytes += allpass_lengths[i] * sizeof(int16_t);
+
+  reverb_ok = (ram != NULL && bytes >= reverb_bytes);
+  ram_used = 0;
+  if (reverb_ok) {
+    for (int i = 0; i < REVERB_COMBS; i++) {
+      combs[i].line = (int16_t *)p;
+      combs[i].length = comb_lengths[i];
+      combs[i].pos = 0;
+      combs[i].damped = 0;
+      memset(p, 0, comb_lengths[i] * sizeof(int16_t));
+      p += comb_lengths[i] * sizeof(int16_t);
+    }
+    for (int i = 0; i < REVERB_ALLPASSES; i++) {
+      allpasses[i].line = (int16_t *)p;
+      allpasses[i].length = allpass_lengths[i];
+      allpasses[i].pos = 0;
+      memset(p, 0, allpass_lengths[i] * sizeof(int16_t));
+      p += allpass_lengths[i] * sizeof(int16_t);
+    }
+    bytes -= reverb_bytes;
+    ram_used = reverb_bytes;
+  }
+
+  /* Delay: the rest, split into two lines */
+#if FX_DELAY_16BIT
+  uint32_t line_bytes = (bytes / 4) * 2;
+  delay_capacity = line_bytes / 2;
+#else
+  uint32_t line_bytes = bytes / 2;
+  delay_capacity = line_bytes * 2;
+#endif
+  if (ram == NULL || delay_capacity < FX_MIN_DELAY)
+    delay_capacity = 0;
+  if (delay_capacity) {
+    for (int i = 0; i < 2; i++) {
+      delay_lines[i].data = p;
+      p += line_bytes;
+      delay_reset(&delay_lines[i], delay_length());
+    }
+    ram_used += line_bytes * 2;
+  }
+
+  wet_l = 0;
+  wet_r = 0;
+  fade = 0;
+  stat_bypassed = 0;
+  return (reverb_ok || delay_capacity) ? 0 : -1;
+}
+
+void AudioFx_SetTempo(uint16_t bpm) { tempo = bpm; }
+
+void AudioFx_SetDelay(uint8_t division, uint8_t feedback, uint8_t level) {
+  delay_division = division;
+  delay_feedback = feedback;
+  delay_level = level;
+}
+
+void AudioFx_SetReverb(uint8_t size, uint8_t damping, uint8_t level) {
+  reverb_size = size;
+  reverb_damping = damping;
+  reverb_level = level;
+}
+
+uint8_t AudioFx_IsActive(void) {
+  return (delay_level && delay_capacity) || (reverb_level && reverb_ok);
+}
+
+/**
+ * @brief One reverb step
+ * @param in Input sample
+ * @param out_r Set to the right output (tapped after the first allpass)
+ * @return Left output
+ */
+static int32_t reverb_tick(int32_t in, int32_t feedback, int32_t damping,
+                           int32_t *out_r) {
+  int32_t sum = 0;
+  for (int i = 0; i < REVERB_COMBS; i++) {
+    Comb *c = &combs[i];
+    int32_t y = c->line[c->pos];
+    c->damped = y + (((c->damped - y) * damping) >> 8);
+    c->line[c->pos] = saturate16(in + ((c->damped * feedback) >> 8));
+    if (++c->pos >= c->length)
+      c->pos = 0;
+    sum += y;
+  }
+
+  int32_t x = sum >> 2;
+  for (int i = 0; i < REVERB_ALLPASSES; i++) {
+    Allpass *a = &allpasses[i];
+    int32_t b = a->line[a->pos];
+    a->line[a->pos] = saturate16(x + (b >> 1));
+    if (++a->pos >= a->length)
+      a->pos = 0;
+    x = b - x;
+    if (i == 0)
+      *out_r = x;
+  }
+  return x;
+}
+
+void AudioFx_Process(int32_t sends[AUDIO_FX_BUSES][AUDIO_FX_MAX_STEPS],
+                     int32_t *mix, uint32_t frames) {
+  /* Settings: a new delay time starts from empty lines */
+  const int32_t d_level = delay_capacity ? delay_level : 0;
+  if (d_level) {
+    uint32_t length = delay_length();
+    if (length != delay_lines[0].length) {
+      delay_reset(&delay_lines[0], length);
+      delay_reset(&delay_lines[1], length);
+    }
+  }
+  const int32_t d_feedback = delay_feedback * 7 / 8; /* Never runs away */
+  const int32_t r_level = reverb_ok ? reverb_level : 0;
+  const int32_t r_feedback = 180 + reverb_size * 60 / 255;
+  const int32_t r_damping = reverb_damping / 2;
+
+  uint32_t steps = (frames + AUDIO_FX_DECIMATE - 1) / AUDIO_FX_DECIMATE;
+  for (uint32_t k = 0; k < steps; k++) {
+    int32_t out_l = 0;
+    int32_t out_r = 0;
+
+    /* Ping-pong: the left line feeds the right, the right feeds back */
+    if (d_level) {
+      int32_t in = sends[AUDIO_FX_DELAY][k] / AUDIO_FX_DECIMATE;
+      int32_t l = delay_read(&delay_lines[0]);
+      int32_t r = delay_read(&delay_lines[1]);
+      delay_write(&delay_lines[0], saturate16(in + ((r * d_feedback) >> 8)));
+      delay_write(&delay_lines[1], (int16_t)l);
+      out_l += (l * d_level) >> 8;
+      out_r += (r * d_level) >> 8;
+    }
+
+    if (r_level) {
+      int32_t in = sends[AUDIO_FX_REVERB][k] / (AUDIO_FX_DECIMATE * 8);
+      int32_t side = 0;
+      int32_t l = reverb_tick(in, r_feedback, r_damping, &side);
+      out_l += (l * r_level) >> 8;
+      out_r += (side * r_level) >> 8;
+    }
+
+    /* Fade the return in after a bypass */
+    if (fade < 256) {
+      out_l = (out_l * fade) >> 8;
+      out_r = (out_r * fade) >> 8;
+      fade += FX_FADE_STEP;
+    }
+
+    /* Back to the full rate: straight lines between effect samples */
+    uint32_t first = k * AUDIO_FX_DECIMATE;
+    uint32_t count = frames - first;
+    if (count > AUDIO_FX_DECIMATE)
+      count = AUDIO_FX_DECIMATE;
+    int32_t step_l = (out_l - wet_l) / AUDIO_FX_DECIMATE;
+    int32_t step_r = (out_r - wet_r) / AUDIO_FX_DECIMATE;
+    for (uint32_t j = 0; j < count; j++) {
+      wet_l += step_l;
+      wet_r += step_r;
+      mix[(first + j) * 2] += wet_l;
+      mix[(first + j) * 2 + 1] += wet_r;
+    }
+    wet_l = out_l;
+    wet_r = out_r;
+  }
+}
+
+void AudioFx_Bypass(void) {
+  fade = 0;
+  wet_l = 0;
+  wet_r = 0;
+  stat_bypassed++;
+}
+
+void AudioFx_GetStats(AudioFxStats *stats) {
+  stats->ram_bytes = ram_used;
+  stats->delay_max_ms = delay_capacity * 1000 / FX_RATE;
+  stats->delay_ms =
+      delay_capacity ? delay_lines[0].length * 1000 / FX_RATE : 0;
+  stats->bypassed = stat_bypassed;
+  stats->reverb_ok = reverb_ok;
+}
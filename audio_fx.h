@@ -0,0 +1,96 @@
+#ifndef AUDIO_FX_H
+#define AUDIO_FX_H
+
+#include <stdint.h>
+
+/* Send buses (per-channel send levels: AudioMixer_SetSend) */
+#define AUDIO_FX_DELAY 0
+#define AUDIO_FX_REVERB 1
+#define AUDIO_FX_BUSES 2
+
+/* Effects run at the sample rate divided by this (11025Hz) */
+#define AUDIO_FX_DECIMATE 4
+#define AUDIO_FX_MAX_STEPS 32 /* Per 128-frame mixer pass */
+
+/* Delay divisions (tempo-synced) */
+#define AUDIO_FX_DIV_16TH 0
+#define AUDIO_FX_DIV_8TH 1
+#define AUDIO_FX_DIV_8TH_DOTTED 2
+#define AUDIO_FX_DIV_4TH 3
+
+/**
+ * @brief Effects statistics
+ */
+typedef struct {
+  uint32_t ram_bytes;    /* Effects RAM in use (delay + reverb lines) */
+  uint32_t delay_max_ms; /* Longest delay the delay lines can hold */
+  uint32_t delay_ms;     /* Current delay time (0 = delay unavailable) */
+  uint32_t bypassed;     /* Passes skipped by the CPU guard */
+  uint8_t reverb_ok;     /* Reverb lines fit in the effects RAM */
+} AudioFxStats;
+
+/**
+ * @brief Initialize the effects in the effects RAM
+ * @details The reverb takes its fixed lines first, the delay the rest
+ *          (4-bit ADPCM, two lines for ping-pong). Either is left off if
+ *          its memory does not fit.
+ * @param ram Start of the effects RAM (4-byte aligned)
+ * @param bytes Size of the effects RAM
+ * @return 0 on success, -1 if neither effect fits
+ */
+int AudioFx_Init(void *ram, uint32_t bytes);
+
+/**
+ * @brief Set the tempo the delay follows
+ * @param bpm Tempo
+ */
+void AudioFx_SetTempo(uint16_t bpm);
+
+/**
+ * @brief Set the delay
+ * @details Divisions that do not fit the delay lines are halved until
+ *          they do. Applied at the start of the next audio block; a
+ *          change of delay time clears the lines.
+ * @param division AUDIO_FX_DIV_*
+ * @param feedback Feedback (0-255)
+ * @param level Return level (0-255, 0 = off)
+ */
+void AudioFx_SetDelay(uint8_t division, uint8_t feedback, uint8_t level);
+
+/**
+ * @brief Set the reverb
+ * @param size Decay length (0-255)
+ * @param damping High-frequency damping (0-255)
+ * @param level Return level (0-255, 0 = off)
+ */
+void AudioFx_SetReverb(uint8_t size, uint8_t damping, uint8_t level);
+
+/**
+ * @brief Check if any effect return is on
+ * @return 1 if the effects need processing, 0 otherwise
+ */
+uint8_t AudioFx_IsActive(void);
+
+/**
+ * @brief Run the effects over one pass and add them to the mix
+ * @details Audio interrupt only.
+ * @param sends Send buses, one sum of AUDIO_FX_DECIMATE frames per entry
+ * @param mix Stereo interleaved 32-bit mix
+ * @param frames Frames in the pass
+ */
+void AudioFx_Process(int32_t sends[AUDIO_FX_BUSES][AUDIO_FX_MAX_STEPS],
+                     int32_t *mix, uint32_t frames);
+
+/**
+ * @brief Skip the effects for one pass (CPU guard)
+ * @details The lines hold still; the return fades back in afterwards.
+ */
+void AudioFx_Bypass(void);
+
+/**
+ * @brief Get effects statistics
+ * @param stats Structure to fill
+ */
+void AudioFx_GetStats(AudioFxStats *stats);
+
+#endif
@@ -1,6 +1,17 @@
 #include "audio_mixer.h"
+#include "audio_fx.h"
+#include "mixer_tables.h"
+#include "ramfunc.h"
 #include <string.h>
 
+/* State-variable filter coefficients (TPT form) */
+typedef struct {
+  float a1;
+  float a2;
+  float a3;
+  float k; /* 1 / Q */
+} FilterCoeffs;
+
 /* Audio channel structure */
 typedef struct {
   int16_t *sample_data;
@@ -10,17 +21,291 @@ typedef struct {
   uint8_t mix_vol; /* Channel Mix Volume (0-255) */
   uint8_t pan;     /* 0 = Left, 128 = Center, 255 = Right */
   uint8_t active;
+  /* Voice levels (velocity x mix_vol x pan law), Q15 << 8. Recomputed on
+   * trigger and parameter change, ramped to the target across a block. */
+  int32_t target_l;
+  int32_t target_r;
+  int32_t level_l;
+  int32_t level_r;
+  int32_t level_step_l;
+  int32_t level_step_r;
+  /* Envelope (hold, then exponential decay), evaluated per sub-block */
+  uint8_t hold;       /* 10ms units */
+  uint8_t decay;      /* 10ms units to -60dB, 0 = play to the end */
+  uint16_t env;       /* Q15, ENV_FULL = unity */
+  uint32_t hold_left; /* Frames before the decay starts */
+  /* Applied gain (level x envelope), interpolated per frame */
+  int32_t gain_l;
+  int32_t gain_r;
+  int32_t gain_step_l;
+  int32_t gain_step_r;
+  /* Resonant filter, float on the FPU. Coefficients are stepped towards
+   * the target once per sub-block. */
+  uint8_t filter_mode; /* AUDIO_FILTER_* */
+  uint8_t cutoff;
+  uint8_t resonance;
+  FilterCoeffs coeffs;
+  FilterCoeffs coeffs_target;
+  FilterCoeffs coeffs_step;
+  float ic1eq; /* Integrator states */
+  float ic2eq;
+  /* Effect sends (post-fader, mono), gain refreshed per sub-block */
+  uint8_t send[AUDIO_FX_BUSES];
+  int32_t send_gain[AUDIO_FX_BUSES]; /* Q15 */
+  /* Pending ratchet hits, counted down per output frame */
+  uint8_t repeat_left;      /* Hits still to play */
+  uint8_t repeat_vel_step;  /* Velocity added per hit */
+  uint32_t repeat_interval; /* Samples between onsets */
+  uint32_t repeat_countdown;
 } AudioChannel;
 
 /* Channel array */
 static AudioChannel channels[NUM_CHANNELS];
 
+/* Frames mixed per pass; longer requests are split */
+#define MIX_BLOCK 128
+
+/* Stereo interleaved 32-bit mix of one pass */
+static int32_t mix_buffer[MIX_BLOCK * 2];
+
+/* Effect send buses of one pass, summed over AUDIO_FX_DECIMATE frames */
+static int32_t fx_send[AUDIO_FX_BUSES][AUDIO_FX_MAX_STEPS];
+
+/* CPU guard: effects are skipped when they would push a block past
+ * FX_DEADLINE_PCT of its deadline */
+#define FX_DEADLINE_PCT 75
+static const volatile uint32_t *cycle_counter = NULL;
+static uint32_t cycles_per_frame = 0;
+static uint32_t fx_cycles = 0; /* Recent worst effects pass */
+
+/* Envelope: evaluated every ENV_BLOCK frames (must match tools/mixtables.c)
+ * and interpolated in between */
+#define ENV_BLOCK 16
+#define ENV_FULL 32768
+#define ENV_SILENT 33 /* -60dB */
+#define ENV_UNIT_FRAMES (AUDIO_SAMPLE_RATE / 100)
+
+/* Master limiter: the mix is delayed by LIMIT_LOOKAHEAD sub-blocks so the
+ * gain can be ramped down before a peak arrives instead of clipping it */
+#define LIMIT_LOOKAHEAD 8 /* Sub-blocks (8 x 16 frames = 2.9ms) */
+#define LIMIT_SLOTS (LIMIT_LOOKAHEAD + 1)
+#define LIMIT_UNITY 32768       /* Q15 */
+#define LIMIT_THRESHOLD 32000   /* Leaves room for ramp rounding */
+#define LIMIT_RELEASE_SHIFT 6   /* Recovers ~1/64 of the way per sub-block */
+#define SOFT_CLIP_KNEE 49152.0f /* Input that maps to full scale (1.5x) */
+
+static int32_t limit_delay[LIMIT_SLOTS][ENV_BLOCK * 2];
+static int32_t limit_need[LIMIT_SLOTS]; /* Gain each slot needs, Q15 */
+static int32_t limit_peak = 0;          /* Peak of the slot being filled */
+static uint8_t limit_slot = 0;          /* Slot being filled */
+static uint8_t limit_pos = 0;           /* Frame within the slot */
+static int32_t limit_gain = LIMIT_UNITY;
+static int32_t limit_step = 0;
+static int32_t limit_target = LIMIT_UNITY; /* Gain at the end of the slot */
+static volatile int32_t limit_min_gain = LIMIT_UNITY; /* Since last read */
+static volatile uint8_t soft_clip = 0;
+
+/* Commands to the audio interrupt, applied at the start of each block.
+ * One single-producer/single-consumer queue per producer context, so
+ * neither side ever locks or waits. */
+#define COMMAND_QUEUE_SIZE 64 /* Power of two */
+#define CMD_TRIGGER 0         /* a = velocity */
+#define CMD_VOLUME 1          /* a = mix volume */
+#define CMD_PAN 2             /* a = pan */
+#define CMD_ENVELOPE 3        /* a = hold, b = decay */
+#define CMD_SEND 4            /* a = bus, b = level */
+#define CMD_FILTER 5          /* + mode: a = cutoff, b = resonance */
+
+typedef struct {
+  uint8_t type;
+  uint8_t channel;
+  uint8_t a;
+  uint8_t b;
+} MixerCommand;
+
+typedef struct {
+  MixerCommand commands[COMMAND_QUEUE_SIZE];
+  volatile uint8_t head; /* Written by the producer only */
+  volatile uint8_t tail; /* Written by AudioMixer_Process only */
+} CommandQueue;
+
+static CommandQueue main_queue; /* Main loop */
+static CommandQueue irq_queue;  /* Clock and pad interrupts (same priority) */
+
+static volatile uint8_t velocity_curve = AUDIO_VELOCITY_LINEAR;
+
+/* Orders voice writes made outside the audio interrupt against it: a
+ * voice is parked (active clear) before its fields change (host builds
+ * have no interrupts: compiler barrier only) */
+#if defined(__arm__)
+#define VOICE_BARRIER() __asm volatile("dmb" : : : "memory")
+#else
+#define VOICE_BARRIER() __asm volatile("" : : : "memory")
+#endif
+
+/**
+ * @brief Recompute a channel's target gains from its velocity, mix volume
+ *        and pan
+ */
+static RAMFUNC void update_targets(AudioChannel *c) {
+  /* Velocity x mix volume, Q15 */
+  uint32_t level =
+      (uint32_t)mixer_velocity[velocity_curve][c->volume] * c->mix_vol / 255;
+
+  /* x pan law (Q15): Q30 >> 15, kept << 8 for the ramp */
+  c->target_l = (int32_t)((level * mixer_pan_law[255 - c->pan]) >> 7);
+  c->target_r = (int32_t)((level * mixer_pan_law[c->pan]) >> 7);
+}
+
+/**
+ * @brief Recompute a channel's target filter coefficients
+ */
+static void update_filter_target(AudioChannel *c) {
+  FilterCoeffs *t = &c->coeffs_target;
+  float g = mixer_svf_g[c->cutoff];
+
+  /* Resonance 0-255 maps Q from 0.5 to 25 */
+  t->k = 2.0f - 1.96f * (float)c->resonance / 255.0f;
+  t->a1 = 1.0f / (1.0f + g * (g + t->k));
+  t->a2 = g * t->a1;
+  t->a3 = g * t->a2;
+}
+
+/**
+ * @brief Start a hit: full level and envelope at once, no ramp
+ */
+static RAMFUNC void start_voice(AudioChannel *c) {
+  update_targets(c);
+  c->level_l = c->target_l;
+  c->level_r = c->target_r;
+  c->level_step_l = 0;
+  c->level_step_r = 0;
+  c->env = ENV_FULL;
+  c->hold_left = (uint32_t)c->hold * ENV_UNIT_FRAMES;
+  c->gain_l = c->target_l;
+  c->gain_r = c->target_r;
+  c->gain_step_l = 0;
+  c->gain_step_r = 0;
+  c->coeffs = c->coeffs_target;
+  memset(&c->coeffs_step, 0, sizeof(c->coeffs_step));
+  c->ic1eq = 0.0f;
+  c->ic2eq = 0.0f;
+  c->playback_pos = 0;
+}
+
+/**
+ * @brief Advance a channel's envelope by one sub-block
+ * @return Envelope value at the end of the sub-block, Q15
+ */
+static RAMFUNC uint16_t advance_envelope(AudioChannel *c, uint32_t frames) {
+  if (c->decay == 0)
+    return ENV_FULL;
+
+  if (c->hold_left > 0) {
+    c->hold_left = (c->hold_left > frames) ? c->hold_left - frames : 0;
+    return c->env;
+  }
+
+  c->env = (uint16_t)(((uint32_t)c->env * mixer_decay[c->decay]) >> 16);
+  if (c->env < ENV_SILENT)
+    c->env = 0;
+  return c->env;
+}
+
+/**
+ * @brief Queue a command; drops it if the queue is full (never blocks)
+ * @return 0 on success, -1 if full
+ */
+static int post_command(CommandQueue *q, uint8_t type, uint8_t channel,
+                        uint8_t a, uint8_t b) {
+  if (channel >= NUM_CHANNELS)
+    return -1;
+
+  uint8_t head = q->head;
+  if ((uint8_t)(head - q->tail) >= COMMAND_QUEUE_SIZE)
+    return -1;
+
+  MixerCommand *cmd = &q->commands[head & (COMMAND_QUEUE_SIZE - 1)];
+  cmd->type = type;
+  cmd->channel = channel;
+  cmd->a = a;
+  cmd->b = b;
+  __asm volatile("" : : : "memory"); /* Entry before index */
+  q->head = head + 1;
+  return 0;
+}
+
+/**
+ * @brief Apply all queued commands (audio interrupt only)
+ */
+static void drain_commands(CommandQueue *q) {
+  uint8_t tail = q->tail;
+  while (tail != q->head) {
+    MixerCommand *cmd = &q->commands[tail & (COMMAND_QUEUE_SIZE - 1)];
+    AudioChannel *c = &channels[cmd->channel];
+
+    switch (cmd->type) {
+    case CMD_TRIGGER:
+      AudioMixer_Trigger(cmd->channel, cmd->a);
+      break;
+    case CMD_VOLUME:
+      c->mix_vol = cmd->a;
+      update_targets(c);
+      break;
+    case CMD_PAN:
+      c->pan = cmd->a;
+      update_targets(c);
+      break;
+    case CMD_ENVELOPE:
+      c->hold = cmd->a;
+      c->decay = cmd->b;
+      break;
+    case CMD_SEND:
+      if (cmd->a < AUDIO_FX_BUSES)
+        c->send[cmd->a] = cmd->b;
+      break;
+    case CMD_FILTER + AUDIO_FILTER_OFF:
+    case CMD_FILTER + AUDIO_FILTER_LP:
+    case CMD_FILTER + AUDIO_FILTER_BP:
+    case CMD_FILTER + AUDIO_FILTER_HP:
+      /* Mode and cutoff in one entry: a full queue drops both or none */
+      c->cutoff = cmd->a;
+      c->resonance = cmd->b;
+      update_filter_target(c);
+      if (c->filter_mode == AUDIO_FILTER_OFF) {
+        /* Nothing to glide from: start clean at the new setting */
+        c->coeffs = c->coeffs_target;
+        c->ic1eq = 0.0f;
+        c->ic2eq = 0.0f;
+      }
+      c->filter_mode = cmd->type - CMD_FILTER;
+      break;
+    }
+    tail++;
+  }
+  q->tail = tail;
+}
+
 void AudioMixer_Init(void) {
   memset(channels, 0, sizeof(channels));
   for (int i = 0; i < NUM_CHANNELS; i++) {
     channels[i].pan = 128;     /* Default center */
     channels[i].mix_vol = 255; /* Default max volume */
+    channels[i].cutoff = 255;
+    update_filter_target(&channels[i]);
   }
+
+  /* Limiter starts empty at unity gain */
+  memset(limit_delay, 0, sizeof(limit_delay));
+  for (int i = 0; i < LIMIT_SLOTS; i++)
+    limit_need[i] = LIMIT_UNITY;
+  limit_peak = 0;
+  limit_slot = 0;
+  limit_pos = 0;
+  limit_gain = LIMIT_UNITY;
+  limit_target = LIMIT_UNITY;
+  limit_step = 0;
+  limit_min_gain = LIMIT_UNITY;
 }
 
 void AudioMixer_SetSample(uint8_t channel, int16_t *sample_data,
@@ -28,25 +313,88 @@ void AudioMixer_SetSample(uint8_t channel, int16_t *sample_data,
   if (channel >= NUM_CHANNELS)
     return;
 
+  /* Park the voice first: the audio interrupt preempts every caller, so
+   * once these stores land no block reads the old buffer again and it may
+   * be freed as soon as this returns */
+  channels[channel].active = 0;
+  channels[channel].repeat_left = 0;
+  VOICE_BARRIER();
   channels[channel].sample_data = sample_data;
   channels[channel].sample_length = sample_length;
   channels[channel].playback_pos = 0;
-  channels[channel].active = 0;
   // Preserve pan if already set, otherwise default to center if init cleared it
   if (channels[channel].pan == 0 && channels[0].pan == 0)
     channels[channel].pan = 128;
 }
 
-void AudioMixer_SetPan(uint8_t channel, uint8_t pan) {
-  if (channel >= NUM_CHANNELS)
+void AudioMixer_LoadVoice(uint8_t channel, int16_t *sample_data,
+                          uint32_t sample_length, const AudioVoice *voice) {
+  if (channel >= NUM_CHANNELS || voice->filter_mode > AUDIO_FILTER_HP)
     return;
-  channels[channel].pan = pan;
+
+  /* Parked from here on: the audio interrupt only copies targets */
+  AudioMixer_SetSample(channel, sample_data, sample_length);
+
+  AudioChannel *c = &channels[channel];
+  c->mix_vol = voice->volume;
+  c->pan = voice->pan;
+  update_targets(c);
+  c->hold = voice->hold;
+  c->decay = voice->decay;
+  c->cutoff = voice->cutoff;
+  c->resonance = voice->resonance;
+  update_filter_target(c);
+  c->coeffs = c->coeffs_target; /* New sound: no glide from the old one */
+  c->ic1eq = 0.0f;
+  c->ic2eq = 0.0f;
+  c->filter_mode = voice->filter_mode;
+}
+
+void AudioMixer_SetPan(uint8_t channel, uint8_t pan) {
+  post_command(&main_queue, CMD_PAN, channel, pan, 0);
 }
 
 void AudioMixer_SetVolume(uint8_t channel, uint8_t volume) {
-  if (channel >= NUM_CHANNELS)
+  post_command(&main_queue, CMD_VOLUME, channel, volume, 0);
+}
+
+void AudioMixer_SetEnvelope(uint8_t channel, uint8_t hold, uint8_t decay) {
+  post_command(&main_queue, CMD_ENVELOPE, channel, hold, decay);
+}
+
+void AudioMixer_SetFilter(uint8_t channel, uint8_t mode, uint8_t cutoff,
+                          uint8_t resonance) {
+  if (mode > AUDIO_FILTER_HP)
     return;
-  channels[channel].mix_vol = volume;
+  post_command(&main_queue, CMD_FILTER + mode, channel, cutoff, resonance);
+}
+
+void AudioMixer_SetSend(uint8_t channel, uint8_t bus, uint8_t level) {
+  post_command(&main_queue, CMD_SEND, channel, bus, level);
+}
+
+void AudioMixer_SetCycleCounter(const volatile uint32_t *counter,
+                                uint32_t per_frame) {
+  cycles_per_frame = per_frame;
+  fx_cycles = 0;
+  cycle_counter = counter;
+}
+
+void AudioMixer_SetVelocityCurve(uint8_t curve) {
+  if (curve <= AUDIO_VELOCITY_LOG)
+    velocity_curve = curve;
+}
+
+uint8_t AudioMixer_GetVelocityCurve(void) { return velocity_curve; }
+
+void AudioMixer_SetSoftClip(uint8_t enable) { soft_clip = enable ? 1 : 0; }
+
+uint8_t AudioMixer_GetSoftClip(void) { return soft_clip; }
+
+uint16_t AudioMixer_GetGainReduction(void) {
+  int32_t gain = limit_min_gain;
+  limit_min_gain = LIMIT_UNITY;
+  return (uint16_t)(LIMIT_UNITY - gain);
 }
 
 void AudioMixer_Trigger(uint8_t channel, uint8_t velocity) {
@@ -55,61 +403,372 @@ void AudioMixer_Trigger(uint8_t channel, uint8_t velocity) {
   if (channels[channel].sample_data == NULL)
     return;
 
-  channels[channel].playback_pos = 0;
-  channels[channel].volume = velocity;
-  channels[channel].active = 1;
+  AudioChannel *c = &channels[channel];
+
+  /* The clock interrupt and the main loop can be preempted mid-restart:
+   * park the voice while it is rewritten and release it whole */
+  c->active = 0;
+  c->repeat_left = 0;
+  VOICE_BARRIER();
+  c->volume = velocity;
+
+  /* A new hit starts at its own level, no ramp from the previous one */
+  start_voice(c);
+  VOICE_BARRIER();
+  c->active = 1;
 }
 
-void AudioMixer_Process(int16_t *output, uint32_t length) {
-  for (uint32_t i = 0; i < length; i++) {
-    int32_t mix_left = 0;
-    int32_t mix_right = 0;
+void AudioMixer_TriggerRepeat(uint8_t channel, uint8_t velocity, uint8_t hits,
+                              uint32_t interval, uint8_t ramp) {
+  if (channel >= NUM_CHANNELS)
+    return;
+  if (hits > AUDIO_MAX_REPEATS)
+    hits = AUDIO_MAX_REPEATS;
+  if (hits <= 1 || interval == 0) {
+    AudioMixer_Trigger(channel, velocity);
+    return;
+  }
 
-    /* Mix all active channels */
-    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
-      if (channels[ch].active &&
-          channels[ch].playback_pos < channels[ch].sample_length) {
-
-        /* Get sample */
-        int32_t sample = channels[ch].sample_data[channels[ch].playback_pos++];
-
-        /* Apply volume (velocity) */
-        sample = (sample * channels[ch].volume) >> 8;
-
-        /* Apply mix volume */
-        sample = (sample * channels[ch].mix_vol) >> 8;
-
-        /* Apply panning */
-        int32_t pan = channels[ch].pan;
-        int32_t pan_left = (255 - pan);
-        int32_t pan_right = pan;
-
-        /* Mix to channels */
-        // sample is 16-bit. pan is 8-bit. Result 24-bit. >> 8 back to 16-bit.
-        // Multiply by 2 to maintain unity gain at center (128 = 0.5 -> * 2
-        // = 1.0)
-        mix_left += (sample * pan_left) >> 7;
-        mix_right += (sample * pan_right) >> 7;
-
-        /* Check if sample finished */
-        if (channels[ch].playback_pos >= channels[ch].sample_length) {
-          channels[ch].active = 0;
-        }
+  AudioChannel *c = &channels[channel];
+  uint8_t vel_step = ramp ? (uint8_t)(velocity / hits) : 0;
+
+  if (c->sample_data == NULL)
+    return;
+  AudioMixer_Trigger(channel, (uint8_t)(velocity - (hits - 1) * vel_step));
+
+  /* Count is armed last: the audio interrupt may run in between */
+  c->repeat_vel_step = vel_step;
+  c->repeat_interval = interval;
+  c->repeat_countdown = interval + 1; /* Includes the first hit's frame */
+  VOICE_BARRIER();
+  c->repeat_left = hits - 1;
+}
+
+int AudioMixer_PostTrigger(uint8_t channel, uint8_t velocity) {
+  return post_command(&irq_queue, CMD_TRIGGER, channel, velocity, 0);
+}
+
+/**
+ * @brief Run one sample through a channel's filter
+ */
+static inline __attribute__((always_inline)) int32_t
+filter_sample(AudioChannel *c, int32_t sample, const int mode) {
+  const FilterCoeffs *f = &c->coeffs;
+  float v0 = (float)sample;
+  float v3 = v0 - c->ic2eq;
+  float v1 = f->a1 * c->ic1eq + f->a2 * v3; /* Band */
+  float v2 = c->ic2eq + f->a2 * c->ic1eq + f->a3 * v3; /* Low */
+  c->ic1eq = 2.0f * v1 - c->ic1eq;
+  c->ic2eq = 2.0f * v2 - c->ic2eq;
+
+  float out;
+  if (mode == AUDIO_FILTER_LP)
+    out = v2;
+  else if (mode == AUDIO_FILTER_BP)
+    out = v1;
+  else
+    out = v0 - f->k * v1 - v2;
+
+  /* Resonant peaks may overshoot: keep within the 16-bit sample range */
+  if (out > 32767.0f)
+    out = 32767.0f;
+  if (out < -32768.0f)
+    out = -32768.0f;
+  return (int32_t)out;
+}
+
+/**
+ * @brief Mix frames [from, to) of one channel into mix_buffer
+ * @details Expanded per case so the plain path carries no filter or send
+ *          code.
+ */
+static inline __attribute__((always_inline)) void
+mix_frames(AudioChannel *c, uint32_t from, uint32_t to, const int mode,
+           const int sends) {
+  for (uint32_t i = from; i < to; i++) {
+    /* Ratchet: restart the sample on the exact frame the hit is due */
+    if (c->repeat_left && --c->repeat_countdown == 0) {
+      c->repeat_left--;
+      c->repeat_countdown = c->repeat_interval;
+      c->volume += c->repeat_vel_step;
+      start_voice(c); /* Gain holds until the next sub-block */
+      c->active = 1;
+    }
+
+    if (!c->active)
+      continue;
+
+    /* Get sample */
+    int32_t sample = c->sample_data[c->playback_pos++];
+    if (mode != AUDIO_FILTER_OFF)
+      sample = filter_sample(c, sample, mode);
+
+    /* Velocity, mix volume, pan and envelope folded into one gain per
+     * side */
+    c->gain_l += c->gain_step_l;
+    c->gain_r += c->gain_step_r;
+
+    /* Mix to channels (Q15 gain, up to 1.41 at the pan extremes) */
+    mix_buffer[i * 2] += (sample * (c->gain_l >> 8)) >> 15;
+    mix_buffer[i * 2 + 1] += (sample * (c->gain_r >> 8)) >> 15;
+
+    if (sends) {
+      uint32_t step = i / AUDIO_FX_DECIMATE;
+      fx_send[AUDIO_FX_DELAY][step] += (sample * c->send_gain[0]) >> 15;
+      fx_send[AUDIO_FX_REVERB][step] += (sample * c->send_gain[1]) >> 15;
+    }
+
+    /* Check if sample finished */
+    if (c->playback_pos >= c->sample_length) {
+      c->active = 0;
+    }
+  }
+}
+
+/**
+ * @brief Step a filter's coefficients one sub-block towards the target
+ */
+static RAMFUNC void step_filter(AudioChannel *c, uint8_t last) {
+  if (last) {
+    c->coeffs = c->coeffs_target; /* Land exactly on the target */
+  } else {
+    c->coeffs.a1 += c->coeffs_step.a1;
+    c->coeffs.a2 += c->coeffs_step.a2;
+    c->coeffs.a3 += c->coeffs_step.a3;
+    c->coeffs.k += c->coeffs_step.k;
+  }
+}
+
+/**
+ * @brief Render one channel over a pass into mix_buffer
+ * @param fx Effects are running: feed the send buses too
+ */
+static RAMFUNC void mix_channel(AudioChannel *c, uint32_t length, uint8_t fx) {
+  /* Ramp the channel's level to its new target over this pass;
+   * silent channels jump straight there */
+  if (!c->active) {
+    c->level_l = c->target_l;
+    c->level_r = c->target_r;
+    c->coeffs = c->coeffs_target;
+    if (!c->repeat_left)
+      return; /* Nothing to play or count down */
+  }
+  c->level_step_l = (c->target_l - c->level_l) / (int32_t)length;
+  c->level_step_r = (c->target_r - c->level_r) / (int32_t)length;
+
+  const int mode = c->filter_mode;
+  const int sends = fx && (c->send[0] || c->send[1]);
+  if (mode != AUDIO_FILTER_OFF) {
+    uint32_t steps = (length + ENV_BLOCK - 1) / ENV_BLOCK;
+    float inv = 1.0f / (float)steps;
+    c->coeffs_step.a1 = (c->coeffs_target.a1 - c->coeffs.a1) * inv;
+    c->coeffs_step.a2 = (c->coeffs_target.a2 - c->coeffs.a2) * inv;
+    c->coeffs_step.a3 = (c->coeffs_target.a3 - c->coeffs.a3) * inv;
+    c->coeffs_step.k = (c->coeffs_target.k - c->coeffs.k) * inv;
+  }
+
+  for (uint32_t start = 0; start < length; start += ENV_BLOCK) {
+    uint32_t frames = length - start;
+    if (frames > ENV_BLOCK)
+      frames = ENV_BLOCK;
+    uint8_t last = (start + frames >= length);
+
+    /* Per sub-block: next level, envelope value and filter coefficients;
+     * the gain is then interpolated linearly towards them */
+    if (c->active && c->env == 0) {
+      c->active = 0; /* Envelope ran out during the last sub-block */
+    }
+    if (c->active) {
+      if (last) {
+        c->level_l = c->target_l; /* Land exactly on the target */
+        c->level_r = c->target_r;
+      } else {
+        c->level_l += c->level_step_l * (int32_t)frames;
+        c->level_r += c->level_step_r * (int32_t)frames;
       }
+
+      int32_t env = advance_envelope(c, frames);
+      int32_t end_l = ((c->level_l >> 8) * env) >> 7;
+      int32_t end_r = ((c->level_r >> 8) * env) >> 7;
+      c->gain_step_l = (end_l - c->gain_l) / (int32_t)frames;
+      c->gain_step_r = (end_r - c->gain_r) / (int32_t)frames;
+
+      /* Sends follow the voice level, no per-frame ramp */
+      int32_t mono = (end_l + end_r) >> 9; /* Q15 */
+      c->send_gain[0] = (mono * c->send[0]) >> 8;
+      c->send_gain[1] = (mono * c->send[1]) >> 8;
+    }
+
+    if (mode != AUDIO_FILTER_OFF)
+      step_filter(c, last);
+    if (sends) {
+      mix_frames(c, start, start + frames, mode, 1);
+    } else if (mode != AUDIO_FILTER_OFF) {
+      mix_frames(c, start, start + frames, mode, 0);
+    } else {
+      mix_frames(c, start, start + frames, AUDIO_FILTER_OFF, 0);
+    }
+  }
+}
+
+/**
+ * @brief Plan the limiter gain across the slot about to be played
+ * @details The gain must be at or below each queued slot's need by the
+ *          time that slot starts, so it heads for the tightest of those
+ *          straight lines; otherwise it releases slowly towards unity.
+ */
+static RAMFUNC void plan_limiter(uint8_t out_slot) {
+  int32_t end =
+      limit_gain + ((LIMIT_UNITY - limit_gain) >> LIMIT_RELEASE_SHIFT);
+
+  /* Whole slot: both ends at or below its need */
+  if (end > limit_need[out_slot])
+    end = limit_need[out_slot];
+
+  /* Later slots (all but the one still filling) */
+  for (int j = 1; j < LIMIT_LOOKAHEAD; j++) {
+    int32_t need = limit_need[(out_slot + j) % LIMIT_SLOTS];
+    int32_t reach = limit_gain + (need - limit_gain) / j;
+    if (end > reach)
+      end = reach;
+  }
+
+  limit_target = end;
+  limit_step = (end - limit_gain) / ENV_BLOCK;
+  if (end < limit_min_gain)
+    limit_min_gain = end;
+}
+
+/**
+ * @brief Soft clip a sample: cubic above, flat beyond SOFT_CLIP_KNEE
+ */
+static RAMFUNC int32_t soft_clip_sample(int32_t x) {
+  float v = (float)x / SOFT_CLIP_KNEE;
+  if (v >= 1.0f)
+    return LIMIT_UNITY;
+  if (v <= -1.0f)
+    return -LIMIT_UNITY;
+  /* 1.5v - 0.5v^3: unity slope at 0, flat at the knee */
+  return (int32_t)((1.5f * v - 0.5f * v * v * v) * (float)LIMIT_UNITY);
+}
+
+/**
+ * @brief Master bus: soft clip (optional) and look-ahead limiter
+ * @details Fixed cost per frame plus a bounded plan per sub-block.
+ */
+static RAMFUNC void master_process(int16_t *output, uint32_t frames) {
+  const uint8_t clip = soft_clip;
+
+  for (uint32_t i = 0; i < frames; i++) {
+    int32_t in_l = mix_buffer[i * 2];
+    int32_t in_r = mix_buffer[i * 2 + 1];
+    if (clip) {
+      in_l = soft_clip_sample(in_l);
+      in_r = soft_clip_sample(in_r);
     }
 
-    /* Clamp to 16-bit range using saturation */
-    if (mix_left > 32767)
-      mix_left = 32767;
-    if (mix_left < -32768)
-      mix_left = -32768;
-    if (mix_right > 32767)
-      mix_right = 32767;
-    if (mix_right < -32768)
-      mix_right = -32768;
+    /* Oldest slot plays out as the newest fills */
+    uint8_t out_slot = (limit_slot + 1) % LIMIT_SLOTS;
+    if (limit_pos == 0)
+      plan_limiter(out_slot);
+
+    int32_t *in = &limit_delay[limit_slot][limit_pos * 2];
+    int32_t *out = &limit_delay[out_slot][limit_pos * 2];
+    int32_t l = out[0];
+    int32_t r = out[1];
+    in[0] = in_l;
+    in[1] = in_r;
+
+    int32_t peak = (in_l < 0) ? -in_l : in_l;
+    int32_t peak_r = (in_r < 0) ? -in_r : in_r;
+    if (peak_r > peak)
+      peak = peak_r;
+    if (peak > limit_peak)
+      limit_peak = peak;
+
+    limit_gain += limit_step;
+    l = (int32_t)(((int64_t)l * limit_gain) >> 15);
+    r = (int32_t)(((int64_t)r * limit_gain) >> 15);
+
+    /* Safety only: the limiter keeps the mix below full scale */
+    if (l > 32767)
+      l = 32767;
+    if (l < -32768)
+      l = -32768;
+    if (r > 32767)
+      r = 32767;
+    if (r < -32768)
+      r = -32768;
 
     /* Output stereo interleaved */
-    output[i * 2] = (int16_t)mix_left;
-    output[i * 2 + 1] = (int16_t)mix_right;
+    output[i * 2] = (int16_t)l;
+    output[i * 2 + 1] = (int16_t)r;
+
+    if (++limit_pos == ENV_BLOCK) {
+      /* Slot complete: note the gain it needs, then move on */
+      limit_need[limit_slot] =
+          (limit_peak > LIMIT_THRESHOLD)
+              ? (int32_t)(((int64_t)LIMIT_THRESHOLD << 15) / limit_peak)
+              : LIMIT_UNITY;
+      limit_peak = 0;
+      limit_pos = 0;
+      limit_slot = out_slot;
+      limit_gain = limit_target; /* Land exactly on the plan */
+    }
+  }
+}
+
+/**
+ * @brief Add the effects to the pass, unless the block is running late
+ * @param start Cycle count at the start of the block
+ * @param budget Cycles until the block's deadline
+ */
+static void run_effects(uint32_t frames, uint32_t start, uint32_t budget) {
+  if (!cycle_counter) {
+    AudioFx_Process(fx_send, mix_buffer, frames);
+    return;
+  }
+
+  /* The estimate decays while skipped, so the effects get retried */
+  uint32_t now = *cycle_counter;
+  if (now - start + fx_cycles > budget / 100 * FX_DEADLINE_PCT) {
+    AudioFx_Bypass();
+    fx_cycles -= fx_cycles >> 4;
+    return;
+  }
+
+  AudioFx_Process(fx_send, mix_buffer, frames);
+  uint32_t took = *cycle_counter - now;
+  fx_cycles = (took > fx_cycles) ? took : fx_cycles - (fx_cycles >> 4);
+}
+
+RAMFUNC void AudioMixer_Process(int16_t *output, uint32_t length) {
+  uint32_t start = cycle_counter ? *cycle_counter : 0;
+  uint32_t budget = length * cycles_per_frame;
+
+  /* UI changes first, so a kit switch from the clock interrupt wins */
+  drain_commands(&main_queue);
+  drain_commands(&irq_queue);
+
+  while (length > 0) {
+    uint32_t frames = (length > MIX_BLOCK) ? MIX_BLOCK : length;
+    const uint8_t fx = AudioFx_IsActive();
+
+    /* Each channel renders its whole pass in one go */
+    memset(mix_buffer, 0, frames * 2 * sizeof(int32_t));
+    if (fx)
+      memset(fx_send, 0, sizeof(fx_send));
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+      mix_channel(&channels[ch], frames, fx);
+    }
+
+    /* Effects on top of the dry mix, ahead of the limiter */
+    if (fx)
+      run_effects(frames, start, budget);
+
+    master_process(output, frames);
+
+    output += frames * 2;
+    length -= frames;
   }
 }
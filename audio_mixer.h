@@ -4,6 +4,19 @@
 #include <stdint.h>
 
 #define NUM_CHANNELS 6
+#define AUDIO_SAMPLE_RATE 44100
+#define AUDIO_MAX_REPEATS 8 /* Hits per AudioMixer_TriggerRepeat burst */
+
+/* Filter modes */
+#define AUDIO_FILTER_OFF 0
+#define AUDIO_FILTER_LP 1
+#define AUDIO_FILTER_BP 2
+#define AUDIO_FILTER_HP 3
+
+/* Velocity curves */
+#define AUDIO_VELOCITY_LINEAR 0
+#define AUDIO_VELOCITY_EXP 1 /* Soft hits quieter */
+#define AUDIO_VELOCITY_LOG 2 /* Soft hits louder */
 
 /**
  * @brief Initialize audio mixer
@@ -12,6 +25,9 @@ void AudioMixer_Init(void);
 
 /**
  * @brief Set sample for channel
+ * @details Stops the voice before switching buffers. Safe from the main
+ *          loop and the clock interrupt; the previous buffer is no longer
+ *          read once this returns.
  * @param channel Channel number (0-3)
  * @param sample_data Pointer to sample data
  * @param sample_length Length in samples
@@ -19,8 +35,38 @@ void AudioMixer_Init(void);
 void AudioMixer_SetSample(uint8_t channel, int16_t *sample_data,
                           uint32_t sample_length);
 
+/**
+ * @brief Voice settings switched in together with a sample
+ */
+typedef struct {
+  uint8_t volume;      /* Mix volume (0-255) */
+  uint8_t pan;         /* 0 = Left, 128 = Center, 255 = Right */
+  uint8_t hold;        /* 10ms units */
+  uint8_t decay;       /* 10ms units to -60dB, 0 = play the whole sample */
+  uint8_t filter_mode; /* AUDIO_FILTER_* */
+  uint8_t cutoff;
+  uint8_t resonance;
+} AudioVoice;
+
+/**
+ * @brief Switch a channel to a new sample and voice settings at once
+ * @details Parks the voice like AudioMixer_SetSample, then writes the
+ *          settings directly instead of queueing them, so a trigger right
+ *          after (the downbeat of a kit swap) already plays them. Clock
+ *          interrupt or main loop; queued changes still apply on top at
+ *          the next block.
+ * @param channel Channel number (0-5)
+ * @param sample_data Pointer to sample data
+ * @param sample_length Length in samples
+ * @param voice Mix, envelope and filter settings
+ */
+void AudioMixer_LoadVoice(uint8_t channel, int16_t *sample_data,
+                          uint32_t sample_length, const AudioVoice *voice);
+
 /**
  * @brief Set pan for channel
+ * @details Queued and applied at the start of the next audio block, ramped
+ *          across it. Main loop only.
  * @param channel Channel number (0-3)
  * @param pan Pan value (0=Left, 128=Center, 255=Right)
  */
@@ -28,20 +74,127 @@ void AudioMixer_SetPan(uint8_t channel, uint8_t pan);
 
 /**
  * @brief Set volume (mix level) for channel
+ * @details Queued and applied at the start of the next audio block, ramped
+ *          across it. Main loop only.
  * @param channel Channel number (0-5)
  * @param volume Volume level (0-255)
  */
 void AudioMixer_SetVolume(uint8_t channel, uint8_t volume);
 
+/**
+ * @brief Set a channel's amplitude envelope
+ * @details The hit plays at full level for the hold time, then decays
+ *          exponentially; the voice stops once it is below -60dB. Queued
+ *          like AudioMixer_SetVolume. Main loop only.
+ * @param channel Channel number (0-5)
+ * @param hold Hold time in 10ms units (0-255)
+ * @param decay Time to -60dB in 10ms units, 0 = play the whole sample
+ */
+void AudioMixer_SetEnvelope(uint8_t channel, uint8_t hold, uint8_t decay);
+
+/**
+ * @brief Set a channel's resonant filter
+ * @details State-variable filter on the sample before the mix gains.
+ *          Cutoff and resonance changes glide over one audio block; an
+ *          AUDIO_FILTER_OFF channel skips the filter entirely. Queued like
+ *          AudioMixer_SetVolume. Main loop only.
+ * @param channel Channel number (0-5)
+ * @param mode AUDIO_FILTER_OFF, _LP, _BP or _HP
+ * @param cutoff Cutoff (0-255, exponential from 20Hz to 18kHz)
+ * @param resonance Resonance (0-255, Q from 0.5 to 25)
+ */
+void AudioMixer_SetFilter(uint8_t channel, uint8_t mode, uint8_t cutoff,
+                          uint8_t resonance);
+
+/**
+ * @brief Set a channel's effect send level
+ * @details Queued like SetVolume. Main loop only.
+ * @param channel Channel number (0-5)
+ * @param bus AUDIO_FX_DELAY or AUDIO_FX_REVERB
+ * @param level Send level (0-255)
+ */
+void AudioMixer_SetSend(uint8_t channel, uint8_t bus, uint8_t level);
+
+/**
+ * @brief Give the mixer a free-running cycle counter for its CPU guard
+ * @details Without one the effects always run.
+ * @param counter Counter register (e.g. the DWT cycle counter)
+ * @param per_frame Counter cycles per output frame
+ */
+void AudioMixer_SetCycleCounter(const volatile uint32_t *counter,
+                                uint32_t per_frame);
+
+/**
+ * @brief Select the velocity curve used by subsequent hits
+ * @param curve AUDIO_VELOCITY_LINEAR, AUDIO_VELOCITY_EXP or AUDIO_VELOCITY_LOG
+ */
+void AudioMixer_SetVelocityCurve(uint8_t curve);
+
+/**
+ * @brief Get the velocity curve
+ * @return AUDIO_VELOCITY_* value
+ */
+uint8_t AudioMixer_GetVelocityCurve(void);
+
+/**
+ * @brief Enable the master soft clipper (ahead of the limiter)
+ * @param enable 1 to round off peaks gently, 0 to leave them to the limiter
+ */
+void AudioMixer_SetSoftClip(uint8_t enable);
+
+/**
+ * @brief Check if the master soft clipper is enabled
+ * @return 1 if enabled, 0 otherwise
+ */
+uint8_t AudioMixer_GetSoftClip(void);
+
+/**
+ * @brief Get the deepest master limiter gain reduction since the last call
+ * @return Reduction in Q15 (0 = none, 16384 = -6dB)
+ */
+uint16_t AudioMixer_GetGainReduction(void);
+
 /**
  * @brief Trigger sample on channel
+ * @details Safe from the clock interrupt and the main loop: the voice is
+ *          parked while it restarts, so the audio interrupt never mixes a
+ *          half-written voice (it may start one block later instead).
  * @param channel Channel number (0-3)
  * @param velocity Velocity (0-255)
  */
 void AudioMixer_Trigger(uint8_t channel, uint8_t velocity);
 
+/**
+ * @brief Trigger a burst of evenly spaced hits (ratchet)
+ * @details The first hit starts like AudioMixer_Trigger; the rest are
+ *          counted down in the mixer, so their spacing is exact to the
+ *          sample regardless of block size or clock interrupt timing.
+ *          A plain trigger on the channel cancels the remaining hits.
+ * @param channel Channel number (0-5)
+ * @param velocity Velocity of the last hit (0-255)
+ * @param hits Number of hits (1-8)
+ * @param interval Samples between hit onsets
+ * @param ramp 1 = velocity rises evenly up to @p velocity, 0 = all equal
+ */
+void AudioMixer_TriggerRepeat(uint8_t channel, uint8_t velocity, uint8_t hits,
+                              uint32_t interval, uint8_t ramp);
+
+/**
+ * @brief Post a trigger from an input interrupt
+ * @details Queued without locking and applied at the start of the next
+ *          audio block, ahead of any sequencer trigger in that block.
+ *          Single producer: call from one interrupt priority only (the
+ *          clock and pad interrupts share it).
+ * @param channel Channel number (0-5)
+ * @param velocity Velocity (0-255)
+ * @return 0 on success, -1 if the queue is full
+ */
+int AudioMixer_PostTrigger(uint8_t channel, uint8_t velocity);
+
 /**
  * @brief Process audio (fill output buffer)
+ * @details Channels are summed at 32 bits and passed through the master
+ *          limiter, which delays the mix by 128 frames (2.9ms).
  * @param output Output buffer (stereo interleaved)
  * @param length Number of stereo frames
  */
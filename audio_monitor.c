@@ -0,0 +1,85 @@
+#include "audio_monitor.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const volatile uint32_t *cycle_counter = NULL;
+static uint32_t cycles_per_frame = 0;
+static uint32_t render_start = 0;
+
+/* Statistics (audio interrupt writes, main loop reads) */
+static volatile uint8_t reset_pending = 0;
+static uint32_t renders = 0;
+static uint32_t underruns = 0;
+static uint32_t min_cycles = 0;
+static uint32_t max_cycles = 0;
+static uint64_t sum_cycles = 0;
+static uint32_t deadline_cycles = 0;
+static uint32_t min_margin = 0;
+static uint32_t histogram[AUDIO_MONITOR_BINS];
+
+static void clear_stats(void) {
+  renders = 0;
+  underruns = 0;
+  min_cycles = UINT32_MAX;
+  max_cycles = 0;
+  sum_cycles = 0;
+  min_margin = UINT32_MAX;
+  memset(histogram, 0, sizeof(histogram));
+}
+
+void AudioMonitor_Init(const volatile uint32_t *counter, uint32_t per_frame) {
+  cycle_counter = NULL;
+  cycles_per_frame = per_frame;
+  clear_stats();
+  reset_pending = 0;
+  cycle_counter = counter;
+}
+
+void AudioMonitor_Begin(void) {
+  if (cycle_counter)
+    render_start = *cycle_counter;
+}
+
+void AudioMonitor_End(uint32_t frames, uint32_t margin, uint8_t late) {
+  if (!cycle_counter)
+    return;
+
+  uint32_t took = *cycle_counter - render_start;
+
+  if (reset_pending) {
+    clear_stats();
+    reset_pending = 0;
+  }
+
+  deadline_cycles = frames * cycles_per_frame;
+  renders++;
+  sum_cycles += took;
+  if (took < min_cycles)
+    min_cycles = took;
+  if (took > max_cycles)
+    max_cycles = took;
+  if (late)
+    underruns++;
+  if (margin < min_margin)
+    min_margin = margin;
+
+  uint32_t bin = AUDIO_MONITOR_BINS - 1;
+  if (took < deadline_cycles)
+    bin = (uint32_t)((uint64_t)took * (AUDIO_MONITOR_BINS - 1) /
+                     deadline_cycles);
+  histogram[bin]++;
+}
+
+void AudioMonitor_Reset(void) { reset_pending = 1; }
+
+void AudioMonitor_GetStats(AudioMonitorStats *stats) {
+  stats->renders = renders;
+  stats->underruns = underruns;
+  stats->min_cycles = renders ? min_cycles : 0;
+  stats->avg_cycles = renders ? (uint32_t)(sum_cycles / renders) : 0;
+  stats->max_cycles = max_cycles;
+  stats->deadline_cycles = deadline_cycles;
+  stats->min_margin = renders ? min_margin : 0;
+  memcpy(stats->histogram, histogram, sizeof(stats->histogram));
+}
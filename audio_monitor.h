@@ -0,0 +1,56 @@
+#ifndef AUDIO_MONITOR_H
+#define AUDIO_MONITOR_H
+
+#include <stdint.h>
+
+/* Render time histogram: eighths of the deadline, last bin = over it */
+#define AUDIO_MONITOR_BINS 9
+
+/**
+ * @brief Audio render statistics (since the last reset)
+ */
+typedef struct {
+  uint32_t renders;         /* Buffers rendered */
+  uint32_t underruns;       /* Renders done after the DMA needed them */
+  uint32_t min_cycles;      /* Shortest render, interrupt entry to exit */
+  uint32_t avg_cycles;      /* Mean render */
+  uint32_t max_cycles;      /* Longest render */
+  uint32_t deadline_cycles; /* One buffer period at the current block size */
+  uint32_t min_margin;      /* Fewest frames queued when a render ended */
+  uint32_t histogram[AUDIO_MONITOR_BINS];
+} AudioMonitorStats;
+
+/**
+ * @brief Give the monitor a free-running cycle counter
+ * @details Without one nothing is measured. Resets the statistics.
+ * @param counter Counter register (e.g. the DWT cycle counter)
+ * @param per_frame Counter cycles per output frame
+ */
+void AudioMonitor_Init(const volatile uint32_t *counter, uint32_t per_frame);
+
+/**
+ * @brief Mark the start of a render (audio interrupt entry)
+ */
+void AudioMonitor_Begin(void);
+
+/**
+ * @brief Mark the end of a render (audio interrupt exit)
+ * @param frames Frames rendered (one buffer period)
+ * @param margin Frames the DMA still had to play from the other buffer
+ * @param late 1 if the DMA had already moved on to the rendered buffer
+ */
+void AudioMonitor_End(uint32_t frames, uint32_t margin, uint8_t late);
+
+/**
+ * @brief Clear the statistics
+ * @details Takes effect at the end of the next render. Main loop only.
+ */
+void AudioMonitor_Reset(void);
+
+/**
+ * @brief Get audio render statistics
+ * @param stats Structure to fill
+ */
+void AudioMonitor_GetStats(AudioMonitorStats *stats);
+
+#endif
@@ -1,5 +1,6 @@
 #include "buttons.h"
 #include "encoder.h" /* For Encoder_HandleRotation */
+#include "profiler.h"
 #include <stdint.h>
 
 /* STM32F411 Register Definitions */
@@ -11,6 +12,7 @@
 #define RCC_BASE (AHB1PERIPH_BASE + 0x3800UL)
 #define GPIOA_BASE (AHB1PERIPH_BASE + 0x0000UL)
 #define GPIOB_BASE (AHB1PERIPH_BASE + 0x0400UL)
+#define GPIOC_BASE (AHB1PERIPH_BASE + 0x0800UL)
 #define SYSCFG_BASE (APB2PERIPH_BASE + 0x3800UL)
 #define EXTI_BASE (APB2PERIPH_BASE + 0x3C00UL)
 #define TIM5_BASE (APB1PERIPH_BASE + 0x0C00UL)
@@ -29,10 +31,14 @@
 #define GPIOB_PUPDR (*(volatile uint32_t *)(GPIOB_BASE + 0x0C))
 #define GPIOB_IDR (*(volatile uint32_t *)(GPIOB_BASE + 0x10))
 
+#define GPIOC_MODER (*(volatile uint32_t *)(GPIOC_BASE + 0x00))
+#define GPIOC_PUPDR (*(volatile uint32_t *)(GPIOC_BASE + 0x0C))
+
 /* SYSCFG Registers */
 #define SYSCFG_EXTICR1 (*(volatile uint32_t *)(SYSCFG_BASE + 0x08))
 #define SYSCFG_EXTICR2 (*(volatile uint32_t *)(SYSCFG_BASE + 0x0C))
 #define SYSCFG_EXTICR3 (*(volatile uint32_t *)(SYSCFG_BASE + 0x10))
+#define SYSCFG_EXTICR4 (*(volatile uint32_t *)(SYSCFG_BASE + 0x14))
 
 /* EXTI Registers */
 #define EXTI_IMR (*(volatile uint32_t *)(EXTI_BASE + 0x00))
@@ -52,8 +58,14 @@
 #define NVIC_ISER0 (*(volatile uint32_t *)0xE000E100)
 #define NVIC_ISER1 (*(volatile uint32_t *)0xE000E104)
 
+/* Pads sit on EXTI10-15, pad N on line 10 + N */
+#define PAD_EXTI_SHIFT 10
+#define PAD_EXTI_MASK (0x3FUL << PAD_EXTI_SHIFT)
+
 /* State */
 static ButtonCallback button_callback = 0;
+static PadCallback pad_callback = 0;
+static volatile uint32_t pads_locked = 0; /* EXTI lines waiting for TIM5 */
 static volatile uint8_t buttons_active_mask =
     0; /* Bit 0: Start, Bit 1: Encoder, Bit 2: Edit, Bit 3: Pattern */
 
@@ -138,6 +150,32 @@ void Button_Init(void) {
   /* Enable EXTI9_5 interrupt in NVIC (IRQ 23) */
   NVIC_ISER0 |= (1 << 23);
 
+  /* --- Configure Trigger Pads (PA10, PA11, PA12, PB13, PB14, PC15) --- */
+  /* Input, Pull-Up */
+  RCC_AHB1ENR |= (1 << 2); /* GPIOC */
+  GPIOA_MODER &= ~((3UL << (10 * 2)) | (3UL << (11 * 2)) | (3UL << (12 * 2)));
+  GPIOA_PUPDR &= ~((3UL << (10 * 2)) | (3UL << (11 * 2)) | (3UL << (12 * 2)));
+  GPIOA_PUPDR |= (1UL << (10 * 2)) | (1UL << (11 * 2)) | (1UL << (12 * 2));
+  GPIOB_MODER &= ~((3UL << (13 * 2)) | (3UL << (14 * 2)));
+  GPIOB_PUPDR &= ~((3UL << (13 * 2)) | (3UL << (14 * 2)));
+  GPIOB_PUPDR |= (1UL << (13 * 2)) | (1UL << (14 * 2));
+  GPIOC_MODER &= ~(3UL << (15 * 2));
+  GPIOC_PUPDR &= ~(3UL << (15 * 2));
+  GPIOC_PUPDR |= (1UL << (15 * 2));
+
+  /* PA10, PA11 -> EXTI10, EXTI11 (Port A = 0000) */
+  SYSCFG_EXTICR3 &= ~((0xF << 8) | (0xF << 12));
+  /* PA12 -> EXTI12, PB13/PB14 -> EXTI13/14 (0001), PC15 -> EXTI15 (0010) */
+  SYSCFG_EXTICR4 = (0 << 0) | (1 << 4) | (1 << 8) | (2 << 12);
+
+  /* Falling edge (Active Low): trigger on press only */
+  EXTI_FTSR |= PAD_EXTI_MASK;
+  EXTI_RTSR &= ~PAD_EXTI_MASK;
+  EXTI_IMR |= PAD_EXTI_MASK;
+
+  /* Enable EXTI15_10 interrupt in NVIC (IRQ 40) */
+  NVIC_ISER1 |= (1 << (40 - 32));
+
   /* --- Configure TIM5 for debounce --- */
   TIM5_PSC = 47999;      /* 1ms tick */
   TIM5_ARR = 20;         /* 20ms */
@@ -147,7 +185,10 @@ void Button_Init(void) {
 
 void Button_SetCallback(ButtonCallback callback) { button_callback = callback; }
 
+void Button_SetPadCallback(PadCallback callback) { pad_callback = callback; }
+
 void EXTI0_IRQHandler(void) {
+  PROFILE_ENTER(PROF_INPUT);
   if (EXTI_PR & (1 << 0)) {
     EXTI_PR = (1 << 0);
     EXTI_IMR &= ~(1 << 0); /* Mask EXTI0 */
@@ -155,9 +196,11 @@ void EXTI0_IRQHandler(void) {
     TIM5_CNT = 0;
     TIM5_CR1 |= (1 << 0); /* Start timer */
   }
+  PROFILE_EXIT();
 }
 
 void EXTI1_IRQHandler(void) {
+  PROFILE_ENTER(PROF_INPUT);
   if (EXTI_PR & (1 << 1)) {
     EXTI_PR = (1 << 1);
     EXTI_IMR &= ~(1 << 1); /* Mask EXTI1 */
@@ -165,9 +208,11 @@ void EXTI1_IRQHandler(void) {
     TIM5_CNT = 0;
     TIM5_CR1 |= (1 << 0); /* Start timer */
   }
+  PROFILE_EXIT();
 }
 
 void EXTI9_5_IRQHandler(void) {
+  PROFILE_ENTER(PROF_INPUT);
   uint32_t pr = EXTI_PR;
 
   /* Check PB6 (Enc A) / PB7 (Enc B) */
@@ -193,12 +238,48 @@ void EXTI9_5_IRQHandler(void) {
     TIM5_CNT = 0;
     TIM5_CR1 |= (1 << 0); /* Start timer */
   }
+  PROFILE_EXIT();
+}
+
+static inline void __disable_irq(void) {
+  __asm volatile("cpsid i" : : : "memory");
+}
+static inline void __enable_irq(void) {
+  __asm volatile("cpsie i" : : : "memory");
+}
+
+/**
+ * @brief Trigger pads: play on the first edge, then ignore bounce
+ * @note Runs at the sequencer clock's priority so hits land on a stable
+ *       step position
+ */
+void EXTI15_10_IRQHandler(void) {
+  uint32_t pr = EXTI_PR & PAD_EXTI_MASK;
+  if (pr == 0)
+    return;
+
+  PROFILE_ENTER(PROF_PADS);
+  EXTI_PR = pr;
+  EXTI_IMR &= ~pr; /* Mask until the debounce timer expires */
+  pads_locked |= pr;
+
+  for (uint8_t pad = 0; pad < NUM_PADS; pad++) {
+    if ((pr & (1UL << (PAD_EXTI_SHIFT + pad))) && pad_callback)
+      pad_callback(pad, PAD_VELOCITY);
+  }
+
+  TIM5_CNT = 0;
+  TIM5_CR1 |= (1 << 0); /* Start timer */
+  PROFILE_EXIT();
 }
 
 static volatile uint8_t pending_callback_mask = 0;
 
 void TIM5_IRQHandler(void) {
+  PROFILE_ENTER(PROF_DEBOUNCE);
   if (TIM5_SR & (1 << 0)) {
+    /* EXTI_IMR is also written by the (higher priority) pad interrupt */
+    __disable_irq();
     TIM5_SR &= ~(1 << 0);
     TIM5_CR1 &= ~(1 << 0); /* Stop timer */
 
@@ -235,14 +316,13 @@ void TIM5_IRQHandler(void) {
     }
 
     buttons_active_mask = 0;
-  }
-}
 
-static inline void __disable_irq(void) {
-  __asm volatile("cpsid i" : : : "memory");
-}
-static inline void __enable_irq(void) {
-  __asm volatile("cpsie i" : : : "memory");
+    /* Pads: bounce is over, listen again */
+    EXTI_IMR |= pads_locked;
+    pads_locked = 0;
+    __enable_irq();
+  }
+  PROFILE_EXIT();
 }
 
 void Button_HandleEvents(void) {
@@ -9,6 +9,10 @@
 #define BUTTON_DRUMSET 2
 #define BUTTON_PATTERN 3
 
+/* Trigger pads, one per channel (PA10, PA11, PA12, PB13, PB14, PC15) */
+#define NUM_PADS 6
+#define PAD_VELOCITY 255 /* Switch pads carry no velocity */
+
 /**
  * @brief Button event callback type
  * @param button_id ID of the button (BUTTON_START or BUTTON_ENCODER)
@@ -16,6 +20,14 @@
  */
 typedef void (*ButtonCallback)(uint8_t button_id, uint8_t pressed);
 
+/**
+ * @brief Pad hit callback type
+ * @details Runs inside the pad interrupt, not the main loop.
+ * @param pad Pad number (0-5), same as the channel
+ * @param velocity Hit velocity (1-255)
+ */
+typedef void (*PadCallback)(uint8_t pad, uint8_t velocity);
+
 /**
  * @brief Initialize button with hardware interrupt
  * @details Configures PA0 with EXTI0 interrupt and TIM5 for debouncing
@@ -28,6 +40,12 @@ void Button_Init(void);
  */
 void Button_SetCallback(ButtonCallback callback);
 
+/**
+ * @brief Set callback for pad hits
+ * @param callback Function called from the pad interrupt on each hit
+ */
+void Button_SetPadCallback(PadCallback callback);
+
 /**
  * @brief Handle pending button events
  * @details Should be called from the main loop to process events safely
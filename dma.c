@@ -1,8 +1,15 @@
 #include "dma.h"
 #include "audio_mixer.h"
+#include "audio_monitor.h"
+#include "profiler.h"
+#include "ramfunc.h"
+#include "trace.h"
+#include <string.h>
 
-/* Audio buffer definition */
-int16_t audio_buffer[AUDIO_BUFFER_SIZE];
+/* Audio buffers: first in RAM and 1KB-aligned (STM32F411.ld), so the
+ * DMA's 4-beat memory bursts never cross a 1KB boundary */
+static int16_t dma_buffers[2][AUDIO_PERIOD_MAX * 2]
+    __attribute__((section(".dma_buffers"), aligned(1024)));
 
 /* STM32F411 Register Definitions */
 #define PERIPH_BASE 0x40000000UL
@@ -20,6 +27,11 @@ int16_t audio_buffer[AUDIO_BUFFER_SIZE];
 #define DMA1_S4NDTR (*(volatile uint32_t *)(DMA1_BASE + 0x74))
 #define DMA1_S4PAR (*(volatile uint32_t *)(DMA1_BASE + 0x78))
 #define DMA1_S4M0AR (*(volatile uint32_t *)(DMA1_BASE + 0x7C))
+#define DMA1_S4M1AR (*(volatile uint32_t *)(DMA1_BASE + 0x80))
+#define DMA1_S4FCR (*(volatile uint32_t *)(DMA1_BASE + 0x84))
+
+#define DMA_SxCR_EN (1UL << 0)
+#define DMA_SxCR_CT (1UL << 19) /* Buffer the DMA is playing (0 = M0) */
 
 /* DMA Interrupt Registers */
 #define DMA1_LISR (*(volatile uint32_t *)(DMA1_BASE + 0x00))
@@ -27,26 +39,44 @@ int16_t audio_buffer[AUDIO_BUFFER_SIZE];
 #define DMA1_LIFCR (*(volatile uint32_t *)(DMA1_BASE + 0x08))
 #define DMA1_HIFCR (*(volatile uint32_t *)(DMA1_BASE + 0x0C))
 
+#define DMA_HISR_TCIF4 (1UL << 5)
+
 #define SPI2_DR (*(volatile uint32_t *)(SPI2_BASE + 0x0C))
 
 /* NVIC */
 #define NVIC_ISER0 (*(volatile uint32_t *)0xE000E100)
+#define NVIC_ICER0 (*(volatile uint32_t *)0xE000E180)
 
-void DMA_Init_I2S(int16_t *buffer, uint32_t len) {
-  /* Enable DMA1 clock */
-  RCC_AHB1ENR |= (1 << 21);
+static uint8_t latency = AUDIO_LATENCY_DEFAULT;
+static volatile uint32_t period_frames = 0;
+
+uint32_t DMA_GetPeriodFrames(uint8_t mode) {
+  if (mode > AUDIO_LATENCY_512)
+    mode = AUDIO_LATENCY_512;
+  return AUDIO_PERIOD_FRAMES(mode);
+}
 
+/**
+ * @brief (Re)start the stream on silent buffers of the mode's size
+ */
+static void start_stream(uint8_t mode) {
   /* Disable stream */
-  DMA1_S4CR &= ~(1 << 0);
-  while (DMA1_S4CR & (1 << 0))
+  DMA1_S4CR &= ~DMA_SxCR_EN;
+  while (DMA1_S4CR & DMA_SxCR_EN)
     ;
 
   /* Clear IRQ flags */
   DMA1_HIFCR = (1 << 5) | (1 << 4) | (1 << 3) | (1 << 2) | (1 << 0);
 
+  latency = mode;
+  period_frames = DMA_GetPeriodFrames(mode);
+  memset(dma_buffers, 0, sizeof(dma_buffers));
+
   /* Configure DMA1 Stream 4 */
   uint32_t cr = 0;
   cr |= (0 << 25); /* Channel 0 */
+  cr |= (1 << 23); /* MBURST: INCR4, fewer bus requests against the CPU */
+  cr |= (1 << 18); /* DBM: Double buffer mode (circular implied) */
   cr |= (3 << 16); /* Priority: Very High */
   cr |= (1 << 13); /* MSIZE: 16-bit */
   cr |= (1 << 11); /* PSIZE: 16-bit */
@@ -54,41 +84,79 @@ void DMA_Init_I2S(int16_t *buffer, uint32_t len) {
   cr |= (1 << 8);  /* CIRC: Circular mode */
   cr |= (1 << 6);  /* DIR: Memory to Peripheral */
   cr |= (1 << 4);  /* TCIE: Transfer Complete Interrupt Enable */
-  cr |= (1 << 3);  /* HTIE: Half Transfer Interrupt Enable */
 
   DMA1_S4CR = cr;
 
-  DMA1_S4NDTR = len; /* Length is in 16-bit units */
+  /* FIFO on (bursts need it), refilled when empty enough for a burst */
+  DMA1_S4FCR = (1 << 2) | (3 << 0); /* DMDIS, FTH: full */
+
+  DMA1_S4NDTR = period_frames * 2; /* Length is in 16-bit units */
   DMA1_S4PAR = (uint32_t)(uintptr_t)&SPI2_DR;
-  DMA1_S4M0AR = (uint32_t)(uintptr_t)buffer;
+  DMA1_S4M0AR = (uint32_t)(uintptr_t)dma_buffers[0];
+  DMA1_S4M1AR = (uint32_t)(uintptr_t)dma_buffers[1];
+
+  /* Enable stream */
+  DMA1_S4CR |= DMA_SxCR_EN;
+}
+
+void DMA_Init_I2S(uint8_t mode) {
+  /* Enable DMA1 clock */
+  RCC_AHB1ENR |= (1 << 21);
+
+  if (DMA_GetPeriodFrames(mode) > AUDIO_PERIOD_MAX)
+    mode = AUDIO_LATENCY_DEFAULT;
+  start_stream(mode);
 
   /* Enable IRQ in NVIC (DMA1_Stream4 is IRQ 15) */
   NVIC_ISER0 |= (1 << 15);
+}
 
-  /* Enable stream */
-  DMA1_S4CR |= (1 << 0);
+int DMA_SetLatency(uint8_t mode) {
+  if (mode > AUDIO_LATENCY_512 || DMA_GetPeriodFrames(mode) > AUDIO_PERIOD_MAX)
+    return -1;
+  if (mode == latency)
+    return 0;
+
+  NVIC_ICER0 = (1 << 15);
+  start_stream(mode);
+  NVIC_ISER0 = (1 << 15);
+  return 0;
 }
 
+uint8_t DMA_GetLatency(void) { return latency; }
+
 /**
  * @brief DMA1 Stream 4 Interrupt Handler
- * @note Called at Half-Transfer (fills first half) and Transfer-Complete (fills
- * second half)
+ * @note Called when the DMA finishes a buffer and switches to the other:
+ *       the finished one is refilled while the other plays.
  */
-void DMA1_Stream4_IRQHandler(void) {
-  /* Check TCIF4 (Bit 5 in HISR) */
-  if (DMA1_HISR & (1 << 5)) {
-    DMA1_HIFCR = (1 << 5); /* Clear TC flag */
-
-    /* Transfer Complete: Fill Second Half */
-    AudioMixer_Process(&audio_buffer[AUDIO_BUFFER_SIZE / 2],
-                       AUDIO_BUFFER_SIZE / 4);
-  }
-
-  /* Check HTIF4 (Bit 4 in HISR) */
-  if (DMA1_HISR & (1 << 4)) {
-    DMA1_HIFCR = (1 << 4); /* Clear HT flag */
-
-    /* Half Transfer: Fill First Half */
-    AudioMixer_Process(&audio_buffer[0], AUDIO_BUFFER_SIZE / 4);
+RAMFUNC void DMA1_Stream4_IRQHandler(void) {
+  PROFILE_ENTER(PROF_AUDIO);
+  AudioMonitor_Begin();
+  TRACE(TRACE_RENDER_BEGIN, latency, 0);
+
+  if (DMA1_HISR & DMA_HISR_TCIF4) {
+    DMA1_HIFCR = DMA_HISR_TCIF4;
+
+    uint32_t playing = DMA1_S4CR & DMA_SxCR_CT;
+    AudioMixer_Process(dma_buffers[playing ? 0 : 1], period_frames);
+
+    /* Frames left in the playing buffer (NDTR counts 16-bit transfers).
+     * Read before CT: a switch in between still shows up as late. If the
+     * DMA finished the other buffer first, it is now playing (or has
+     * played) the one we were still writing. */
+    uint32_t left = DMA1_S4NDTR / 2;
+    uint8_t late = (DMA1_S4CR & DMA_SxCR_CT) != playing ||
+                   (DMA1_HISR & DMA_HISR_TCIF4);
+    AudioMonitor_End(period_frames, late ? 0 : left, late);
+    TRACE(TRACE_RENDER_END, late, (left > 1020) ? 255 : left / 4);
+    if (late) {
+      /* Keep the events that led up to it */
+      TRACE(TRACE_UNDERRUN, 0, 0);
+#if TRACE_ENABLE
+      Trace_Freeze();
+#endif
+    }
   }
+  PROFILE_EXIT();
 }
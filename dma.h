@@ -3,11 +3,50 @@
 
 #include <stdint.h>
 
-/* Audio buffer for DMA transfers */
-#define AUDIO_BUFFER_SIZE                                                      \
-  512 /* Stereo samples (256 frames) -> ~2.9ms latency */
-extern int16_t audio_buffer[AUDIO_BUFFER_SIZE];
+/* Latency modes: frames per DMA buffer. Two buffers alternate (double
+ * buffer mode), so each render has one full buffer period to finish. */
+#define AUDIO_LATENCY_64 0  /* 1.5ms: tightest pads, least slack */
+#define AUDIO_LATENCY_128 1 /* 2.9ms (default) */
+#define AUDIO_LATENCY_256 2 /* 5.8ms */
+#define AUDIO_LATENCY_512 3 /* 11.6ms: most slack for heavy SD load */
+#define AUDIO_LATENCY_DEFAULT AUDIO_LATENCY_128
 
-void DMA_Init_I2S(int16_t *buffer, uint32_t len);
+#define AUDIO_PERIOD_FRAMES(mode) (64UL << (mode))
+
+/* Largest period built in. The buffers take 8 bytes per frame of it, out
+ * of the RAM the effects would otherwise get; build with 512 to allow
+ * AUDIO_LATENCY_512. */
+#ifndef AUDIO_PERIOD_MAX
+#define AUDIO_PERIOD_MAX 256
+#endif
+
+/**
+ * @brief Start audio DMA to I2S2 (DMA1 Stream 4, double buffer mode)
+ * @details Each render is timed by AudioMonitor (audio_monitor.h).
+ * @param mode AUDIO_LATENCY_* (falls back to the default if not built in)
+ */
+void DMA_Init_I2S(uint8_t mode);
+
+/**
+ * @brief Switch latency mode
+ * @details Restarts the stream with silent buffers (a short gap in the
+ *          output). Main loop only.
+ * @param mode AUDIO_LATENCY_*
+ * @return 0 on success, -1 if the mode exceeds AUDIO_PERIOD_MAX
+ */
+int DMA_SetLatency(uint8_t mode);
+
+/**
+ * @brief Get the latency mode
+ * @return AUDIO_LATENCY_* value
+ */
+uint8_t DMA_GetLatency(void);
+
+/**
+ * @brief Get frames per buffer of a latency mode
+ * @param mode AUDIO_LATENCY_*
+ * @return Frames per buffer
+ */
+uint32_t DMA_GetPeriodFrames(uint8_t mode);
 
 #endif
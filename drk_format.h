@@ -0,0 +1,40 @@
+#ifndef DRK_FORMAT_H
+#define DRK_FORMAT_H
+
+#include <stdint.h>
+
+/* Baked kit (.DRK): one header sector followed by raw PCM.
+ * Each channel's PCM starts on a 512-byte boundary so the whole sample
+ * region can be streamed with a single multi-block read.
+ * Shared by the firmware and tools/drkbake.c (little endian).
+ */
+#define DRK_MAGIC "DRK1"
+#define DRK_VERSION 1
+#define DRK_CHANNELS 6
+#define DRK_SECTOR_SIZE 512
+#define DRK_PATH_LEN 64
+
+typedef struct {
+  uint32_t data_sector; /* PCM start, in sectors from file start (0=empty) */
+  uint32_t length;      /* Length in samples (16-bit mono, 44.1kHz) */
+  uint8_t volume;       /* 0-255 */
+  uint8_t pan;          /* 0=Left, 128=Center, 255=Right */
+  uint8_t hold;         /* Envelope hold, 10ms units */
+  uint8_t decay;        /* Envelope decay, 10ms units (0=off) */
+  uint8_t filter_mode;  /* AUDIO_FILTER_* (0=off) */
+  uint8_t cutoff;       /* 0-255, 0 with the filter off = default (open) */
+  uint8_t resonance;    /* 0-255 */
+  uint8_t reserved;
+  char path[DRK_PATH_LEN]; /* Source path, as stored in .DRM */
+} __attribute__((packed)) DRKChannel;
+
+typedef struct {
+  char magic[4];         /* "DRK1" */
+  uint16_t version;      /* DRK_VERSION */
+  uint16_t num_channels; /* DRK_CHANNELS */
+  uint32_t pcm_sectors;  /* Sectors of PCM following the header */
+  uint32_t reserved;
+  DRKChannel channels[DRK_CHANNELS];
+} __attribute__((packed)) DRKHeader;
+
+#endif
@@ -334,13 +334,16 @@ int FAT32_FileExists(uint32_t dir_cluster, const char *filename) {
   return 0;
 }
 
-int FAT32_WriteFile(uint32_t dir_cluster, const char *filename,
-                    const uint8_t *data, uint32_t size) {
-  // Simplified implementation for small files (<512 bytes)
-  if (size > 512) {
-    return -1;
-  }
-
+/**
+ * @brief Locate a directory entry for writing
+ * @details Finds the entry named filename, or the first free entry
+ * @param sec_out Sector index (within the directory cluster) of the entry
+ * @param entry_out Entry index within that sector
+ * @param found_out 1 if an existing file was found, 0 for a free entry
+ * @return 0 on success, -2 on read error, -3 if the directory is full
+ */
+static int find_dir_slot(uint32_t dir_cluster, const char *filename,
+                         int *sec_out, int *entry_out, int *found_out) {
   uint32_t dir_sector = cluster_to_sector(dir_cluster);
   int found_entry = -1;
   int found_sector = -1;
@@ -383,43 +386,24 @@ int FAT32_WriteFile(uint32_t dir_cluster, const char *filename,
     }
   }
 
-  int use_entry = (found_entry != -1) ? found_entry : empty_entry;
-  int use_sector = (found_entry != -1) ? found_sector : empty_sector;
+  *found_out = (found_entry != -1);
+  *entry_out = (found_entry != -1) ? found_entry : empty_entry;
+  *sec_out = (found_entry != -1) ? found_sector : empty_sector;
 
-  if (use_entry == -1) {
+  if (*entry_out == -1) {
     return -3; /* Directory full */
   }
+  return 0;
+}
 
-  uint32_t file_cluster = 0;
-  if (found_entry != -1) {
-    /* Get existing cluster before re-reading buffer */
-    if (SDCARD_ReadBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
-      return -2;
-    }
-    uint8_t *temp_entry = sector_buffer + (use_entry * 32);
-    uint16_t cluster_hi = read_u16(temp_entry, DIR_FSTCLUS_HI);
-    uint16_t cluster_lo = read_u16(temp_entry, DIR_FSTCLUS_LO);
-    file_cluster = ((uint32_t)cluster_hi << 16) | cluster_lo;
-  } else {
-    /* Allocate new cluster */
-    file_cluster = allocate_free_cluster();
-  }
-
-  if (file_cluster < 3 || file_cluster == 0xFFFFFFFF) {
-    return (file_cluster == 0xFFFFFFFF) ? -5 : -4;
-  }
-
-  /* CRITICAL: Re-read the directory sector here to ensure sector_buffer is
-     fresh and contains directory data, not FAT data left over from previous
-     searches or allocations */
-  if (SDCARD_ReadBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
-    return -2;
-  }
-
-  uint8_t *dir_entry = sector_buffer + (use_entry * 32);
-
+/**
+ * @brief Fill an 8.3 directory entry for a regular file
+ */
+static void fill_dir_entry(uint8_t *dir_entry, const char *filename,
+                           uint32_t size, uint32_t file_cluster,
+                           int is_new) {
   // If new entry, clear it first
-  if (found_entry == -1) {
+  if (is_new) {
     memset(dir_entry, 0, 32);
   }
 
@@ -453,14 +437,57 @@ int FAT32_WriteFile(uint32_t dir_cluster, const char *filename,
     dir_entry[DIR_NAME + 8 + i] = ext_part[i];
   }
 
-  dir_entry[DIR_ATTR] = ATTR_ARCHIVE;
-  write_u32(dir_entry, DIR_FILE_SIZE, size);
-
-  /* Mark entry details in directory (now safe to edit dir_entry) */
+  /* Mark entry details in directory */
   dir_entry[DIR_ATTR] = ATTR_ARCHIVE;
   write_u32(dir_entry, DIR_FILE_SIZE, size);
   write_u16(dir_entry, DIR_FSTCLUS_HI, (file_cluster >> 16) & 0xFFFF);
   write_u16(dir_entry, DIR_FSTCLUS_LO, file_cluster & 0xFFFF);
+}
+
+int FAT32_WriteFile(uint32_t dir_cluster, const char *filename,
+                    const uint8_t *data, uint32_t size) {
+  // Simplified implementation for small files (<512 bytes)
+  if (size > 512) {
+    return -1;
+  }
+
+  uint32_t dir_sector = cluster_to_sector(dir_cluster);
+  int use_sector, use_entry, found;
+
+  int res = find_dir_slot(dir_cluster, filename, &use_sector, &use_entry,
+                          &found);
+  if (res != 0) {
+    return res;
+  }
+
+  uint32_t file_cluster = 0;
+  if (found) {
+    /* Get existing cluster before re-reading buffer */
+    if (SDCARD_ReadBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
+      return -2;
+    }
+    uint8_t *temp_entry = sector_buffer + (use_entry * 32);
+    uint16_t cluster_hi = read_u16(temp_entry, DIR_FSTCLUS_HI);
+    uint16_t cluster_lo = read_u16(temp_entry, DIR_FSTCLUS_LO);
+    file_cluster = ((uint32_t)cluster_hi << 16) | cluster_lo;
+  } else {
+    /* Allocate new cluster */
+    file_cluster = allocate_free_cluster();
+  }
+
+  if (file_cluster < 3 || file_cluster == 0xFFFFFFFF) {
+    return (file_cluster == 0xFFFFFFFF) ? -5 : -4;
+  }
+
+  /* CRITICAL: Re-read the directory sector here to ensure sector_buffer is
+     fresh and contains directory data, not FAT data left over from previous
+     searches or allocations */
+  if (SDCARD_ReadBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
+    return -2;
+  }
+
+  uint8_t *dir_entry = sector_buffer + (use_entry * 32);
+  fill_dir_entry(dir_entry, filename, size, file_cluster, !found);
 
   // Write updated directory
   if (SDCARD_WriteBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
@@ -481,3 +508,170 @@ int FAT32_WriteFile(uint32_t dir_cluster, const char *filename,
 
   return 0;
 }
+
+/* FAT sector cache for chain walks and multi-cluster allocation */
+#define FAT_SCAN_SECTORS 200 /* Same coverage as allocate_free_cluster */
+#define FAT_EOC 0x0FFFFFF8   /* Values >= this end a cluster chain */
+
+static uint8_t fat_cache[512];
+static uint32_t fat_cache_sector = 0xFFFFFFFF;
+static uint8_t fat_cache_dirty = 0;
+
+static int fat_flush(void) {
+  if (fat_cache_dirty) {
+    if (SDCARD_WriteBlock(fat_cache_sector, fat_cache) != SDCARD_OK) {
+      return -1;
+    }
+    fat_cache_dirty = 0;
+  }
+  return 0;
+}
+
+static int fat_load(uint32_t fat_sector) {
+  if (fat_sector == fat_cache_sector) {
+    return 0;
+  }
+  if (fat_flush() != 0) {
+    return -1;
+  }
+  if (SDCARD_ReadBlock(fat_sector, fat_cache) != SDCARD_OK) {
+    fat_cache_sector = 0xFFFFFFFF;
+    return -1;
+  }
+  fat_cache_sector = fat_sector;
+  return 0;
+}
+
+static int fat_get(uint32_t cluster, uint32_t *value) {
+  uint32_t fat_sector = partition_start_lba + reserved_sectors + cluster / 128;
+  if (fat_load(fat_sector) != 0) {
+    return -1;
+  }
+  *value = read_u32(fat_cache, (cluster % 128) * 4) & 0x0FFFFFFF;
+  return 0;
+}
+
+static int fat_set(uint32_t cluster, uint32_t value) {
+  uint32_t fat_sector = partition_start_lba + reserved_sectors + cluster / 128;
+  if (fat_load(fat_sector) != 0) {
+    return -1;
+  }
+  write_u32(fat_cache, (cluster % 128) * 4, value);
+  fat_cache_dirty = 1;
+  return 0;
+}
+
+/**
+ * @brief Find a run of consecutive free clusters
+ * @return First cluster of the run, 0 if none found
+ */
+static uint32_t find_free_run(uint32_t count) {
+  uint32_t run_start = 0;
+  uint32_t run_len = 0;
+
+  for (uint32_t cluster = 3; cluster < FAT_SCAN_SECTORS * 128; cluster++) {
+    uint32_t value;
+    if (fat_get(cluster, &value) != 0) {
+      return 0;
+    }
+    if (value == 0) {
+      if (run_len == 0) {
+        run_start = cluster;
+      }
+      if (++run_len == count) {
+        return run_start;
+      }
+    } else {
+      run_len = 0;
+    }
+  }
+  return 0;
+}
+
+int FAT32_CreateContiguous(uint32_t dir_cluster, const char *filename,
+                           uint32_t size, uint32_t *first_sector) {
+  uint32_t cluster_bytes = (uint32_t)sectors_per_cluster * SECTOR_SIZE;
+  uint32_t clusters = (size + cluster_bytes - 1) / cluster_bytes;
+  if (clusters == 0) {
+    clusters = 1;
+  }
+
+  /* FAT may have been changed by allocate_free_cluster since last use */
+  fat_cache_sector = 0xFFFFFFFF;
+  fat_cache_dirty = 0;
+
+  uint32_t dir_sector = cluster_to_sector(dir_cluster);
+  int use_sector, use_entry, found;
+  int res = find_dir_slot(dir_cluster, filename, &use_sector, &use_entry,
+                          &found);
+  if (res != 0) {
+    return res;
+  }
+
+  /* Free the previous chain so the new run can reuse it */
+  if (found) {
+    uint8_t *old_entry = sector_buffer + (use_entry * 32);
+    uint32_t cluster = ((uint32_t)read_u16(old_entry, DIR_FSTCLUS_HI) << 16) |
+                       read_u16(old_entry, DIR_FSTCLUS_LO);
+    uint32_t guard = FAT_SCAN_SECTORS * 128;
+    while (cluster >= 3 && cluster < FAT_EOC && guard--) {
+      uint32_t next;
+      if (fat_get(cluster, &next) != 0 || fat_set(cluster, 0) != 0) {
+        return -5;
+      }
+      cluster = next;
+    }
+  }
+
+  uint32_t start = find_free_run(clusters);
+  if (start == 0) {
+    fat_flush();
+    return -4; /* No contiguous space */
+  }
+
+  /* Link the run into one chain */
+  for (uint32_t i = 0; i < clusters; i++) {
+    uint32_t next = (i == clusters - 1) ? 0x0FFFFFFF : start + i + 1;
+    if (fat_set(start + i, next) != 0) {
+      return -5;
+    }
+  }
+  if (fat_flush() != 0) {
+    return -5;
+  }
+
+  /* Point the directory entry at the new chain */
+  if (SDCARD_ReadBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
+    return -2;
+  }
+  fill_dir_entry(sector_buffer + (use_entry * 32), filename, size, start,
+                 !found);
+  if (SDCARD_WriteBlock(dir_sector + use_sector, sector_buffer) != SDCARD_OK) {
+    return -5;
+  }
+
+  *first_sector = cluster_to_sector(start);
+  return 0;
+}
+
+int FAT32_IsContiguous(FAT32_FileEntry *file) {
+  uint32_t cluster = file->first_cluster;
+  if (cluster < 2) {
+    return 0;
+  }
+
+  uint32_t cluster_bytes = (uint32_t)sectors_per_cluster * SECTOR_SIZE;
+  uint32_t clusters = (file->size + cluster_bytes - 1) / cluster_bytes;
+
+  fat_cache_sector = 0xFFFFFFFF;
+  fat_cache_dirty = 0;
+
+  for (uint32_t i = 1; i < clusters; i++) {
+    uint32_t next;
+    if (fat_get(cluster, &next) != 0 || next != cluster + 1) {
+      return 0;
+    }
+    cluster = next;
+  }
+  return 1;
+}
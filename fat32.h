@@ -71,4 +71,25 @@ int FAT32_FileExists(uint32_t dir_cluster, const char *filename);
 int FAT32_WriteFile(uint32_t dir_cluster, const char *filename,
                     const uint8_t *data, uint32_t size);
 
+/**
+ * @brief Create or replace a file backed by consecutive clusters
+ * @details Allocates the chain and directory entry only; the caller writes
+ *          the data with SDCARD_WriteBlock starting at first_sector.
+ * @param dir_cluster Directory cluster where file should be created
+ * @param filename Filename (8.3 format, e.g., "KIT-001.DRK")
+ * @param size File size in bytes
+ * @param first_sector Returns the first data sector of the file
+ * @return 0 on success, -3 if directory full, -4 if no contiguous space,
+ *         -2/-5 on I/O error
+ */
+int FAT32_CreateContiguous(uint32_t dir_cluster, const char *filename,
+                           uint32_t size, uint32_t *first_sector);
+
+/**
+ * @brief Check that a file's clusters are consecutive on the card
+ * @param file File entry
+ * @return 1 if the whole file can be read linearly, 0 otherwise
+ */
+int FAT32_IsContiguous(FAT32_FileEntry *file);
+
 #endif
@@ -0,0 +1,2714 @@
+/*
+ * drumbench - golden-output and performance suite for the host build
+ *
+ * Usage: drumbench [-i image] [-o out.wav] [-t seconds] [-p period]
+ *                  [-j out.json] [-c baseline.json] [-x percent]
+ *
+ * Formats a FAT32 image (a scratch file under /tmp unless -i names one),
+ * writes synthesized samples, assorted WAV files, a kit, a pattern and a
+ * directory of filler files through the firmware's own code, then runs
+ * the hot paths on fixed inputs:
+ *
+ *   mixer.*    AudioMixer_Process with 0-6 voices, then all six with
+ *              filters and both effects. Run last, after poly.*: the pan
+ *              law (power at every pan, velocity curves, six pans moving),
+ *              the envelope (when hits go silent, six voices decaying),
+ *              six resonant filters swept on every block, and switched off,
+ *              and a full-scale six-voice burst through the limiter (with
+ *              and without soft clip): samples at full scale, peak, cost;
+ *              the effects alone per pass, and what the 6KB (debug) and
+ *              4KB (release) effects RAM holds
+ *   seq.*      TIM2 pulses (TriggerCurrentStep) under a dense polymetric
+ *              pattern with ratchets and conditions, and its render; run
+ *              last, the worst case for the pulse: all six condition types
+ *              on every step (fill on every other bar), ratcheted, the step
+ *              pulses timed on their own, and the trigs that played;
+ *              pulses over an empty and a sparse pattern (on the master
+ *              grid and off it), for the trig bitmaps
+ *   grid.*     SPI bytes of the step edit grid: every cell, as the old
+ *              refresh sent, then the cells the trig bitmap marks after an
+ *              edit and after a pattern swap
+ *   wav.*      WAV_LoadSample, cold, on short, one-sector, full, long and
+ *              rejected (stereo, 48kHz, 8-bit) files
+ *   fat.*      FAT32_FindDir, FAT32_FileExists and FAT32_ListDir in a
+ *              directory of about a hundred files
+ *   kit.*      Drumset_LoadFromSlot, cold (arena emptied) and warm
+ *   pattern.*  Pattern_Save / Pattern_Load over 16 slots; run last, the
+ *              cache's coherence: every byte loaded after a save, a re-save
+ *              with other content, and an eviction and reload; opening
+ *              the pattern menu from the bank's bitmap against the
+ *              directory scan it replaced
+ *   display.*  ST7789_Fill, ST7789_FillRect and ST7789_WriteString
+ *   prof.*     Profiler aggregation: a scripted run of nested sources on
+ *              the simulated cycle counter, then the interrupts counted
+ *              while the pattern plays
+ *   trace.*    A second of the pattern traced, Trace_Dump to a file and
+ *              decoded by tools/tracedump (next to the host directory)
+ *   cache.*    A scripted run of kit loads through the sample cache:
+ *              shared samples, a return to an evicted-from kit, one file
+ *              on every channel and an arena overflow (run last: it adds
+ *              files and kits to the image)
+ *   reload.*   Kit changes over a loaded kit: mix settings only, then one
+ *              channel's sample
+ *   chain.*    A 64-entry song chain at 300 BPM through the song engine,
+ *              kit changes included
+ *   ratchet.*  Onsets of 2-8 hit ratchets at 120 and 300 BPM, found in the
+ *              output of a click sample, against step length / hits
+ *   prng.*     Probability trigs (10-90 %) over 5000 bars, hits counted
+ *              from the trace, with the default seed and another one
+ *   live.*     Pad hits recorded early and late in steps at each quantize
+ *              strength: the steps written, and trigs that sounded twice
+ *   monitor.*  Render statistics over scripted render times, across a
+ *              counter wrap and a reset, then while the pattern plays
+ *   poly.*     Onsets of tracks 3, 4, 5 and 7 steps long, some at half or
+ *              double rate, over eight bars, and the realignment on every
+ *              bar; then a pattern saved before track lengths existed
+ *   latency.*  The full mixer load in each latency mode (64, 128, 256
+ *              frames), render times replayed as the buffer interrupts
+ *              would run on the target: misses with interrupt jitter, then
+ *              under scripted SD stalls
+ *   song       sequencer + mixer playing the pattern (into out.wav)
+ *
+ * Every result is a time (best of several runs), a count (SD blocks, SPI
+ * bytes) or a checksum. -j writes them as JSON, one result per line.
+ * -c compares against such a file and exits with 2 on a regression: a
+ * time more than -x percent (default 25) above the baseline, a count
+ * above it, or any checksum that differs. Simulated time only moves with
+ * rendered audio, so counts and checksums are the same on every machine;
+ * times are only comparable with a baseline taken on the same one.
+ */
+#include "audio_fx.h"
+#include "audio_mixer.h"
+#include "audio_monitor.h"
+#include "dma.h"
+#include "fat32.h"
+#include "host.h"
+#include "live_record.h"
+#include "pattern_manager.h"
+#include "profiler.h"
+#include "sample_cache.h"
+#include "sdcard.h"
+#include "sequencer.h"
+#include "song.h"
+#include "st7789.h"
+#include "trace.h"
+#include "wav_loader.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define IMAGE_MB 100
+#define KIT_SLOT 1
+#define KIT_SHARED 2 /* Half of KIT_SLOT's samples, half WAV cases */
+#define KIT_SINGLE 3 /* One large file on every channel */
+#define KIT_MIX 4    /* KIT_SLOT with another mix */
+#define KIT_ONE 5    /* KIT_SLOT with one sample changed */
+#define PATTERN_SLOT 1
+#define PATTERN_SLOTS 16
+#define FILLER_FILES 100
+#define RUNS 5 /* Timed results are the best of this many */
+
+#define MAX_RESULTS 256
+#define MAX_NAME 40
+
+static const char *const sample_names[NUM_CHANNELS] = {
+    "KICK", "SNARE", "HATC", "HATO", "CLAP", "TOM"};
+
+/* WAV loader inputs: samples, channels, rate, bits */
+typedef struct {
+  const char *name;
+  uint32_t samples;
+  uint16_t channels;
+  uint32_t rate;
+  uint16_t bits;
+} WavCase;
+
+static const WavCase wav_cases[] = {
+    {"SHORT", 100, 1, 44100, 16},   /* Within the header sector */
+    {"SECTOR", 234, 1, 44100, 16},  /* Exactly fills it */
+    {"FULL", 8192, 1, 44100, 16},   /* MAX_SAMPLE_SIZE */
+    {"LONG", 20000, 1, 44100, 16},  /* Truncated to MAX_SAMPLE_SIZE */
+    {"STEREO", 4000, 2, 44100, 16}, /* Rejected */
+    {"RATE48K", 4000, 1, 48000, 16},
+    {"PCM8", 4000, 1, 44100, 8},
+};
+#define WAV_CASES (sizeof(wav_cases) / sizeof(wav_cases[0]))
+
+typedef enum { KIND_TIME, KIND_COUNT, KIND_CHECKSUM } ResultKind;
+
+static const char *const kind_names[] = {"time", "count", "checksum"};
+
+typedef struct {
+  char name[MAX_NAME];
+  ResultKind kind;
+  double value;
+  const char *unit;
+} Result;
+
+static Result results[MAX_RESULTS];
+static int result_count = 0;
+
+static uint32_t fx_ram[16384 / 4]; /* Roughly what the target leaves over */
+static int16_t synth[20000];
+static int16_t output[512 * 2];
+static Drumset drumset;
+static FAT32_FileEntry files[FAT32_MAX_FILES];
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void record(const char *name, ResultKind kind, double value,
+                   const char *unit) {
+  if (result_count == MAX_RESULTS)
+    return;
+  Result *r = &results[result_count++];
+  snprintf(r->name, sizeof(r->name), "%s", name);
+  r->kind = kind;
+  r->value = value;
+  r->unit = unit;
+}
+
+/* FNV-1a */
+#define HASH_INIT 2166136261u
+
+static uint32_t hash_bytes(uint32_t hash, const void *data, size_t len) {
+  const uint8_t *p = data;
+  while (len--)
+    hash = (hash ^ *p++) * 16777619u;
+  return hash;
+}
+
+/* Deterministic noise */
+static uint32_t rng_state = 1;
+
+static int32_t noise(void) {
+  rng_state = rng_state * 1664525u + 1013904223u;
+  return (int32_t)(rng_state >> 16) - 32768;
+}
+
+/**
+ * @brief Synthesize one drum sound
+ * @return Length in samples
+ */
+static uint32_t synthesize(int ch, int16_t *out) {
+  static const uint32_t lengths[NUM_CHANNELS] = {6000, 5000, 1500,
+                                                 7000, 5000, 6000};
+  uint32_t len = lengths[ch];
+  double phase = 0;
+
+  for (uint32_t i = 0; i < len; i++) {
+    double t = (double)i / AUDIO_SAMPLE_RATE;
+    double env = exp(-t * (ch == 3 ? 8 : 30));
+    double v;
+    switch (ch) {
+    case 0: /* Pitch-swept sine */
+      phase += 2 * M_PI * (50 + 100 * exp(-t * 40)) / AUDIO_SAMPLE_RATE;
+      v = sin(phase);
+      break;
+    case 1:
+      v = 0.5 * sin(2 * M_PI * 180 * t) + noise() / 65536.0;
+      break;
+    case 4: /* Three quick bursts, then the tail */
+      v = noise() / 32768.0 * ((i % 600 < 300 || i > 1800) ? 1 : 0.2);
+      break;
+    case 5:
+      v = sin(2 * M_PI * 120 * t);
+      break;
+    default: /* Hats: differentiated noise */
+      v = (noise() - noise()) / 65536.0;
+      break;
+    }
+    out[i] = (int16_t)(v * env * 30000);
+  }
+  return len;
+}
+
+static void put_u16(uint8_t *buf, uint32_t offset, uint16_t value) {
+  buf[offset] = value & 0xFF;
+  buf[offset + 1] = (value >> 8) & 0xFF;
+}
+
+static void put_u32(uint8_t *buf, uint32_t offset, uint32_t value) {
+  put_u16(buf, offset, value & 0xFFFF);
+  put_u16(buf, offset + 2, value >> 16);
+}
+
+/**
+ * @brief Store a WAV in SAMPLES/, as a PC would
+ * @details len counts 16-bit words of data, whatever the format says.
+ * @return 0 on success, negative on error
+ */
+static int write_wav(uint32_t dir, const char *name, const int16_t *pcm,
+                     uint32_t len, uint16_t channels, uint32_t rate,
+                     uint16_t bits) {
+  static uint8_t file[44 + sizeof(synth) + 512];
+  uint32_t size = 44 + len * 2;
+  uint16_t align = (uint16_t)(channels * bits / 8);
+  uint32_t sector;
+
+  memset(file, 0, sizeof(file));
+  memcpy(file, "RIFF\0\0\0\0WAVEfmt ", 16);
+  put_u32(file, 4, size - 8);
+  put_u32(file, 16, 16);
+  put_u16(file, 20, 1);
+  put_u16(file, 22, channels);
+  put_u32(file, 24, rate);
+  put_u32(file, 28, rate * align);
+  put_u16(file, 32, align);
+  put_u16(file, 34, bits);
+  memcpy(file + 36, "data", 4);
+  put_u32(file, 40, len * 2);
+  for (uint32_t i = 0; i < len; i++)
+    put_u16(file, 44 + i * 2, (uint16_t)pcm[i]);
+
+  if (FAT32_CreateContiguous(dir, name, size, &sector) != 0)
+    return -1;
+  for (uint32_t b = 0; b * 512 < size; b++) {
+    if (SDCARD_WriteBlock(sector + b, file + b * 512) != SDCARD_OK)
+      return -2;
+  }
+  return 0;
+}
+
+/**
+ * @brief Fill a pattern: four on the floor, hats with ratchets, a fill tom
+ */
+static void make_pattern(Pattern *p, uint8_t variant) {
+  memset(p, 0, sizeof(*p));
+  p->step_count = 16;
+  p->bpm = 128;
+  snprintf(p->name, sizeof(p->name), "BENCH %02u", variant);
+
+  for (int s = 0; s < 16; s++) {
+    if (s % 4 == 0)
+      p->steps[0][s] = 255;
+    if (s % 8 == 4)
+      p->steps[1][s] = 220;
+    p->steps[2][s] = (s % 2) ? 90 : 160;
+    if (s % 4 == 2)
+      p->steps[3][s] = 140;
+    if ((s + variant) % 16 == 12)
+      p->steps[4][s] = 200;
+    if (s >= 13)
+      p->steps[5][s] = (uint8_t)(120 + s * 8);
+  }
+  p->ratchets[2][7] = 0x03 | (0x0B << 4); /* Steps 14, 15: rolls */
+  p->conditions[4][(12 + 16 - variant % 16) % 16] = SEQ_COND_LOOP(2, 2);
+  p->track_length[3] = 12; /* Open hat drifts against the bar */
+}
+
+/**
+ * @brief Fill a worst-case pattern: every step of every track, ratchets,
+ *        conditions and six unaligned track lengths
+ */
+static void make_dense(Pattern *p) {
+  static const uint8_t lengths[NUM_CHANNELS] = {32, 24, 20, 16, 12, 7};
+  static const uint8_t pulses[NUM_CHANNELS] = {6, 6, 3, 4, 6, 8};
+
+  memset(p, 0, sizeof(*p));
+  p->step_count = MAX_STEPS;
+  p->bpm = 174;
+  snprintf(p->name, sizeof(p->name), "DENSE");
+
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    p->track_length[ch] = lengths[ch];
+    p->track_pulses[ch] = pulses[ch];
+    for (int s = 0; s < MAX_STEPS; s++) {
+      p->steps[ch][s] = (uint8_t)(100 + (s * 7 + ch * 13) % 156);
+      if ((s + ch) % 3 == 0) {
+        uint8_t nibble = (uint8_t)(1 + (s + ch) % 4);
+        if (ch & 1)
+          nibble |= SEQ_RATCHET_RAMP;
+        p->ratchets[ch][s / 2] |= (uint8_t)(nibble << ((s & 1) * 4));
+      }
+    }
+    for (int s = 1; s < MAX_STEPS; s += 2)
+      p->conditions[1][s] = SEQ_COND_PROB(50);
+    for (int s = 0; s < MAX_STEPS; s += 4) {
+      p->conditions[4][s] = SEQ_COND_LOOP(1 + s / 4 % 2, 2);
+      p->conditions[5][s] = SEQ_COND_PROB(30);
+      p->conditions[5][s + 1] = SEQ_COND_NOT_PRE;
+    }
+  }
+}
+
+/**
+ * @brief Set up the image: samples, WAV cases, kit, pattern and fillers
+ * @return 0 on success, negative on error
+ */
+static int populate(void) {
+  uint32_t samples = FAT32_FindDir(FAT32_GetRootCluster(), "SAMPLES");
+  uint32_t songs = FAT32_FindDir(FAT32_GetRootCluster(), "SONGS");
+  if (samples == 0 || songs == 0)
+    return -1;
+
+  memset(&drumset, 0, sizeof(drumset));
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    char name[FAT32_FILENAME_LEN];
+    snprintf(name, sizeof(name), "%s.WAV", sample_names[ch]);
+    if (write_wav(samples, name, synth, synthesize(ch, synth), 1,
+                  AUDIO_SAMPLE_RATE, 16) != 0)
+      return -2;
+
+    strcpy(drumset.sample_names[ch], sample_names[ch]);
+    drumset.volumes[ch] = (ch == 2) ? 170 : 230;
+    drumset.pans[ch] = (uint8_t)(64 + ch * 25);
+    drumset.cutoffs[ch] = 255;
+  }
+  drumset.decays[3] = 40;
+  drumset.filter_modes[5] = AUDIO_FILTER_LP;
+  drumset.cutoffs[5] = 150;
+  drumset.resonances[5] = 120;
+  if (Drumset_Save(&drumset, KIT_SLOT) != 0)
+    return -3;
+
+  for (size_t i = 0; i < WAV_CASES; i++) {
+    const WavCase *c = &wav_cases[i];
+    char name[FAT32_FILENAME_LEN];
+    for (uint32_t n = 0; n < c->samples; n++)
+      synth[n] = (int16_t)noise();
+    snprintf(name, sizeof(name), "%s.WAV", c->name);
+    if (write_wav(samples, name, synth, c->samples, c->channels, c->rate,
+                  c->bits) != 0)
+      return -4;
+  }
+
+  /* SONGS is otherwise unused here: fill most of its first cluster */
+  for (int i = 0; i < FILLER_FILES; i++) {
+    char name[FAT32_FILENAME_LEN];
+    snprintf(name, sizeof(name), "FILL%03d.BIN", i);
+    if (FAT32_WriteFile(songs, name, (const uint8_t *)name, 12) != 0)
+      return -5;
+  }
+
+  Pattern pattern;
+  make_pattern(&pattern, 0);
+  return Pattern_Save(&pattern, PATTERN_SLOT) == 0 ? 0 : -6;
+}
+
+/**
+ * @brief Mixer and effects as at boot, with the kit loaded (warm)
+ * @return 0 on success, negative on error
+ */
+static int reset_engine(void) {
+  AudioMixer_Init();
+  AudioFx_Init(fx_ram, sizeof(fx_ram));
+
+  /* A channel already holding its file is not sent to the mixer again */
+  for (int ch = 0; ch < NUM_CHANNELS; ch++)
+    WAV_UnloadChannel(ch, &drumset);
+  return Drumset_LoadFromSlot(&drumset, KIT_SLOT);
+}
+
+/**
+ * @brief Render, retriggering the first voices every 1024 frames
+ * @param voices Voices kept playing (0-6)
+ * @param sweep Called before every block with the frames done (may be
+ *              NULL), as the main loop would change parameters
+ * @param hash Output checksum, updated
+ * @return Render time in seconds
+ */
+static double render_voices(int voices, uint32_t frames, uint32_t period,
+                            void (*sweep)(uint32_t done), uint32_t *hash) {
+  double t = now_s();
+  for (uint32_t done = 0; done < frames; done += period) {
+    if (done % 1024 < period) {
+      for (int ch = 0; ch < voices; ch++)
+        AudioMixer_Trigger((uint8_t)ch, 255);
+    }
+    if (sweep)
+      sweep(done);
+    AudioMixer_Process(output, period);
+    if (hash)
+      *hash = hash_bytes(*hash, output, period * 4);
+  }
+  return now_s() - t;
+}
+
+static int bench_mixer(uint32_t period, double seconds) {
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / period * period;
+  char name[MAX_NAME];
+
+  for (int voices = 0; voices <= NUM_CHANNELS + 1; voices++) {
+    uint8_t full = (voices > NUM_CHANNELS);
+    double best = 1e9;
+    uint32_t hash = HASH_INIT;
+
+    for (int run = 0; run < RUNS; run++) {
+      if (reset_engine() != 0)
+        return -1;
+      if (full) {
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+          AudioMixer_SetFilter(ch, 1 + ch % 3, 128, 160);
+          AudioMixer_SetSend(ch, AUDIO_FX_DELAY, 120);
+          AudioMixer_SetSend(ch, AUDIO_FX_REVERB, 120);
+        }
+        AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 110, 150);
+        AudioFx_SetReverb(170, 100, 140);
+      }
+      uint32_t h = HASH_INIT;
+      double t = render_voices(full ? NUM_CHANNELS : voices, frames, period,
+                               NULL, run == 0 ? &h : NULL);
+      if (run == 0)
+        hash = h;
+      if (t < best)
+        best = t;
+    }
+
+    if (full)
+      snprintf(name, sizeof(name), "mixer.full");
+    else
+      snprintf(name, sizeof(name), "mixer.voices%d", voices);
+    size_t len = strlen(name);
+    snprintf(name + len, sizeof(name) - len, ".ns");
+    record(name, KIND_TIME, best / frames * 1e9, "ns/frame");
+    snprintf(name + len, sizeof(name) - len, ".sum");
+    record(name, KIND_CHECKSUM, hash, "");
+  }
+  return 0;
+}
+
+/**
+ * @brief Render the pattern playing; the checksum covers every frame
+ * @return Render time in seconds, negative on error
+ */
+static double play(const Pattern *pattern, uint32_t frames, uint32_t period,
+                   uint32_t *hash, uint8_t write_wav_out) {
+  Host_Reset();
+  Sequencer_LoadPattern(pattern);
+  Sequencer_SetBPM(pattern->bpm);
+  Sequencer_Start();
+
+  double t = now_s();
+  for (uint32_t done = 0; done < frames; done += period) {
+    Host_Render(output, period, period);
+    *hash = hash_bytes(*hash, output, period * 4);
+    if (write_wav_out && Host_WavWrite(output, period) != 0)
+      return -1;
+  }
+  t = now_s() - t;
+  Sequencer_Stop();
+  return t;
+}
+
+static int bench_sequencer(uint32_t period) {
+  const uint32_t pulses = 24 * 4 * 2000; /* 2000 bars */
+  uint32_t frames = 4 * AUDIO_SAMPLE_RATE / period * period;
+  Pattern dense;
+  double best = 1e9;
+  uint32_t loops = 0;
+
+  make_dense(&dense);
+  if (reset_engine() != 0)
+    return -1;
+
+  /* The pulse interrupt alone: triggers reach the mixer, nothing renders */
+  for (int run = 0; run < RUNS; run++) {
+    Host_Reset();
+    Sequencer_LoadPattern(&dense);
+    Sequencer_Start();
+    loops = Sequencer_GetLoopCount();
+    double t = now_s();
+    for (uint32_t i = 0; i < pulses; i++)
+      Host_ClockPulse();
+    t = now_s() - t;
+    loops = Sequencer_GetLoopCount() - loops;
+    Sequencer_Stop();
+    if (t < best)
+      best = t;
+  }
+  record("seq.pulse.ns", KIND_TIME, best / pulses * 1e9, "ns/pulse");
+  record("seq.loops", KIND_CHECKSUM, loops, "loops");
+
+  uint32_t hash = HASH_INIT;
+  if (reset_engine() != 0)
+    return -1;
+  double t = play(&dense, frames, period, &hash, 0);
+  if (t < 0)
+    return -1;
+  record("seq.dense.ns", KIND_TIME, t / frames * 1e9, "ns/frame");
+  record("seq.dense.sum", KIND_CHECKSUM, hash, "");
+  return 0;
+}
+
+/**
+ * @brief Look up a file of SAMPLES/ the way the sample browser does
+ * @return Entry, NULL if missing
+ */
+static FAT32_FileEntry *find_sample(const char *name) {
+  uint32_t dir = FAT32_FindDir(FAT32_GetRootCluster(), "SAMPLES");
+  int count = FAT32_ListDir(dir, files, FAT32_MAX_FILES);
+  for (int i = 0; i < count; i++) {
+    if (strcmp(files[i].name, name) == 0)
+      return &files[i];
+  }
+  return NULL;
+}
+
+static int bench_wav(void) {
+  const int loads = 100;
+  char name[MAX_NAME];
+
+  for (size_t i = 0; i < WAV_CASES; i++) {
+    char file[FAT32_FILENAME_LEN];
+    snprintf(file, sizeof(file), "%s.WAV", wav_cases[i].name);
+    FAT32_FileEntry *entry = find_sample(file);
+    if (!entry)
+      return -1;
+    FAT32_FileEntry copy = *entry;
+
+    HostDiskStats disk;
+    double best = 1e9;
+    int loaded = 0;
+    for (int run = 0; run < RUNS; run++) {
+      double total = 0;
+      Host_DiskResetStats();
+      for (int n = 0; n < loads; n++) {
+        WAV_UnloadChannel(0, &drumset);
+        SampleCache_Init();
+        double t = now_s();
+        loaded = WAV_LoadSample(&copy, 0, &drumset);
+        total += now_s() - t;
+      }
+      Host_DiskGetStats(&disk);
+      if (total < best)
+        best = total;
+    }
+
+    /* The result code, then whatever PCM made it into the channel */
+    uint32_t hash = hash_bytes(HASH_INIT, &loaded, sizeof(loaded));
+    if (loaded > 0)
+      hash = hash_bytes(hash, drumset.samples[0],
+                        drumset.lengths[0] * sizeof(int16_t));
+
+    snprintf(name, sizeof(name), "wav.%s.us", wav_cases[i].name);
+    for (char *c = name; *c; c++)
+      *c = (char)((*c >= 'A' && *c <= 'Z') ? *c + 32 : *c);
+    size_t len = strlen(name) - 3;
+    record(name, KIND_TIME, best / loads * 1e6, "us");
+    snprintf(name + len, sizeof(name) - len, ".blocks");
+    record(name, KIND_COUNT, (double)disk.blocks_read / loads, "blocks");
+    snprintf(name + len, sizeof(name) - len, ".sum");
+    record(name, KIND_CHECKSUM, hash, "");
+  }
+
+  WAV_UnloadChannel(0, &drumset);
+  SampleCache_Init();
+  return 0;
+}
+
+/* FAT operations under test, on the filler directory */
+enum { FAT_FIND_DIR, FAT_EXISTS_LAST, FAT_EXISTS_MISSING, FAT_LIST, FAT_OPS };
+
+static const char *const fat_names[FAT_OPS] = {"fat.finddir", "fat.last",
+                                               "fat.missing", "fat.list"};
+
+static int fat_op(int op, uint32_t dir) {
+  switch (op) {
+  case FAT_FIND_DIR:
+    return FAT32_FindDir(FAT32_GetRootCluster(), "SONGS") == dir;
+  case FAT_EXISTS_LAST:
+    return FAT32_FileExists(dir, "FILL099.BIN");
+  case FAT_EXISTS_MISSING:
+    return !FAT32_FileExists(dir, "MISSING.BIN");
+  default:
+    return FAT32_ListDir(dir, files, FAT32_MAX_FILES);
+  }
+}
+
+static int bench_fat(void) {
+  const int calls = 200;
+  uint32_t dir = FAT32_FindDir(FAT32_GetRootCluster(), "SONGS");
+  char name[MAX_NAME];
+
+  for (int op = 0; op < FAT_OPS; op++) {
+    HostDiskStats disk;
+    double best = 1e9;
+    int result = 0;
+    for (int run = 0; run < RUNS; run++) {
+      Host_DiskResetStats();
+      double t = now_s();
+      for (int n = 0; n < calls; n++)
+        result = fat_op(op, dir);
+      t = now_s() - t;
+      Host_DiskGetStats(&disk);
+      if (t < best)
+        best = t;
+    }
+    if (result <= 0)
+      return -1;
+
+    snprintf(name, sizeof(name), "%s.us", fat_names[op]);
+    record(name, KIND_TIME, best / calls * 1e6, "us");
+    snprintf(name, sizeof(name), "%s.blocks", fat_names[op]);
+    record(name, KIND_COUNT, (double)disk.blocks_read / calls, "blocks");
+    if (op == FAT_LIST)
+      record("fat.list.files", KIND_CHECKSUM, result, "files");
+  }
+  return 0;
+}
+
+static int bench_kit(void) {
+  const int loads = 50;
+  HostDiskStats disk;
+  double best = 1e9;
+
+  for (int run = 0; run < RUNS; run++) {
+    double total = 0;
+    Host_DiskResetStats();
+    for (int i = 0; i < loads; i++) {
+      for (int ch = 0; ch < NUM_CHANNELS; ch++)
+        WAV_UnloadChannel(ch, &drumset);
+      SampleCache_Init();
+      double t = now_s();
+      if (Drumset_LoadFromSlot(&drumset, KIT_SLOT) != 0)
+        return -1;
+      total += now_s() - t;
+    }
+    Host_DiskGetStats(&disk);
+    if (total < best)
+      best = total;
+  }
+  record("kit.cold.us", KIND_TIME, best / loads * 1e6, "us");
+  record("kit.cold.blocks", KIND_COUNT, (double)disk.blocks_read / loads,
+         "blocks");
+
+  best = 1e9;
+  for (int run = 0; run < RUNS; run++) {
+    Host_DiskResetStats();
+    double t = now_s();
+    for (int i = 0; i < loads; i++) {
+      if (Drumset_LoadFromSlot(&drumset, KIT_SLOT) != 0)
+        return -1;
+    }
+    t = now_s() - t;
+    Host_DiskGetStats(&disk);
+    if (t < best)
+      best = t;
+  }
+  record("kit.warm.us", KIND_TIME, best / loads * 1e6, "us");
+  record("kit.warm.blocks", KIND_COUNT, (double)disk.blocks_read / loads,
+         "blocks");
+  return 0;
+}
+
+static int bench_pattern(void) {
+  HostDiskStats disk;
+  Pattern pattern;
+  double best_save = 1e9, best_load = 1e9;
+  uint32_t written = 0;
+
+  for (int run = 0; run < RUNS; run++) {
+    Host_DiskResetStats();
+    double t = now_s();
+    for (uint8_t slot = 1; slot <= PATTERN_SLOTS; slot++) {
+      make_pattern(&pattern, slot - 1);
+      if (Pattern_Save(&pattern, slot) != 0)
+        return -1;
+    }
+    t = now_s() - t;
+    Host_DiskGetStats(&disk);
+    written = disk.blocks_written;
+    if (t < best_save)
+      best_save = t;
+
+    t = now_s();
+    for (uint8_t slot = 1; slot <= PATTERN_SLOTS; slot++) {
+      if (Pattern_Load(&pattern, slot) != 0 || pattern.step_count != 16)
+        return -1;
+    }
+    t = now_s() - t;
+    if (t < best_load)
+      best_load = t;
+  }
+
+  record("pattern.save.us", KIND_TIME, best_save / PATTERN_SLOTS * 1e6, "us");
+  record("pattern.save.blocks", KIND_COUNT, (double)written / PATTERN_SLOTS,
+         "blocks");
+  record("pattern.load.us", KIND_TIME, best_load / PATTERN_SLOTS * 1e6, "us");
+  return 0;
+}
+
+/* Drawing operations under test */
+enum { DRAW_FILL, DRAW_RECT, DRAW_TEXT1, DRAW_TEXT2, DRAW_OPS };
+
+static const char *const draw_names[DRAW_OPS] = {
+    "display.fill", "display.rect", "display.text1", "display.text2"};
+
+static void draw_op(int op) {
+  switch (op) {
+  case DRAW_FILL:
+    ST7789_Fill(BLUE);
+    break;
+  case DRAW_RECT:
+    ST7789_FillRect(20, 40, 120, 60, RED);
+    break;
+  default:
+    ST7789_WriteString(8, 8, "KIT 001 128BPM", WHITE, BLACK,
+                       (uint8_t)(op - DRAW_TEXT1 + 1));
+    break;
+  }
+}
+
+static void bench_display(void) {
+  char name[MAX_NAME];
+
+  ST7789_Init();
+  for (int op = 0; op < DRAW_OPS; op++) {
+    const int calls = (op == DRAW_FILL) ? 20 : 500;
+    HostSpiStats spi;
+    double best = 1e9;
+
+    Host_SpiResetStats();
+    draw_op(op);
+    Host_SpiGetStats(&spi);
+
+    for (int run = 0; run < RUNS; run++) {
+      double t = now_s();
+      for (int n = 0; n < calls; n++)
+        draw_op(op);
+      t = now_s() - t;
+      if (t < best)
+        best = t;
+    }
+
+    snprintf(name, sizeof(name), "%s.us", draw_names[op]);
+    record(name, KIND_TIME, best / calls * 1e6, "us");
+    snprintf(name, sizeof(name), "%s.bytes", draw_names[op]);
+    record(name, KIND_COUNT, spi.bytes, "bytes");
+    snprintf(name, sizeof(name), "%s.sum", draw_names[op]);
+    record(name, KIND_CHECKSUM, spi.checksum, "");
+  }
+}
+
+/* Scripted profile: enter a source (or exit, -1), then run for a while */
+typedef struct {
+  int8_t source;
+  uint32_t cycles;
+} ProfStep;
+
+static const ProfStep prof_script[] = {
+    {PROF_UI, 4000},    {PROF_CLOCK, 300},  {-1, 1000},
+    {PROF_AUDIO, 9000}, {-1, 0},            {-1, 2000}, /* UI: 7000 */
+    {PROF_SD, 500},     {PROF_AUDIO, 8000}, {-1, 700},  {-1, 0},
+    {PROF_IDLE, 50000}, {PROF_CLOCK, 250},  {-1, 0},    {-1, 100},
+    /* Ten deep: the two past PROF_DEPTH lose attribution, not balance */
+    {PROF_EVENTS, 10},  {PROF_EVENTS, 10},  {PROF_EVENTS, 10},
+    {PROF_EVENTS, 10},  {PROF_EVENTS, 10},  {PROF_EVENTS, 10},
+    {PROF_EVENTS, 10},  {PROF_EVENTS, 10},  {PROF_PADS, 10},
+    {PROF_PADS, 10},    {-1, 0},            {-1, 0},    {-1, 0},
+    {-1, 0},            {-1, 0},            {-1, 0},    {-1, 0},
+    {-1, 0},            {-1, 0},            {-1, 3000},
+};
+#define PROF_STEPS (sizeof(prof_script) / sizeof(prof_script[0]))
+
+static int bench_profiler(uint32_t period) {
+  uint32_t frames = 4 * AUDIO_SAMPLE_RATE / period * period;
+  ProfilerStats stats;
+  Pattern pattern;
+
+  Host_Reset();
+  Profiler_Init(Host_CycleCounter());
+  for (size_t i = 0; i < PROF_STEPS; i++) {
+    if (prof_script[i].source >= 0)
+      Profiler_Enter((uint8_t)prof_script[i].source);
+    else
+      Profiler_Exit();
+    Host_AdvanceCycles(prof_script[i].cycles);
+  }
+  Profiler_Snapshot(&stats);
+  record("prof.script.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, &stats, sizeof(stats)), "");
+  record("prof.script.busy", KIND_CHECKSUM, stats.busy, "permille");
+
+  /* Host_Render and Host_ClockPulse enter the sources their interrupts do */
+  if (reset_engine() != 0 || Pattern_Load(&pattern, PATTERN_SLOT) != 0)
+    return -1;
+  Host_Reset();
+  Profiler_Init(Host_CycleCounter());
+  Sequencer_LoadPattern(&pattern);
+  Sequencer_SetBPM(pattern.bpm);
+  Sequencer_Start();
+  for (uint32_t done = 0; done < frames; done += period)
+    Host_Render(output, period, period);
+  Sequencer_Stop();
+  Profiler_Snapshot(&stats);
+  Profiler_Init(NULL); /* Out of the timed benchmarks */
+
+  record("prof.song.elapsed", KIND_CHECKSUM, stats.elapsed, "cycles");
+  record("prof.song.audio", KIND_CHECKSUM, stats.calls[PROF_AUDIO], "calls");
+  record("prof.song.clock", KIND_CHECKSUM, stats.calls[PROF_CLOCK], "calls");
+  return 0;
+}
+
+static FILE *trace_file;
+
+static int trace_write(const uint8_t *data, uint32_t len) {
+  return fwrite(data, 1, len, trace_file) == len ? 0 : -1;
+}
+
+/**
+ * @brief Hash a file
+ * @return 0 on success, -1 if unreadable
+ */
+static int hash_file(const char *path, uint32_t *hash) {
+  FILE *f = fopen(path, "rb");
+  uint8_t buf[512];
+  size_t n;
+  if (!f)
+    return -1;
+  *hash = HASH_INIT;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    *hash = hash_bytes(*hash, buf, n);
+  fclose(f);
+  return 0;
+}
+
+/**
+ * @brief Count the events tracedump wrote (one per line, metadata aside)
+ * @return Number of events, -1 if unreadable
+ */
+static int count_events(const char *path) {
+  FILE *f = fopen(path, "r");
+  char line[256];
+  int events = 0;
+  if (!f)
+    return -1;
+  while (fgets(line, sizeof(line), f)) {
+    if (strstr(line, "\"ph\":\"") && !strstr(line, "\"ph\":\"M\""))
+      events++;
+  }
+  fclose(f);
+  return events;
+}
+
+/**
+ * @brief Trace the pattern playing, dump the ring and decode the dump
+ * @param tool tools/tracedump
+ * @return 0 on success, negative on error
+ */
+static int bench_trace(const char *tool, uint32_t period) {
+  uint32_t frames = AUDIO_SAMPLE_RATE / period * period; /* Wraps the ring */
+  char dump[64] = "/tmp/drumbench-XXXXXX", json[80] = "", command[512];
+  uint32_t hash;
+  Pattern pattern;
+  int result = -1;
+
+  if (reset_engine() != 0 || Pattern_Load(&pattern, PATTERN_SLOT) != 0)
+    return -1;
+  int fd = mkstemp(dump);
+  if (fd < 0 || !(trace_file = fdopen(fd, "wb")))
+    return -1;
+
+  Host_Reset();
+  Trace_Init(Host_CycleCounter(), HOST_CPU_MHZ);
+  Sequencer_LoadPattern(&pattern);
+  Sequencer_SetBPM(pattern.bpm);
+  Sequencer_Start();
+  for (uint32_t done = 0; done < frames; done += period)
+    Host_Render(output, period, period);
+  Sequencer_Stop();
+  int written = Trace_Dump(trace_write);
+  Trace_Init(NULL, 1); /* Out of the timed benchmarks */
+  if (fclose(trace_file) != 0 || written != 0)
+    goto out;
+
+  if (hash_file(dump, &hash) != 0)
+    goto out;
+  record("trace.dump.sum", KIND_CHECKSUM, hash, "");
+
+  snprintf(json, sizeof(json), "%s.json", dump);
+  snprintf(command, sizeof(command), "%s %s %s 2>/dev/null", tool, dump,
+           json);
+  int events;
+  if (system(command) != 0 || hash_file(json, &hash) != 0 ||
+      (events = count_events(json)) < 0)
+    goto out;
+  record("trace.json.sum", KIND_CHECKSUM, hash, "");
+  record("trace.events", KIND_CHECKSUM, events, "events");
+  result = 0;
+
+out:
+  remove(dump);
+  remove(json);
+  return result;
+}
+
+/* Sample cache script: kit slot loaded at each step */
+static const struct {
+  const char *name;
+  uint8_t slot;
+} cache_script[] = {
+    {"cache.cold", KIT_SLOT},     {"cache.shared", KIT_SHARED},
+    {"cache.back", KIT_SLOT},     {"cache.single", KIT_SINGLE},
+    {"cache.again", KIT_SHARED},
+};
+#define CACHE_STEPS (sizeof(cache_script) / sizeof(cache_script[0]))
+
+/**
+ * @brief Add the kits the cache script loads, and the file they need
+ * @return 0 on success, negative on error
+ */
+static int populate_cache(void) {
+  static const char *const shared[NUM_CHANNELS] = {
+      "KICK", "SNARE", "HATC", "FULL", "LONG", "SECTOR"};
+  uint32_t samples = FAT32_FindDir(FAT32_GetRootCluster(), "SAMPLES");
+  Drumset kit = drumset;
+
+  /* With both kits resident, this one no longer fits in the arena */
+  for (uint32_t n = 0; n < 8192; n++) /* The loader's limit, as FULL */
+    synth[n] = (int16_t)noise();
+  if (write_wav(samples, "BIG.WAV", synth, 8192, 1, AUDIO_SAMPLE_RATE,
+                16) != 0)
+    return -1;
+
+  memset(kit.sample_paths, 0, sizeof(kit.sample_paths)); /* Save by name */
+  for (int ch = 0; ch < NUM_CHANNELS; ch++)
+    strcpy(kit.sample_names[ch], shared[ch]);
+  if (Drumset_Save(&kit, KIT_SHARED) != 0)
+    return -2;
+  for (int ch = 0; ch < NUM_CHANNELS; ch++)
+    strcpy(kit.sample_names[ch], "BIG");
+  return Drumset_Save(&kit, KIT_SINGLE) == 0 ? 0 : -3;
+}
+
+static int bench_cache(void) {
+  SampleCacheStats stats, last = {0};
+  HostDiskStats disk;
+  uint32_t hash = HASH_INIT;
+  char name[MAX_NAME];
+
+  if (populate_cache() != 0)
+    return -1;
+  for (int ch = 0; ch < NUM_CHANNELS; ch++)
+    WAV_UnloadChannel(ch, &drumset);
+  SampleCache_Init();
+
+  for (size_t i = 0; i < CACHE_STEPS; i++) {
+    Host_DiskResetStats();
+    if (Drumset_LoadFromSlot(&drumset, cache_script[i].slot) != 0)
+      return -1;
+    Host_DiskGetStats(&disk);
+    SampleCache_GetStats(&stats);
+
+    snprintf(name, sizeof(name), "%s.blocks", cache_script[i].name);
+    record(name, KIND_COUNT, disk.blocks_read, "blocks");
+    snprintf(name, sizeof(name), "%s.misses", cache_script[i].name);
+    record(name, KIND_COUNT, stats.misses - last.misses, "loads");
+    /* Field by field: the struct has padding */
+    uint32_t fields[6] = {stats.hits,      stats.misses,
+                          stats.evictions, stats.resident,
+                          stats.referenced, stats.used_samples};
+    hash = hash_bytes(hash, fields, sizeof(fields));
+    last = stats;
+  }
+  record("cache.evictions", KIND_CHECKSUM, stats.evictions, "entries");
+  record("cache.stats.sum", KIND_CHECKSUM, hash, "");
+  return 0;
+}
+
+/* Kit changes over KIT_SLOT: slot loaded at each step */
+static const struct {
+  const char *name;
+  uint8_t slot;
+} reload_script[] = {
+    {"reload.mix", KIT_MIX},
+    {"reload.one", KIT_ONE},
+};
+#define RELOAD_STEPS (sizeof(reload_script) / sizeof(reload_script[0]))
+
+static int bench_reload(void) {
+  SampleCacheStats before, after;
+  HostDiskStats disk;
+  Drumset kit;
+  char name[MAX_NAME];
+
+  /* Same files as KIT_SLOT */
+  if (Drumset_LoadFromSlot(&drumset, KIT_SLOT) != 0)
+    return -1;
+  kit = drumset;
+  memset(kit.sample_paths, 0, sizeof(kit.sample_paths));
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    kit.volumes[ch] = (uint8_t)(150 + ch * 20);
+    kit.pans[ch] = (uint8_t)(200 - ch * 30);
+  }
+  kit.filter_modes[0] = AUDIO_FILTER_HP;
+  kit.cutoffs[0] = 90;
+  if (Drumset_Save(&kit, KIT_MIX) != 0)
+    return -1;
+  strcpy(kit.sample_names[5], "SHORT");
+  if (Drumset_Save(&kit, KIT_ONE) != 0)
+    return -1;
+
+  for (size_t i = 0; i < RELOAD_STEPS; i++) {
+    SampleCache_GetStats(&before);
+    Host_DiskResetStats();
+    if (Drumset_LoadFromSlot(&drumset, reload_script[i].slot) != 0)
+      return -1;
+    Host_DiskGetStats(&disk);
+    SampleCache_GetStats(&after);
+
+    /* The new mix has to reach the voices too */
+    uint32_t hash = HASH_INIT;
+    AudioFx_Init(fx_ram, sizeof(fx_ram));
+    render_voices(NUM_CHANNELS, 8192, 128, NULL, &hash);
+
+    snprintf(name, sizeof(name), "%s.blocks", reload_script[i].name);
+    record(name, KIND_COUNT, disk.blocks_read, "blocks");
+    snprintf(name, sizeof(name), "%s.lookups", reload_script[i].name);
+    record(name, KIND_COUNT,
+           (after.hits + after.misses) - (before.hits + before.misses),
+           "samples");
+    snprintf(name, sizeof(name), "%s.sum", reload_script[i].name);
+    record(name, KIND_CHECKSUM, hash, "");
+  }
+  return 0;
+}
+
+/**
+ * @brief Play one pass of a 64-entry chain at 300 BPM
+ * @details Entries cycle the saved patterns, one or two loops each, and
+ *          every fourth one changes kit, so kits are staged and swapped
+ *          at the boundary too. The main loop runs between buffers.
+ */
+static int bench_chain(uint32_t period) {
+  static const uint8_t kits[4] = {KIT_MIX, KIT_ONE, KIT_SHARED, KIT_SLOT};
+  const uint32_t limit = 120 * AUDIO_SAMPLE_RATE; /* One pass is ~70s */
+  SongEntry chain[SONG_MAX_ENTRIES];
+  uint32_t hash = HASH_INIT, order = HASH_INIT, changes = 0, kit_swaps = 0;
+  HostDiskStats disk;
+  SongStats stats;
+
+  for (int i = 0; i < SONG_MAX_ENTRIES; i++) {
+    chain[i].pattern_slot = (uint8_t)(1 + i % PATTERN_SLOTS);
+    chain[i].repeats = (uint8_t)(1 + (i % 3 == 0));
+    chain[i].kit_slot = (i % 4 == 0) ? kits[i / 4 % 4] : 0;
+  }
+  if (reset_engine() != 0 ||
+      Song_SetChain(chain, SONG_MAX_ENTRIES) != SONG_MAX_ENTRIES ||
+      Song_Start(&drumset) != 0)
+    return -1;
+
+  Host_Reset();
+  Host_DiskResetStats();
+  Sequencer_SetBPM(300);
+  Sequencer_Start();
+  while (Host_GetFrames() < limit) {
+    Host_Render(output, period, period);
+    hash = hash_bytes(hash, output, period * 4);
+
+    Pattern_CachePoll();
+    uint8_t events = Song_Poll();
+    kit_swaps += (events & SONG_EVENT_KIT) ? 1 : 0;
+    if (events & SONG_EVENT_PATTERN) {
+      uint8_t slot = Song_GetPatternSlot();
+      order = hash_bytes(order, &slot, 1);
+      changes++;
+      if (Song_GetPosition() == 0)
+        break; /* Back at the start */
+    }
+  }
+  Host_DiskGetStats(&disk);
+  Song_GetStats(&stats);
+  Song_Stop();
+  Sequencer_Stop();
+  if (changes != SONG_MAX_ENTRIES)
+    return -1;
+
+  record("chain.transitions", KIND_CHECKSUM, stats.transitions, "entries");
+  record("chain.late", KIND_COUNT, stats.late_transitions, "entries");
+  record("chain.kits", KIND_CHECKSUM, kit_swaps, "swaps");
+  record("chain.blocks", KIND_COUNT, disk.blocks_read, "blocks");
+  record("chain.order.sum", KIND_CHECKSUM, order, "");
+  record("chain.sum", KIND_CHECKSUM, hash, "");
+  return 0;
+}
+
+/**
+ * @brief Play a ratchet on the first step and time its onsets
+ * @param gaps Frames between onsets, filled
+ * @return Onsets found
+ */
+static int ratchet_onsets(uint16_t bpm, uint8_t hits, uint32_t period,
+                          uint32_t *gaps) {
+  uint32_t frames = AUDIO_SAMPLE_RATE * 60 / bpm / 2; /* Two steps */
+  uint32_t last = 0, quiet = 64;
+  int onsets = 0;
+  Pattern p;
+
+  memset(&p, 0, sizeof(p));
+  p.step_count = 16;
+  p.bpm = bpm;
+  p.steps[0][0] = 255;
+  p.ratchets[0][0] = (uint8_t)(hits - 1);
+
+  Host_Reset();
+  Sequencer_LoadPattern(&p);
+  Sequencer_SetBPM(bpm);
+  Sequencer_Start();
+  for (uint32_t done = 0; done < frames; done += period) {
+    Host_Render(output, period, period);
+    for (uint32_t i = 0; i < period; i++) {
+      /* Loud after 64 quiet frames; the click's tail stays below */
+      if (abs(output[i * 2]) < 4096) {
+        quiet++;
+        continue;
+      }
+      if (quiet >= 64) {
+        if (onsets > 0 && onsets <= 8)
+          gaps[onsets - 1] = done + i - last;
+        last = done + i;
+        onsets++;
+      }
+      quiet = 0;
+    }
+  }
+  Sequencer_Stop();
+  return onsets;
+}
+
+static int bench_ratchet(uint32_t period) {
+  static const uint16_t tempos[2] = {120, 300};
+  static int16_t click[8]; /* Ends well before the next hit */
+  uint32_t hash = HASH_INIT, error = 0;
+
+  if (reset_engine() != 0)
+    return -1;
+  for (int i = 0; i < 8; i++)
+    click[i] = 20000;
+  AudioMixer_SetSample(0, click, 8);
+
+  for (int t = 0; t < 2; t++) {
+    for (uint8_t hits = 2; hits <= 8; hits++) {
+      /* As the sequencer times them: a step's samples over the hits */
+      uint32_t expect =
+          AUDIO_SAMPLE_RATE * 60 / 4 / ((uint32_t)tempos[t] * hits);
+      uint32_t gaps[8];
+      if (ratchet_onsets(tempos[t], hits, period, gaps) != hits)
+        return -1;
+      for (int g = 0; g < hits - 1; g++) {
+        uint32_t off = gaps[g] > expect ? gaps[g] - expect : expect - gaps[g];
+        if (off > error)
+          error = off;
+      }
+      hash = hash_bytes(hash, gaps, (hits - 1) * sizeof(gaps[0]));
+    }
+  }
+  record("ratchet.error", KIND_COUNT, error, "frames");
+  record("ratchet.gaps.sum", KIND_CHECKSUM, hash, "");
+
+  /* The kit's own sample back on channel 0 */
+  return reset_engine();
+}
+
+/* Sequencer hits per channel, tallied from trace dumps */
+static uint32_t hit_counts[NUM_CHANNELS];
+
+static int count_hits(const uint8_t *data, uint32_t len) {
+  /* The header, then one call per entry; lap 0xFF was never written */
+  if (len == sizeof(TraceEntry) && data[4] == TRACE_TRIGGER &&
+      data[7] != 0xFF && data[5] < NUM_CHANNELS)
+    hit_counts[data[5]]++;
+  return 0;
+}
+
+/**
+ * @brief Run a pattern of probability trigs and count what plays
+ * @details Dumps every step, before the ring can wrap.
+ */
+static void count_prob_hits(const Pattern *p, uint32_t bars, uint32_t seed) {
+  memset(hit_counts, 0, sizeof(hit_counts));
+  Host_Reset();
+  Trace_Init(Host_CycleCounter(), HOST_CPU_MHZ);
+  Sequencer_SetSeed(seed);
+  Sequencer_LoadPattern(p);
+  Sequencer_Start();
+  for (uint32_t pulse = 1; pulse <= bars * 96; pulse++) {
+    Host_ClockPulse();
+    if (pulse % 6 == 0)
+      Trace_Dump(count_hits);
+  }
+  Trace_Dump(count_hits);
+  Sequencer_Stop();
+  Trace_Init(NULL, 1);
+}
+
+/* Chance per track; the last one always plays and counts the steps */
+static const uint8_t prng_chances[NUM_CHANNELS] = {10, 25, 50, 75, 90, 100};
+
+/**
+ * @brief Worst distance of the counted hits from their chances
+ * @return Per mille, -1 if steps went missing
+ */
+static int32_t prob_error(uint32_t bars) {
+  uint32_t steps = hit_counts[NUM_CHANNELS - 1];
+  int32_t error = 0;
+  if (steps < bars * 16)
+    return -1;
+  for (int ch = 0; ch < NUM_CHANNELS - 1; ch++) {
+    int32_t permille = (int32_t)(hit_counts[ch] * 1000 / steps);
+    int32_t off = abs(permille - prng_chances[ch] * 10);
+    if (off > error)
+      error = off;
+  }
+  return error;
+}
+
+static int bench_prng(void) {
+  const uint32_t bars = 5000;
+  Pattern p;
+
+  memset(&p, 0, sizeof(p));
+  p.step_count = 16;
+  p.bpm = 120;
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    for (int s = 0; s < 16; s++) {
+      p.steps[ch][s] = 200;
+      if (prng_chances[ch] < 100)
+        p.conditions[ch][s] = SEQ_COND_PROB(prng_chances[ch]);
+    }
+  }
+
+  count_prob_hits(&p, bars, 0);
+  int32_t error = prob_error(bars);
+  uint32_t hash = hash_bytes(HASH_INIT, hit_counts, sizeof(hit_counts));
+
+  /* Another seed: other hits, same odds */
+  count_prob_hits(&p, bars, 12345);
+  int32_t seeded = prob_error(bars);
+  Sequencer_SetSeed(0);
+  if (error < 0 || seeded < 0)
+    return -1;
+
+  record("prng.error", KIND_COUNT, error > seeded ? error : seeded,
+         "permille");
+  record("prng.hits.sum", KIND_CHECKSUM, hash, "");
+  record("prng.seeded.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, hit_counts, sizeof(hit_counts)), "");
+  return 0;
+}
+
+/* Live takes: pad 0 hit at these fractions of steps 1, 4, 7, 10, 13,
+ * between 64-frame buffers (lowest latency) whatever -p says: pulses due
+ * within a longer buffer would fire late and move the hits */
+#define LIVE_HITS 5
+#define LIVE_PERIOD 64
+static const double live_fractions[LIVE_HITS] = {0.1, 0.3, 0.6, 0.8, 0.95};
+static const uint8_t live_strengths[] = {100, 75, 50, 25, 0};
+#define LIVE_TAKES (sizeof(live_strengths) / sizeof(live_strengths[0]))
+
+/**
+ * @brief Record one bar of pad hits over an empty pattern
+ * @param expect Steps the hits belong on at this strength (bit per step)
+ * @return Steps written; hit_counts[0] holds the trigs the sequencer
+ *         played on channel 0 meanwhile
+ */
+static uint32_t live_take(uint8_t quantize, uint32_t *expect) {
+  const double step_frames = AUDIO_SAMPLE_RATE * 60.0 / (120 * 4);
+  uint32_t written = 0;
+  int next = 0;
+  Pattern p;
+
+  memset(&p, 0, sizeof(p));
+  p.step_count = 16;
+  p.bpm = 120;
+  memset(hit_counts, 0, sizeof(hit_counts));
+  *expect = 0;
+
+  Host_Reset();
+  Trace_Init(Host_CycleCounter(), HOST_CPU_MHZ);
+  Sequencer_LoadPattern(&p);
+  Sequencer_SetBPM(p.bpm);
+  LiveRecord_SetQuantize(quantize);
+  Sequencer_Start();
+  while (Host_GetFrames() + LIVE_PERIOD <= 16 * step_frames) {
+    Host_Render(output, LIVE_PERIOD, LIVE_PERIOD);
+    LiveRecord_Poll();
+    Trace_Dump(count_hits);
+
+    /* The pad interrupt, between buffers */
+    uint8_t step = (uint8_t)(next * 3 + 1);
+    double at = Host_GetFrames() / step_frames - step;
+    if (next < LIVE_HITS && at >= live_fractions[next]) {
+      LiveRecord_Hit(0, 255);
+      *expect |= 1u << (step + (at >= 1 - quantize / 200.0));
+      next++;
+    }
+  }
+  LiveRecord_Poll();
+  Sequencer_Stop();
+  Trace_Init(NULL, 1);
+
+  for (uint8_t s = 0; s < 16; s++)
+    written |= (uint32_t)(Sequencer_GetStep(0, s) != 0) << s;
+  return written;
+}
+
+static int bench_live(void) {
+  uint32_t hash = HASH_INIT, misplaced = 0, doubles = 0;
+
+  if (reset_engine() != 0)
+    return -1;
+  LiveRecord_SetMode(LIVE_RECORD_OVERDUB);
+  for (size_t i = 0; i < LIVE_TAKES; i++) {
+    uint32_t expect;
+    uint32_t written = live_take(live_strengths[i], &expect);
+    for (uint32_t diff = written ^ expect; diff; diff &= diff - 1)
+      misplaced++;
+    doubles += hit_counts[0];
+    hash = hash_bytes(hash, &written, sizeof(written));
+  }
+  LiveRecord_SetMode(LIVE_RECORD_OFF);
+
+  record("live.misplaced", KIND_COUNT, misplaced, "steps");
+  record("live.doubles", KIND_COUNT, doubles, "trigs");
+  record("live.steps.sum", KIND_CHECKSUM, hash, "");
+  return 0;
+}
+
+static int bench_monitor(uint32_t period) {
+  const uint32_t per_frame = HOST_CPU_MHZ * 1000000 / AUDIO_SAMPLE_RATE;
+  const uint32_t deadline = 128 * per_frame;
+  AudioMonitorStats stats;
+  Pattern pattern;
+
+  /* Start just short of the wrap: it comes a few renders in */
+  Host_Reset();
+  Host_AdvanceCycles(0xFFFFFFFFu - 3 * deadline);
+  AudioMonitor_Init(Host_CycleCounter(), per_frame);
+
+  /* Sixteenths of the deadline up to 18/16: every bin, then two late */
+  for (uint32_t k = 1; k <= 18; k++) {
+    uint32_t took = deadline / 16 * k;
+    uint8_t late = took > deadline;
+    AudioMonitor_Begin();
+    Host_AdvanceCycles(took);
+    AudioMonitor_End(128, late ? 0 : 128 - 128 * k / 17, late);
+    Host_AdvanceCycles(deadline - took / 2); /* Rest of the period */
+  }
+  AudioMonitor_GetStats(&stats);
+  record("monitor.renders", KIND_CHECKSUM, stats.renders, "renders");
+  record("monitor.underruns", KIND_CHECKSUM, stats.underruns, "renders");
+  record("monitor.avg", KIND_CHECKSUM, stats.avg_cycles, "cycles");
+  record("monitor.stats.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, &stats, sizeof(stats)), "");
+
+  /* A reset lands at the end of the next render */
+  AudioMonitor_Reset();
+  AudioMonitor_Begin();
+  Host_AdvanceCycles(deadline / 4);
+  AudioMonitor_End(128, 100, 0);
+  AudioMonitor_GetStats(&stats);
+  record("monitor.reset.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, &stats, sizeof(stats)), "");
+
+  /* Host_Render reports as the DMA interrupt does */
+  if (reset_engine() != 0 || Pattern_Load(&pattern, PATTERN_SLOT) != 0)
+    return -1;
+  Host_Reset();
+  AudioMonitor_Init(Host_CycleCounter(), per_frame);
+  Sequencer_LoadPattern(&pattern);
+  Sequencer_SetBPM(pattern.bpm);
+  Sequencer_Start();
+  for (uint32_t done = 0; done < AUDIO_SAMPLE_RATE; done += period)
+    Host_Render(output, period, period);
+  Sequencer_Stop();
+  AudioMonitor_GetStats(&stats);
+  AudioMonitor_Init(NULL, 0);
+  if (stats.deadline_cycles != period * per_frame ||
+      stats.min_margin != period)
+    return -1;
+  record("monitor.song.renders", KIND_CHECKSUM, stats.renders, "renders");
+  return 0;
+}
+
+/* Polymeter: lengths 3/4/5/7 against a 16-step bar, at 6 pulses per step,
+ * divided (/2, 12 pulses) and multiplied (x2, 3 pulses); the last track
+ * follows the bar */
+static const uint8_t poly_lengths[NUM_CHANNELS] = {3, 4, 5, 7, 5, 0};
+static const uint8_t poly_pulses[NUM_CHANNELS] = {6, 12, 3, 6, 12, 0};
+#define POLY_BARS 8
+#define POLY_V1_SLOT 50 /* Outside the slots the other cases use */
+
+/* Trig per channel in the pulse just dumped: velocity (step + 1), 0 if none */
+static uint8_t poly_onsets[NUM_CHANNELS];
+
+static int poly_hits(const uint8_t *data, uint32_t len) {
+  if (len == sizeof(TraceEntry) && data[4] == TRACE_TRIGGER &&
+      data[7] != 0xFF && data[5] < NUM_CHANNELS)
+    poly_onsets[data[5]] = data[6];
+  return 0;
+}
+
+/**
+ * @brief Fill every step of every track, velocity = step + 1
+ */
+static void make_poly(Pattern *p) {
+  memset(p, 0, sizeof(*p));
+  p->step_count = 16;
+  p->bpm = 120;
+  snprintf(p->name, sizeof(p->name), "POLY");
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    for (int s = 0; s < MAX_STEPS; s++)
+      p->steps[ch][s] = (uint8_t)(s + 1);
+  }
+}
+
+/**
+ * @brief Pulse the pattern for some bars and check every track's onsets
+ * @details A track with L steps of P pulses plays step (t / P) % L on
+ *          pulses t of the bar that P divides; every bar starts it over.
+ * @param hash Onsets, pulse by pulse, updated
+ * @param unaligned Tracks found off step 0 after a bar start, updated
+ * @return Onsets missing, extra or on the wrong step
+ */
+static uint32_t poly_run(const Pattern *p, uint32_t bars, uint32_t *hash,
+                         uint32_t *unaligned) {
+  const uint32_t bar = (uint32_t)p->step_count * 6;
+  uint32_t misplaced = 0;
+
+  Host_Reset();
+  Trace_Init(Host_CycleCounter(), HOST_CPU_MHZ);
+  Sequencer_LoadPattern(p);
+  Sequencer_Start(); /* Plays pulse 0 */
+  for (uint32_t pulse = 0; pulse <= bars * bar; pulse++) {
+    if (pulse > 0)
+      Host_ClockPulse();
+    memset(poly_onsets, 0, sizeof(poly_onsets));
+    Trace_Dump(poly_hits);
+
+    uint32_t at = pulse % bar;
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+      uint32_t length = p->track_length[ch] ? p->track_length[ch]
+                                            : p->step_count;
+      uint32_t pulses = p->track_pulses[ch] ? p->track_pulses[ch] : 6;
+      uint8_t expect = (at % pulses == 0) ? (uint8_t)(at / pulses % length + 1)
+                                          : 0;
+      misplaced += poly_onsets[ch] != expect;
+      if (at == 0 && Sequencer_GetTrackStep(ch) != 0)
+        (*unaligned)++;
+    }
+    *hash = hash_bytes(*hash, poly_onsets, sizeof(poly_onsets));
+  }
+  Sequencer_Stop();
+  Trace_Init(NULL, 1);
+  return misplaced;
+}
+
+/**
+ * @brief Find the pattern bank's first sector
+ * @return Sector, 0 if there is no bank
+ */
+static uint32_t find_bank(void) {
+  uint32_t dir = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
+  int count = FAT32_ListDir(dir, files, FAT32_MAX_FILES);
+  for (int i = 0; i < count; i++) {
+    if (strcmp(files[i].name, "PATTERNS.BNK") == 0)
+      return FAT32_GetFileSector(&files[i]);
+  }
+  return 0;
+}
+
+static int bench_poly(void) {
+  uint32_t hash = HASH_INIT, unaligned = 0, defaults = 0;
+  uint8_t sector[512];
+  Pattern p, loaded;
+
+  if (reset_engine() != 0)
+    return -1;
+  make_poly(&p);
+  memcpy(p.track_length, poly_lengths, sizeof(p.track_length));
+  memcpy(p.track_pulses, poly_pulses, sizeof(p.track_pulses));
+  uint32_t misplaced = poly_run(&p, POLY_BARS, &hash, &unaligned);
+  record("poly.misplaced", KIND_COUNT, misplaced, "onsets");
+  record("poly.unaligned", KIND_COUNT, unaligned, "tracks");
+  record("poly.onsets.sum", KIND_CHECKSUM, hash, "");
+
+  /* A record saved before per-track settings: the first 212 bytes of a
+   * zeroed sector, over a slot the bank already marks as used */
+  uint32_t bank = find_bank();
+  if (PATTERN_V1_SIZE != offsetof(Pattern, track_length) || bank == 0 ||
+      Pattern_Save(&p, POLY_V1_SLOT) != 0)
+    return -1;
+  make_poly(&p);
+  memset(sector, 0, sizeof(sector));
+  memcpy(sector, &p, PATTERN_V1_SIZE);
+  if (SDCARD_WriteBlock(bank + POLY_V1_SLOT, sector) != SDCARD_OK)
+    return -1;
+  for (uint8_t slot = 1; slot <= PATTERN_CACHE_SLOTS; slot++) {
+    if (Pattern_Load(&loaded, slot) != 0) /* Evicts the saved copy */
+      return -1;
+  }
+  if (Pattern_Load(&loaded, POLY_V1_SLOT) != 0)
+    return -1;
+
+  Sequencer_LoadPattern(&loaded);
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+    defaults += Sequencer_GetTrackLength(ch) != loaded.step_count;
+    defaults += Sequencer_GetTrackPulses(ch) != 6;
+  }
+  hash = HASH_INIT;
+  unaligned = 0;
+  misplaced = poly_run(&loaded, 2, &hash, &unaligned);
+  record("poly.v1.defaults", KIND_COUNT, defaults, "settings");
+  record("poly.v1.misplaced", KIND_COUNT, misplaced + unaligned, "onsets");
+  record("poly.v1.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, &loaded, sizeof(loaded)), "");
+  return 0;
+}
+
+/* Level cases: a constant sample on every channel, loud enough to
+ * measure, quiet enough that the limiter never acts (x1.41 at the pan
+ * extremes stays below its threshold) */
+#define LEVEL_DC 16384
+#define LEVEL_FRAMES 8192
+static int16_t level_pcm[LEVEL_FRAMES];
+
+/**
+ * @brief reset_engine with both effect returns off (bench_song turns them
+ *        on), so the mixer cases run the dry path only
+ */
+static int reset_dry(void) {
+  AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 0, 0);
+  AudioFx_SetReverb(0, 0, 0);
+  return reset_engine();
+}
+
+/**
+ * @brief Dry mixer as at boot with one constant sample on every channel
+ */
+static void load_level(int16_t value) {
+  for (int i = 0; i < LEVEL_FRAMES; i++)
+    level_pcm[i] = value;
+  reset_dry();
+  AudioMixer_Init();
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+    AudioMixer_SetSample(ch, level_pcm, LEVEL_FRAMES);
+}
+
+/**
+ * @brief Output of a hit on channel 0 once its pan ramp and the limiter
+ *        delay are behind it
+ */
+static void hit_level(uint8_t pan, uint8_t velocity, int32_t *l,
+                      int32_t *r) {
+  AudioMixer_SetPan(0, pan);
+  AudioMixer_Trigger(0, velocity);
+  for (int block = 0; block < 4; block++)
+    AudioMixer_Process(output, 128);
+  *l = output[127 * 2];
+  *r = output[127 * 2 + 1];
+}
+
+/* Every channel's pan moved on every block */
+static void sweep_pan(uint32_t done) {
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+    AudioMixer_SetPan(ch, (uint8_t)(done / 16 + ch * 43));
+}
+
+static int bench_pan(uint32_t period, double seconds) {
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / period * period;
+  uint32_t levels = HASH_INIT, hash = HASH_INIT, worst = 0;
+  double best = 1e9;
+  int32_t l, r;
+
+  /* Constant power: L^2 + R^2 at every pan against the centre */
+  load_level(LEVEL_DC);
+  hit_level(128, 255, &l, &r);
+  int64_t center = (int64_t)l * l + (int64_t)r * r;
+  for (int pan = 0; pan < 256; pan++) {
+    hit_level((uint8_t)pan, 255, &l, &r);
+    int64_t power = (int64_t)l * l + (int64_t)r * r;
+    uint32_t off = (uint32_t)((power > center ? power - center
+                                              : center - power) *
+                              1000 / center);
+    if (off > worst)
+      worst = off;
+    int32_t pair[2] = {l, r};
+    levels = hash_bytes(levels, pair, sizeof(pair));
+  }
+
+  /* Velocity curves, at the centre */
+  for (uint8_t curve = AUDIO_VELOCITY_LINEAR; curve <= AUDIO_VELOCITY_LOG;
+       curve++) {
+    AudioMixer_SetVelocityCurve(curve);
+    for (int velocity = 0; velocity < 256; velocity += 15) {
+      hit_level(128, (uint8_t)velocity, &l, &r);
+      levels = hash_bytes(levels, &l, sizeof(l));
+    }
+  }
+  AudioMixer_SetVelocityCurve(AUDIO_VELOCITY_LINEAR);
+
+  /* Six voices with their pans automated: the law costs a table lookup
+   * per change, nothing per frame */
+  for (int run = 0; run < RUNS; run++) {
+    if (reset_dry() != 0)
+      return -1;
+    uint32_t h = HASH_INIT;
+    double t = render_voices(NUM_CHANNELS, frames, period, sweep_pan,
+                             run == 0 ? &h : NULL);
+    if (run == 0)
+      hash = h;
+    if (t < best)
+      best = t;
+  }
+
+  record("mixer.pan.ns", KIND_TIME, best / frames * 1e9, "ns/frame");
+  record("mixer.pan.sum", KIND_CHECKSUM, hash, "");
+  record("mixer.pan.power", KIND_COUNT, worst, "permille");
+  record("mixer.pan.levels.sum", KIND_CHECKSUM, levels, "");
+  return reset_engine();
+}
+
+/**
+ * @brief Frames from a hit on channel 0 to its last non-zero output
+ * @details Includes the limiter's look-ahead delay.
+ */
+static uint32_t env_silence(uint8_t hold, uint8_t decay) {
+  uint32_t last = 0;
+
+  load_level(LEVEL_DC);
+  AudioMixer_SetEnvelope(0, hold, decay);
+  AudioMixer_Process(output, 128); /* Applies it */
+  AudioMixer_Trigger(0, 255);
+  for (uint32_t done = 0; done < LEVEL_FRAMES + 1024; done += 128) {
+    AudioMixer_Process(output, 128);
+    for (uint32_t i = 0; i < 128; i++) {
+      if (output[i * 2] != 0)
+        last = done + i + 1;
+    }
+  }
+  return last;
+}
+
+/**
+ * @brief Six voices, all with this envelope
+ * @return Best render time in seconds, negative on error
+ */
+static double render_envelope(uint8_t decay, uint32_t frames,
+                              uint32_t period, uint32_t *hash) {
+  double best = 1e9;
+  for (int run = 0; run < RUNS; run++) {
+    if (reset_dry() != 0)
+      return -1;
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+      AudioMixer_SetEnvelope(ch, 0, decay);
+    uint32_t h = HASH_INIT;
+    double t = render_voices(NUM_CHANNELS, frames, period, NULL,
+                             run == 0 ? &h : NULL);
+    if (run == 0)
+      *hash = h;
+    if (t < best)
+      best = t;
+  }
+  return best;
+}
+
+static int bench_envelope(uint32_t period, double seconds) {
+  const uint32_t delay = 128; /* Limiter look-ahead */
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / period * period;
+  uint32_t hash = HASH_INIT, late = 0;
+
+  /* -60dB (silence) is due hold + decay after the hit, in 10ms units; the
+   * voice has to stop by then, give or take the sub-block it lands in */
+  static const uint8_t shapes[][2] = {{0, 5}, {10, 5}, {0, 20}, {4, 12}};
+  uint32_t silence[4];
+  for (int i = 0; i < 4; i++) {
+    silence[i] = env_silence(shapes[i][0], shapes[i][1]);
+    uint32_t due = delay + 16 +
+                   (shapes[i][0] + shapes[i][1]) * (AUDIO_SAMPLE_RATE / 100);
+    if (silence[i] > due && silence[i] - due > late)
+      late = silence[i] - due;
+  }
+
+  /* Decays longer than the samples: the envelope's own cost */
+  double t = render_envelope(255, frames, period, &hash);
+  if (t < 0)
+    return -1;
+  record("mixer.env.ns", KIND_TIME, t / frames * 1e9, "ns/frame");
+  record("mixer.env.sum", KIND_CHECKSUM, hash, "");
+
+  /* 10ms decays: voices stop well before the next hit */
+  t = render_envelope(1, frames, period, &hash);
+  if (t < 0)
+    return -1;
+  record("mixer.env.short.ns", KIND_TIME, t / frames * 1e9, "ns/frame");
+  record("mixer.env.short.sum", KIND_CHECKSUM, hash, "");
+
+  record("mixer.env.late", KIND_COUNT, late, "frames");
+  record("mixer.env.silence.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, silence, sizeof(silence)), "");
+  return reset_engine();
+}
+
+/* Every channel's cutoff moved on every block, at full resonance */
+static void sweep_filter(uint32_t done) {
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+    AudioMixer_SetFilter(ch, 1 + ch % 3, (uint8_t)(done / 16 + ch * 43), 255);
+}
+
+/* The same sweep with every filter off */
+static void sweep_filter_off(uint32_t done) {
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+    AudioMixer_SetFilter(ch, AUDIO_FILTER_OFF, (uint8_t)(done / 16), 255);
+}
+
+static int bench_filter(uint32_t period, double seconds) {
+  static void (*const sweeps[2])(uint32_t) = {sweep_filter,
+                                              sweep_filter_off};
+  static const char *const names[2] = {"mixer.filter", "mixer.filter.off"};
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / period * period;
+  char name[MAX_NAME];
+
+  for (int i = 0; i < 2; i++) {
+    uint32_t hash = HASH_INIT;
+    double best = 1e9;
+    for (int run = 0; run < RUNS; run++) {
+      if (reset_dry() != 0)
+        return -1;
+      uint32_t h = HASH_INIT;
+      double t = render_voices(NUM_CHANNELS, frames, period, sweeps[i],
+                               run == 0 ? &h : NULL);
+      if (run == 0)
+        hash = h;
+      if (t < best)
+        best = t;
+    }
+    snprintf(name, sizeof(name), "%s.ns", names[i]);
+    record(name, KIND_TIME, best / frames * 1e9, "ns/frame");
+    snprintf(name, sizeof(name), "%s.sum", names[i]);
+    record(name, KIND_CHECKSUM, hash, "");
+  }
+  return reset_engine();
+}
+
+/**
+ * @brief Full-scale burst: six hits of a full-scale square wave at once,
+ *        at full velocity and centre pan, every 1024 frames
+ * @param clipped Output samples at full scale (+32767 or -32768), updated
+ * @param peak Largest output magnitude, updated
+ * @param hash Output checksum, updated
+ */
+static void limit_burst(uint32_t frames, uint32_t period, uint32_t *clipped,
+                        int32_t *peak, uint32_t *hash) {
+  load_level(32767);
+  for (int i = 0; i < LEVEL_FRAMES; i++) {
+    if (i / 50 % 2)
+      level_pcm[i] = -32768;
+  }
+  for (uint32_t done = 0; done < frames; done += period) {
+    if (done % 1024 < period) {
+      for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+        AudioMixer_Trigger(ch, 255);
+    }
+    AudioMixer_Process(output, period);
+    for (uint32_t i = 0; i < period * 2; i++) {
+      int32_t v = output[i];
+      *clipped += (v == 32767 || v == -32768);
+      if (v < 0)
+        v = -v;
+      if (v > *peak)
+        *peak = v;
+    }
+    *hash = hash_bytes(*hash, output, period * 4);
+  }
+}
+
+static int bench_limiter(uint32_t period, double seconds) {
+  static const char *const names[2] = {"mixer.limit", "mixer.softclip"};
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / period * period;
+  char name[MAX_NAME];
+
+  for (uint8_t soft = 0; soft < 2; soft++) {
+    uint32_t clipped = 0, hash = HASH_INIT;
+    int32_t peak = 0;
+    double best = 1e9;
+
+    AudioMixer_SetSoftClip(soft);
+    for (int run = 0; run < RUNS; run++) {
+      uint32_t c = 0, h = HASH_INIT;
+      int32_t p = 0;
+      double t = now_s();
+      limit_burst(frames, period, &c, &p, &h);
+      t = now_s() - t;
+      if (run == 0) {
+        clipped = c;
+        peak = p;
+        hash = h;
+      }
+      if (t < best)
+        best = t;
+    }
+    uint16_t reduction = AudioMixer_GetGainReduction();
+
+    size_t len = (size_t)snprintf(name, sizeof(name), "%s", names[soft]);
+    snprintf(name + len, sizeof(name) - len, ".ns");
+    record(name, KIND_TIME, best / (frames / period) * 1e9, "ns/block");
+    snprintf(name + len, sizeof(name) - len, ".clipped");
+    record(name, KIND_COUNT, clipped, "samples");
+    snprintf(name + len, sizeof(name) - len, ".peak");
+    record(name, KIND_COUNT, peak, "");
+    snprintf(name + len, sizeof(name) - len, ".gr");
+    record(name, KIND_CHECKSUM, reduction, "Q15");
+    snprintf(name + len, sizeof(name) - len, ".sum");
+    record(name, KIND_CHECKSUM, hash, "");
+  }
+  AudioMixer_SetSoftClip(0);
+  return reset_engine();
+}
+
+/* Effects RAM the firmware reserves (STM32F411.ld), debug and release */
+static const struct {
+  const char *name;
+  uint32_t bytes;
+} fx_budgets[] = {
+    {"mixer.fx6k", 6144},
+    {"mixer.fx4k", 4096},
+};
+#define FX_BUDGETS (sizeof(fx_budgets) / sizeof(fx_budgets[0]))
+
+/* Effect returns under test: delay level, reverb level */
+static const struct {
+  const char *name;
+  uint8_t delay;
+  uint8_t reverb;
+} fx_modes[] = {
+    {"mixer.fx.delay", 150, 0},
+    {"mixer.fx.reverb", 0, 140},
+    {"mixer.fx.both", 150, 140},
+};
+#define FX_MODES (sizeof(fx_modes) / sizeof(fx_modes[0]))
+
+static int bench_fx(double seconds) {
+  static int32_t sends[AUDIO_FX_BUSES][AUDIO_FX_MAX_STEPS];
+  static int32_t mix[128 * 2];
+  uint32_t passes = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / 128;
+  AudioFxStats stats;
+  char name[MAX_NAME];
+
+  /* What each budget holds, at 120 BPM with an 8th-note delay */
+  for (size_t i = 0; i < FX_BUDGETS; i++) {
+    if (AudioFx_Init(fx_ram, fx_budgets[i].bytes) != 0)
+      return -1;
+    AudioFx_SetTempo(120);
+    AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 110, 150);
+    AudioFx_SetReverb(170, 100, 140);
+    memset(sends, 0, sizeof(sends));
+    AudioFx_Process(sends, mix, 128); /* Sizes the delay lines */
+    AudioFx_GetStats(&stats);
+    if (!stats.reverb_ok || stats.ram_bytes > fx_budgets[i].bytes)
+      return -1;
+
+    size_t len =
+        (size_t)snprintf(name, sizeof(name), "%s", fx_budgets[i].name);
+    snprintf(name + len, sizeof(name) - len, ".ram");
+    record(name, KIND_COUNT, stats.ram_bytes, "bytes");
+    snprintf(name + len, sizeof(name) - len, ".max");
+    record(name, KIND_CHECKSUM, stats.delay_max_ms, "ms");
+    snprintf(name + len, sizeof(name) - len, ".delay");
+    record(name, KIND_CHECKSUM, stats.delay_ms, "ms");
+  }
+
+  /* One 128-frame pass at a time, on noise at full send */
+  for (size_t m = 0; m < FX_MODES; m++) {
+    uint32_t hash = HASH_INIT;
+    double best = 1e9;
+    for (int run = 0; run < RUNS; run++) {
+      uint32_t h = HASH_INIT;
+      double total = 0;
+      AudioFx_Init(fx_ram, fx_budgets[0].bytes);
+      AudioFx_SetTempo(120);
+      AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 110, fx_modes[m].delay);
+      AudioFx_SetReverb(170, 100, fx_modes[m].reverb);
+      rng_state = 1;
+      for (uint32_t pass = 0; pass < passes; pass++) {
+        for (int k = 0; k < AUDIO_FX_MAX_STEPS; k++) {
+          sends[AUDIO_FX_DELAY][k] = noise() * AUDIO_FX_DECIMATE / 2;
+          sends[AUDIO_FX_REVERB][k] = noise() * AUDIO_FX_DECIMATE / 2;
+        }
+        memset(mix, 0, sizeof(mix));
+        double t = now_s();
+        AudioFx_Process(sends, mix, 128);
+        total += now_s() - t;
+        if (run == 0)
+          h = hash_bytes(h, mix, sizeof(mix));
+      }
+      if (run == 0)
+        hash = h;
+      if (total < best)
+        best = total;
+    }
+
+    size_t len = (size_t)snprintf(name, sizeof(name), "%s", fx_modes[m].name);
+    snprintf(name + len, sizeof(name) - len, ".ns");
+    record(name, KIND_TIME, best / passes * 1e9, "ns/block");
+    snprintf(name + len, sizeof(name) - len, ".sum");
+    record(name, KIND_CHECKSUM, hash, "");
+  }
+
+  /* Back to the bench's RAM, returns off */
+  AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 0, 0);
+  AudioFx_SetReverb(0, 0, 0);
+  return reset_engine();
+}
+
+/* Latency modes: the full load (filters, both effects, all six voices
+ * retriggered every 16th at 120 BPM) rendered one DMA buffer at a time,
+ * replayed on the simulated cycle counter as the buffer interrupts would
+ * run on the target: host time times LATENCY_SLOWDOWN (target vs host),
+ * late by up to LATENCY_JITTER_US with interrupts held off, and by an SD
+ * transfer of LATENCY_STALL_US every LATENCY_STALL_MS */
+#define LATENCY_FRAMES (2 * AUDIO_SAMPLE_RATE)
+#define LATENCY_SLOWDOWN 25
+#define LATENCY_JITTER_US 20
+#define LATENCY_STALL_US 3000
+#define LATENCY_STALL_MS 250
+
+/**
+ * @brief Replay the timed renders through the render monitor
+ * @param cost Device cycles of each render
+ * @param stalls 1 to run the SD stall script
+ */
+static void latency_replay(const uint32_t *cost, uint32_t calls,
+                           uint32_t period, uint8_t stalls,
+                           AudioMonitorStats *stats) {
+  const uint32_t per_frame = HOST_CPU_MHZ * 1000000 / AUDIO_SAMPLE_RATE;
+  const uint32_t deadline = period * per_frame;
+  const uint32_t interval = LATENCY_STALL_MS * 1000 * HOST_CPU_MHZ;
+  uint32_t stall_at = interval / 2, busy_until = 0;
+
+  Host_Reset();
+  AudioMonitor_Init(Host_CycleCounter(), per_frame);
+  rng_state = 1;
+  for (uint32_t i = 0; i < calls; i++) {
+    uint32_t boundary = i * deadline;
+    uint32_t start = boundary + (uint32_t)(noise() + 32768) *
+                                    (LATENCY_JITTER_US * HOST_CPU_MHZ) /
+                                    65536;
+    if (stalls && boundary >= stall_at) {
+      start += LATENCY_STALL_US * HOST_CPU_MHZ;
+      stall_at += interval;
+    }
+    if (start < busy_until)
+      start = busy_until;
+
+    Host_AdvanceCycles(start - *Host_CycleCounter());
+    AudioMonitor_Begin();
+    Host_AdvanceCycles(cost[i]);
+    busy_until = start + cost[i];
+    /* The DMA moves on to this buffer at the next boundary */
+    uint8_t late = busy_until > boundary + deadline;
+    AudioMonitor_End(period,
+                     late ? 0 : (boundary + deadline - busy_until) / per_frame,
+                     late);
+  }
+  AudioMonitor_GetStats(stats);
+  AudioMonitor_Init(NULL, 0);
+}
+
+static int bench_latency(void) {
+  static uint32_t cost[LATENCY_FRAMES / 64];
+  const uint32_t step = AUDIO_SAMPLE_RATE * 60 / 120 / 4;
+  AudioMonitorStats stats;
+  char name[MAX_NAME];
+
+  for (uint8_t mode = AUDIO_LATENCY_64;
+       AUDIO_PERIOD_FRAMES(mode) <= AUDIO_PERIOD_MAX; mode++) {
+    uint32_t period = (uint32_t)AUDIO_PERIOD_FRAMES(mode);
+    uint32_t calls = LATENCY_FRAMES / period;
+
+    /* Each render keeps its fastest run (host noise) */
+    for (uint32_t i = 0; i < calls; i++)
+      cost[i] = UINT32_MAX;
+    for (int run = 0; run < RUNS; run++) {
+      if (reset_dry() != 0)
+        return -1;
+      for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        AudioMixer_SetFilter(ch, 1 + ch % 3, 128, 160);
+        AudioMixer_SetSend(ch, AUDIO_FX_DELAY, 120);
+        AudioMixer_SetSend(ch, AUDIO_FX_REVERB, 120);
+      }
+      AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 110, 150);
+      AudioFx_SetReverb(170, 100, 140);
+      for (uint32_t i = 0; i < calls; i++) {
+        uint32_t done = i * period;
+        /* Triggers land on the buffer the step falls in */
+        if (done % step < period) {
+          for (int ch = 0; ch < NUM_CHANNELS; ch++)
+            AudioMixer_Trigger((uint8_t)ch, 255);
+        }
+        double t = now_s();
+        AudioMixer_Process(output, period);
+        t = (now_s() - t) * LATENCY_SLOWDOWN * HOST_CPU_MHZ * 1e6;
+        if (t < cost[i])
+          cost[i] = (uint32_t)t;
+      }
+    }
+
+    size_t len = (size_t)snprintf(name, sizeof(name), "latency.%u", period);
+    latency_replay(cost, calls, period, 0, &stats);
+    snprintf(name + len, sizeof(name) - len, ".us");
+    record(name, KIND_TIME, stats.avg_cycles / (double)HOST_CPU_MHZ, "us");
+    snprintf(name + len, sizeof(name) - len, ".jitter");
+    record(name, KIND_COUNT, stats.underruns, "misses");
+    latency_replay(cost, calls, period, 1, &stats);
+    snprintf(name + len, sizeof(name) - len, ".stall");
+    record(name, KIND_COUNT, stats.underruns, "misses");
+  }
+  return reset_dry();
+}
+
+/* Pattern cache coherence: a slot no other case uses */
+#define COHERE_SLOT 60
+
+/**
+ * @brief Load a slot and compare every byte with what was saved last
+ * @return 1 if they differ (or the load fails), 0 if they match
+ */
+static uint32_t cohere_check(const Pattern *saved, uint32_t *hash) {
+  Pattern loaded;
+  memset(&loaded, 0xA5, sizeof(loaded));
+  if (Pattern_Load(&loaded, COHERE_SLOT) != 0)
+    return 1;
+  *hash = hash_bytes(*hash, &loaded, sizeof(loaded));
+  return memcmp(&loaded, saved, sizeof(loaded)) != 0;
+}
+
+static int bench_cohere(void) {
+  PatternCacheStats before, after;
+  Pattern saved, filler;
+  uint32_t stale = 0, hash = HASH_INIT;
+
+  /* Save then load: served from the write-through copy */
+  make_pattern(&saved, 1);
+  if (Pattern_Save(&saved, COHERE_SLOT) != 0)
+    return -1;
+  stale += cohere_check(&saved, &hash);
+
+  /* Re-save the cached slot with other content: no stale copy */
+  make_pattern(&saved, 2);
+  saved.bpm = 97;
+  saved.track_length[0] = 5;
+  if (Pattern_Save(&saved, COHERE_SLOT) != 0)
+    return -1;
+  stale += cohere_check(&saved, &hash);
+
+  /* Push it out with more loads than the cache holds, then reload from
+   * the card */
+  for (uint8_t slot = 1; slot <= PATTERN_CACHE_SLOTS + 1; slot++) {
+    if (Pattern_Load(&filler, slot) != 0)
+      return -1;
+  }
+  Pattern_GetCacheStats(&before);
+  stale += cohere_check(&saved, &hash);
+  Pattern_GetCacheStats(&after);
+  if (after.misses != before.misses + 1)
+    return -1; /* Still cached: the card copy went unchecked */
+
+  /* And once more from the copy that load cached */
+  stale += cohere_check(&saved, &hash);
+
+  record("pattern.cache.stale", KIND_COUNT, stale, "loads");
+  record("pattern.cache.sum", KIND_CHECKSUM, hash, "");
+  return 0;
+}
+
+/**
+ * @brief The pattern menu's slot list as it was before the bank: list
+ *        PATTERNS and parse every PAT-XXX.PAT name
+ * @return Slots found
+ */
+static int scan_pattern_files(uint8_t *slots, int max_slots) {
+  uint32_t dir = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
+  int count = FAT32_ListDir(dir, files, FAT32_MAX_FILES);
+  int found = 0;
+  for (int i = 0; i < count && found < max_slots; i++) {
+    int slot;
+    if (strncmp(files[i].name, "PAT-", 4) == 0 &&
+        sscanf(files[i].name + 4, "%d", &slot) == 1 && slot >= 1 &&
+        slot <= 100)
+      slots[found++] = (uint8_t)slot;
+  }
+  return found;
+}
+
+/* Opening the pattern menu: the bank's bitmap against the directory scan
+ * it replaced, over the same slots (run last: it adds PAT-XXX.PAT files) */
+static int bench_menu(void) {
+  uint8_t bank_slots[100], scan_slots[100];
+  HostDiskStats disk;
+  Pattern pattern;
+  char name[13];
+  double best_bank = 1e9, best_scan = 1e9;
+  uint32_t bank_blocks = 0, scan_blocks = 0;
+
+  /* The files an unmigrated card would hold for the same slots */
+  int count = Pattern_GetOccupiedSlots(bank_slots, 100);
+  uint32_t dir = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
+  for (int i = 0; i < count; i++) {
+    snprintf(name, sizeof(name), "PAT-%03u.PAT", bank_slots[i]);
+    if (Pattern_Load(&pattern, bank_slots[i]) != 0 ||
+        FAT32_WriteFile(dir, name, (const uint8_t *)&pattern,
+                        sizeof(pattern)) != 0)
+      return -1;
+  }
+
+  for (int run = 0; run < RUNS; run++) {
+    Host_DiskResetStats();
+    double t = now_s();
+    int n = Pattern_GetOccupiedSlots(bank_slots, 100);
+    t = now_s() - t;
+    Host_DiskGetStats(&disk);
+    bank_blocks = disk.blocks_read;
+    if (n != count)
+      return -1;
+    if (t < best_bank)
+      best_bank = t;
+
+    Host_DiskResetStats();
+    t = now_s();
+    n = scan_pattern_files(scan_slots, 100);
+    t = now_s() - t;
+    Host_DiskGetStats(&disk);
+    scan_blocks = disk.blocks_read;
+    if (n != count || memcmp(scan_slots, bank_slots, (size_t)n) != 0)
+      return -1;
+    if (t < best_scan)
+      best_scan = t;
+  }
+
+  record("pattern.menu.us", KIND_TIME, best_bank * 1e6, "us");
+  record("pattern.menu.blocks", KIND_COUNT, bank_blocks, "blocks");
+  record("pattern.scan.us", KIND_TIME, best_scan * 1e6, "us");
+  record("pattern.scan.blocks", KIND_COUNT, scan_blocks, "blocks");
+  record("pattern.menu.slots", KIND_CHECKSUM, count, "slots");
+  return 0;
+}
+
+/* Every condition type on every step: track ch, step s plays
+ * cond_types[(s + ch) % 6], so each step pulse checks all six at once and
+ * every track runs PRE after a chance and NOT_PRE after a loop count */
+static const uint8_t cond_types[NUM_CHANNELS] = {
+    SEQ_COND_PROB(50), SEQ_COND_PRE,  SEQ_COND_LOOP(1, 2),
+    SEQ_COND_NOT_PRE,  SEQ_COND_FILL, SEQ_COND_NOT_FILL};
+#define COND_BARS 2000
+
+static void make_cond(Pattern *p) {
+  memset(p, 0, sizeof(*p));
+  p->step_count = 16;
+  p->bpm = 120;
+  snprintf(p->name, sizeof(p->name), "CONDS");
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    for (int s = 0; s < 16; s++) {
+      p->steps[ch][s] = 200;
+      p->conditions[ch][s] = cond_types[(s + ch) % NUM_CHANNELS];
+      /* 4-hit ramped ratchets throughout */
+      p->ratchets[ch][s / 2] |=
+          (uint8_t)((4 | SEQ_RATCHET_RAMP) << ((s & 1) * 4));
+    }
+  }
+}
+
+/**
+ * @brief Run the pattern, fill held on every other bar
+ * @param step_s Time in the step pulses, updated (NULL: count hits from
+ *               the trace instead, dumped every step)
+ * @return Time in all pulses, seconds
+ */
+static double run_cond(const Pattern *p, double *step_s) {
+  Host_Reset();
+  if (!step_s) {
+    memset(hit_counts, 0, sizeof(hit_counts));
+    Trace_Init(Host_CycleCounter(), HOST_CPU_MHZ);
+  }
+  Sequencer_SetSeed(0);
+  Sequencer_LoadPattern(p);
+  Sequencer_Start();
+  double total = 0;
+  for (uint32_t pulse = 0; pulse < COND_BARS * 96; pulse++) {
+    if (pulse % 96 == 0)
+      Sequencer_SetFill((uint8_t)(pulse / 96 % 2));
+    double t = now_s();
+    Host_ClockPulse();
+    t = now_s() - t;
+    total += t;
+    if (step_s && pulse % 6 == 5) /* The sixth pulse moves the step on */
+      *step_s += t;
+    if (!step_s && pulse % 6 == 5)
+      Trace_Dump(count_hits);
+  }
+  Sequencer_Stop();
+  Sequencer_SetFill(0);
+  if (!step_s) {
+    Trace_Dump(count_hits);
+    Trace_Init(NULL, 1);
+  }
+  return total;
+}
+
+static int bench_cond(void) {
+  const uint32_t steps = COND_BARS * 16;
+  double best_step = 1e9, best_pulse = 1e9;
+  uint32_t hits = 0;
+  Pattern p;
+
+  make_cond(&p);
+  if (reset_engine() != 0)
+    return -1;
+  for (int run = 0; run < RUNS; run++) {
+    double step = 0;
+    double total = run_cond(&p, &step);
+    if (step < best_step)
+      best_step = step;
+    if (total < best_pulse)
+      best_pulse = total;
+  }
+  run_cond(&p, NULL);
+
+  /* Every track sees every type: none may always or never play */
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    if (hit_counts[ch] == 0 || hit_counts[ch] >= steps)
+      return -1;
+    hits += hit_counts[ch];
+  }
+  record("seq.cond.step.ns", KIND_TIME, best_step / steps * 1e9, "ns/step");
+  record("seq.cond.pulse.ns", KIND_TIME, best_pulse / (steps * 6) * 1e9,
+         "ns/pulse");
+  record("seq.cond.hits", KIND_CHECKSUM, hits, "trigs");
+  record("seq.cond.hits.sum", KIND_CHECKSUM,
+         hash_bytes(HASH_INIT, hit_counts, sizeof(hit_counts)), "");
+  return reset_engine();
+}
+
+/* Trig bitmaps: a sparse 16-step pattern (four on the floor, backbeat,
+ * 8th hats), also with one track off the master grid so the clock
+ * interrupt gathers a bit per track instead of one column lookup */
+static void make_sparse(Pattern *p, uint8_t poly) {
+  memset(p, 0, sizeof(*p));
+  p->step_count = 16;
+  p->bpm = 120;
+  snprintf(p->name, sizeof(p->name), "SPARSE");
+  for (int s = 0; s < 16; s++) {
+    if (s % 4 == 0)
+      p->steps[0][s] = 255;
+    if (s % 8 == 4)
+      p->steps[1][s] = 200;
+    if (s % 2 == 0)
+      p->steps[2][s] = 90;
+  }
+  if (poly)
+    p->track_length[2] = 12;
+}
+
+/**
+ * @brief Clock pulses alone, best of RUNS
+ * @return Seconds per pulse
+ */
+static double time_pulses(const Pattern *p, uint32_t pulses) {
+  double best = 1e9;
+  for (int run = 0; run < RUNS; run++) {
+    Host_Reset();
+    Sequencer_LoadPattern(p);
+    Sequencer_Start();
+    double t = now_s();
+    for (uint32_t i = 0; i < pulses; i++)
+      Host_ClockPulse();
+    t = now_s() - t;
+    Sequencer_Stop();
+    if (t < best)
+      best = t;
+  }
+  return best / pulses;
+}
+
+/**
+ * @brief Redraw step edit cells as DrawStepEditScreen (main.c) does: box,
+ *        then the velocity indicator (cursor and playhead left out)
+ * @param cells Bit per step to redraw
+ * @return SPI bytes sent
+ */
+static uint32_t draw_grid(uint8_t ch, uint32_t cells) {
+  HostSpiStats spi;
+  Host_SpiResetStats();
+  for (int i = 0; i < 32; i++) {
+    if (!((cells >> i) & 1))
+      continue;
+    uint16_t x = (uint16_t)(12 + i % 8 * 38), y = (uint16_t)(50 + i / 8 * 42);
+    uint8_t velocity = Sequencer_GetStep(ch, (uint8_t)i);
+    ST7789_FillRect(x, y, 34, 36, 0x2104);
+    if (velocity >= 255)
+      ST7789_FillRect(x, y, 34, 36, RED);
+    else if (velocity >= 128)
+      ST7789_FillRect(x + 5, y + 6, 24, 24, RED);
+    else if (velocity >= 64)
+      ST7789_FillRect(x + 9, y + 10, 16, 16, RED);
+    else if (velocity > 0)
+      ST7789_FillRect(x + 13, y + 14, 8, 8, RED);
+  }
+  Host_SpiGetStats(&spi);
+  return spi.bytes;
+}
+
+static int bench_bits(void) {
+  const uint32_t pulses = 24 * 4 * 2000; /* 2000 bars */
+  Pattern p;
+
+  if (reset_engine() != 0)
+    return -1;
+  memset(&p, 0, sizeof(p));
+  p.step_count = 16;
+  record("seq.empty.ns", KIND_TIME, time_pulses(&p, pulses) * 1e9,
+         "ns/pulse");
+  make_sparse(&p, 0);
+  record("seq.sparse.ns", KIND_TIME, time_pulses(&p, pulses) * 1e9,
+         "ns/pulse");
+  make_sparse(&p, 1);
+  record("seq.sparse.poly.ns", KIND_TIME, time_pulses(&p, pulses) * 1e9,
+         "ns/pulse");
+
+  /* Hats in step edit: every cell (the old refresh), then what the
+   * bitmap sends after one edit and after a pattern swap */
+  const uint8_t ch = 2;
+  make_sparse(&p, 0);
+  Sequencer_LoadPattern(&p);
+  uint32_t drawn = Sequencer_GetTrackMask(ch);
+  record("grid.all.bytes", KIND_COUNT, draw_grid(ch, 0xFFFFFFFFu), "bytes");
+
+  Sequencer_SetStep(ch, 5, 200);
+  uint32_t mask = Sequencer_GetTrackMask(ch);
+  if (mask == drawn)
+    return -1;
+  record("grid.edit.bytes", KIND_COUNT, draw_grid(ch, mask ^ drawn), "bytes");
+
+  drawn = mask;
+  make_dense(&p);
+  Sequencer_LoadPattern(&p);
+  mask = Sequencer_GetTrackMask(ch);
+  record("grid.swap.bytes", KIND_COUNT, draw_grid(ch, mask ^ drawn), "bytes");
+  return reset_engine();
+}
+
+static int bench_song(const char *wav_path, uint32_t period, double seconds) {
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE) / period * period;
+  Pattern pattern;
+  uint32_t hash = HASH_INIT;
+
+  if (reset_engine() != 0 || Pattern_Load(&pattern, PATTERN_SLOT) != 0)
+    return -1;
+  if (wav_path && Host_WavOpen(wav_path) != 0)
+    return -1;
+
+  AudioMixer_SetSend(1, AUDIO_FX_REVERB, 100);
+  AudioMixer_SetSend(4, AUDIO_FX_DELAY, 90);
+  AudioFx_SetDelay(AUDIO_FX_DIV_8TH, 110, 150);
+  AudioFx_SetReverb(170, 100, 140);
+
+  double t = play(&pattern, frames, period, &hash, wav_path != NULL);
+  if (t < 0)
+    return -1;
+  record("song.ns", KIND_TIME, t / frames * 1e9, "ns/frame");
+  record("song.sum", KIND_CHECKSUM, hash, "");
+  return wav_path ? Host_WavClose() : 0;
+}
+
+static void format_value(const Result *r, double value, char *out,
+                         size_t len) {
+  if (r->kind == KIND_CHECKSUM && value >= 0)
+    snprintf(out, len, "%08x", (uint32_t)value);
+  else if (r->kind == KIND_TIME)
+    snprintf(out, len, "%.3f", value);
+  else
+    snprintf(out, len, "%g", value);
+}
+
+static int write_json(const char *path, uint32_t period, double seconds) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return -1;
+
+  fprintf(f, "{\n  \"period\": %u,\n  \"seconds\": %g,\n  \"results\": [\n",
+          period, seconds);
+  for (int i = 0; i < result_count; i++) {
+    const Result *r = &results[i];
+    fprintf(f,
+            "    {\"name\": \"%s\", \"kind\": \"%s\", \"value\": %.*f, "
+            "\"unit\": \"%s\"}%s\n",
+            r->name, kind_names[r->kind], r->kind == KIND_TIME ? 3 : 0,
+            r->value, r->unit, i + 1 < result_count ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  return fclose(f) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Print the results, against a baseline if there is one
+ * @return Number of regressions, negative if the baseline is unreadable
+ */
+static int report(const char *baseline, double threshold) {
+  static Result base[MAX_RESULTS];
+  int base_count = 0;
+
+  if (baseline) {
+    FILE *f = fopen(baseline, "r");
+    char line[256];
+    if (!f)
+      return -1;
+    /* Our own format: one result per line */
+    while (base_count < MAX_RESULTS && fgets(line, sizeof(line), f)) {
+      Result *b = &base[base_count];
+      char kind[16];
+      if (sscanf(line, " {\"name\": \"%39[^\"]\", \"kind\": \"%15[^\"]\", "
+                       "\"value\": %lf",
+                 b->name, kind, &b->value) == 3)
+        base_count++;
+    }
+    fclose(f);
+  }
+
+  int regressions = 0;
+  for (int i = 0; i < result_count; i++) {
+    const Result *r = &results[i];
+    const Result *b = NULL;
+    char value[24], was[24] = "", change[16] = "";
+    const char *status = baseline ? "new" : "";
+
+    for (int j = 0; j < base_count && !b; j++) {
+      if (strcmp(base[j].name, r->name) == 0)
+        b = &base[j];
+    }
+    format_value(r, r->value, value, sizeof(value));
+    if (b) {
+      uint8_t worse;
+      format_value(r, b->value, was, sizeof(was));
+      if (r->kind == KIND_TIME) {
+        worse = r->value > b->value * (1 + threshold / 100);
+        if (b->value > 0)
+          snprintf(change, sizeof(change), "%+.1f%%",
+                   (r->value / b->value - 1) * 100);
+      } else if (r->kind == KIND_COUNT) {
+        worse = r->value > b->value;
+      } else {
+        worse = r->value != b->value;
+      }
+      status = worse ? (r->kind == KIND_CHECKSUM ? "CHANGED" : "WORSE")
+                     : "ok";
+      regressions += worse;
+    }
+    printf("%-22s %12s %-9s %12s %8s  %s\n", r->name, value, r->unit, was,
+           change, status);
+  }
+  return regressions;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [-i image] [-o out.wav] [-t seconds] [-p period]\n"
+          "       [-j out.json] [-c baseline.json] [-x percent]\n",
+          name);
+}
+
+int main(int argc, char **argv) {
+  const char *image = NULL;
+  const char *wav_path = NULL;
+  const char *json_path = NULL;
+  const char *baseline = NULL;
+  double seconds = 4.0, threshold = 25.0;
+  uint32_t period = 128;
+
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 >= argc || argv[i][0] != '-' || argv[i][1] == '\0' ||
+        argv[i][2] != '\0') {
+      usage(argv[0]);
+      return 1;
+    }
+    const char *v = argv[i + 1];
+    switch (argv[i][1]) {
+    case 'i':
+      image = v;
+      break;
+    case 'o':
+      wav_path = v;
+      break;
+    case 't':
+      seconds = atof(v);
+      break;
+    case 'p':
+      period = (uint32_t)atoi(v);
+      break;
+    case 'j':
+      json_path = v;
+      break;
+    case 'c':
+      baseline = v;
+      break;
+    case 'x':
+      threshold = atof(v);
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (period < 16 || period > 512 || seconds <= 0 || threshold < 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  /* Boot order as in main.c */
+  Sequencer_Init();
+  AudioMixer_Init();
+  AudioFx_Init(fx_ram, sizeof(fx_ram));
+  SampleCache_Init();
+
+  char scratch[64] = "";
+  if (!image) {
+    snprintf(scratch, sizeof(scratch), "/tmp/drumbench-XXXXXX");
+    int fd = mkstemp(scratch);
+    if (fd < 0) {
+      fprintf(stderr, "%s: cannot create a scratch image\n", argv[0]);
+      return 1;
+    }
+    close(fd);
+    image = scratch;
+  }
+
+  int result = 1;
+  if (Host_DiskFormat(image, IMAGE_MB) != 0 || FAT32_Init() != 0) {
+    fprintf(stderr, "%s: cannot create %s\n", argv[0], image);
+    goto out;
+  }
+  int res = populate();
+  if (res != 0) {
+    fprintf(stderr, "%s: populating %s failed (%d)\n", argv[0], image, res);
+    goto out;
+  }
+
+  printf("image %uMB, period %u frames, %.1fs of audio per run\n", IMAGE_MB,
+         period, seconds);
+  if (bench_mixer(period, seconds) != 0 || bench_sequencer(period) != 0 ||
+      bench_wav() != 0 || bench_fat() != 0 || bench_kit() != 0 ||
+      bench_pattern() != 0) {
+    fprintf(stderr, "%s: a benchmark failed\n", argv[0]);
+    goto out;
+  }
+  bench_display();
+  if (bench_song(wav_path, period, seconds) != 0) {
+    fprintf(stderr, "%s: song benchmark failed\n", argv[0]);
+    goto out;
+  }
+  /* Last: playing moves the sequencer's state on */
+  if (bench_profiler(period) != 0) {
+    fprintf(stderr, "%s: profiler benchmark failed\n", argv[0]);
+    goto out;
+  }
+  const char *slash = strrchr(argv[0], '/');
+  char tool[256];
+  snprintf(tool, sizeof(tool), "%.*s/../tools/tracedump",
+           slash ? (int)(slash - argv[0]) : 1, slash ? argv[0] : ".");
+  if (bench_trace(tool, period) != 0) {
+    fprintf(stderr, "%s: trace round trip failed (%s)\n", argv[0], tool);
+    goto out;
+  }
+  if (bench_cache() != 0) {
+    fprintf(stderr, "%s: sample cache script failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_reload() != 0) {
+    fprintf(stderr, "%s: kit reload script failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_chain(period) != 0) {
+    fprintf(stderr, "%s: song chain failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_ratchet(period) != 0) {
+    fprintf(stderr, "%s: ratchet onsets failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_prng() != 0) {
+    fprintf(stderr, "%s: probability trigs failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_live() != 0) {
+    fprintf(stderr, "%s: live recording failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_monitor(period) != 0) {
+    fprintf(stderr, "%s: render monitor failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_poly() != 0) {
+    fprintf(stderr, "%s: polymeter failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_pan(period, seconds) != 0) {
+    fprintf(stderr, "%s: pan law failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_envelope(period, seconds) != 0) {
+    fprintf(stderr, "%s: envelope failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_filter(period, seconds) != 0) {
+    fprintf(stderr, "%s: filter sweep failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_limiter(period, seconds) != 0) {
+    fprintf(stderr, "%s: limiter failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_fx(seconds) != 0) {
+    fprintf(stderr, "%s: effects failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_latency() != 0) {
+    fprintf(stderr, "%s: latency modes failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_cohere() != 0) {
+    fprintf(stderr, "%s: pattern cache coherence failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_menu() != 0) {
+    fprintf(stderr, "%s: pattern menu failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_cond() != 0) {
+    fprintf(stderr, "%s: trig conditions failed\n", argv[0]);
+    goto out;
+  }
+  if (bench_bits() != 0) {
+    fprintf(stderr, "%s: trig bitmaps failed\n", argv[0]);
+    goto out;
+  }
+
+  if (json_path && write_json(json_path, period, seconds) != 0) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], json_path);
+    goto out;
+  }
+  res = report(baseline, threshold);
+  if (res < 0) {
+    fprintf(stderr, "%s: cannot read %s\n", argv[0], baseline);
+    goto out;
+  }
+  if (res > 0) {
+    printf("%d regression%s against %s (times: +%.0f%%)\n", res,
+           res == 1 ? "" : "s", baseline, threshold);
+    result = 2;
+  } else {
+    result = 0;
+  }
+
+out:
+  Host_DiskClose();
+  if (scratch[0])
+    remove(scratch);
+  return result;
+}
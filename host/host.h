@@ -0,0 +1,165 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+/* Host build: the engine modules run on Linux against these shims in
+ * place of the peripherals. Time is simulated and only moves while audio
+ * is rendered, so every run of the same input gives the same output.
+ *
+ *   SD card     sdcard.h over a disk image file (host_sdcard.c), which
+ *               can be filled from a folder (host_import.c)
+ *   TIM2        sequencer_clock.h driven by rendered frames (host_hal.c)
+ *   SysTick     HAL_GetTick() from rendered frames (host_hal.c)
+ *   I2S + DMA   Host_Render() into a buffer, Host_Wav* to a file
+ *   SPI1        spi.h counting the display traffic (host_spi.c)
+ *   DWT         a cycle counter for profiler.h, trace.h and
+ *               audio_monitor.h, from simulated time (host_hal.c)
+ */
+
+/* Core clock the simulated cycle counter runs at (SYSCLK) */
+#define HOST_CPU_MHZ 96
+
+/**
+ * @brief Disk image statistics (since the last reset)
+ */
+typedef struct {
+  uint32_t reads;          /* Read commands (single or multi-block) */
+  uint32_t writes;         /* Write commands */
+  uint32_t blocks_read;    /* 512-byte blocks read */
+  uint32_t blocks_written; /* 512-byte blocks written */
+} HostDiskStats;
+
+/**
+ * @brief Display SPI statistics (since the last reset)
+ */
+typedef struct {
+  uint32_t writes;   /* Data register writes (8 or 16 bits) */
+  uint32_t bytes;    /* Bytes shifted out */
+  uint32_t checksum; /* FNV-1a over those bytes */
+} HostSpiStats;
+
+/**
+ * @brief Use an existing disk image as the SD card
+ * @details Superfloppy or MBR-partitioned FAT32, as on a real card.
+ * @param path Image file
+ * @return 0 on success, -1 on error
+ */
+int Host_DiskOpen(const char *path);
+
+/**
+ * @brief Create a blank FAT32 image and use it as the SD card
+ * @details No partition table, 4KB clusters, with the SAMPLES, PATTERNS,
+ *          DRUMSETS and SONGS directories the firmware expects (it cannot
+ *          create directories itself).
+ * @param path Image file (overwritten)
+ * @param megabytes Image size (16-100)
+ * @return 0 on success, -1 on error
+ */
+int Host_DiskFormat(const char *path, uint32_t megabytes);
+
+/**
+ * @brief Copy a PC folder laid out like the SD card into the open image
+ * @details Regular files with 8.3 names in its SAMPLES, PATTERNS, DRUMSETS
+ *          and SONGS folders go to the same directories of the image (kits
+ *          that point into sample subfolders find the files by name).
+ *          Anything else is skipped with a warning. Call after FAT32_Init.
+ * @param path Folder to copy
+ * @return Number of files copied, -1 on error
+ */
+int Host_DiskImport(const char *path);
+
+/**
+ * @brief Close the disk image (SDCARD_Init fails until one is opened)
+ */
+void Host_DiskClose(void);
+
+/**
+ * @brief Get disk image statistics
+ * @param stats Structure to fill
+ */
+void Host_DiskGetStats(HostDiskStats *stats);
+
+/**
+ * @brief Clear disk image statistics
+ */
+void Host_DiskResetStats(void);
+
+/**
+ * @brief Get display SPI statistics
+ * @param stats Structure to fill
+ */
+void Host_SpiGetStats(HostSpiStats *stats);
+
+/**
+ * @brief Clear display SPI statistics
+ */
+void Host_SpiResetStats(void);
+
+/**
+ * @brief Reset simulated time to zero and stop the clock
+ */
+void Host_Reset(void);
+
+/**
+ * @brief Run one TIM2 update interrupt now, without moving time
+ * @details For timing the sequencer on its own. Does nothing while the
+ *          clock is stopped.
+ */
+void Host_ClockPulse(void);
+
+/**
+ * @brief Render audio the way the DMA interrupt does
+ * @details One AudioMixer_Process call per period. Clock pulses that fell
+ *          due before a period fire before it is rendered, as TIM2 would
+ *          have interrupted while the previous buffer played.
+ * @param output Interleaved stereo, frames * 2 samples
+ * @param frames Frames to render (a multiple of period)
+ * @param period Frames per DMA buffer (AUDIO_PERIOD_FRAMES(mode))
+ */
+void Host_Render(int16_t *output, uint32_t frames, uint32_t period);
+
+/**
+ * @brief Get simulated time
+ * @return Frames rendered since Host_Reset
+ */
+uint64_t Host_GetFrames(void);
+
+/**
+ * @brief Get the simulated cycle counter (DWT_CYCCNT)
+ * @details Runs at HOST_CPU_MHZ with simulated time, plus whatever
+ *          Host_AdvanceCycles adds. Host_Reset sets it back to zero.
+ * @return Counter register, for Profiler_Init, Trace_Init and
+ *         AudioMonitor_Init
+ */
+const volatile uint32_t *Host_CycleCounter(void);
+
+/**
+ * @brief Move the cycle counter on without moving time
+ * @details For charging scripted work to the profiler or the monitor.
+ * @param cycles Cycles to add
+ */
+void Host_AdvanceCycles(uint32_t cycles);
+
+/**
+ * @brief Start a 16-bit stereo WAV file at AUDIO_SAMPLE_RATE
+ * @param path Output file (overwritten)
+ * @return 0 on success, -1 on error
+ */
+int Host_WavOpen(const char *path);
+
+/**
+ * @brief Append frames to the WAV file
+ * @param frames Interleaved stereo samples
+ * @param count Number of frames
+ * @return 0 on success, -1 on error
+ */
+int Host_WavWrite(const int16_t *frames, uint32_t count);
+
+/**
+ * @brief Fill in the WAV header sizes and close the file
+ * @return 0 on success, -1 on error
+ */
+int Host_WavClose(void);
+
+#endif
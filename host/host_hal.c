@@ -0,0 +1,162 @@
+/*
+ * Simulated time for the host build: TIM2 (sequencer_clock.h), SysTick
+ * (HAL_GetTick), the DWT cycle counter and the audio DMA interrupt
+ * (Host_Render, with the profiler, monitor and trace hooks of dma.c).
+ */
+#include "audio_mixer.h"
+#include "audio_monitor.h"
+#include "host.h"
+#include "profiler.h"
+#include "sequencer_clock.h"
+#include "trace.h"
+#include <stddef.h>
+
+/* Time in 1/AUDIO_SAMPLE_RATE microseconds: whole frames and whole timer
+ * ticks (1MHz, as TIM2 runs) are both exact */
+#define UNITS_PER_FRAME 1000000ULL
+#define UNITS_PER_TICK ((uint64_t)AUDIO_SAMPLE_RATE)
+#define UNITS_PER_MS (1000 * UNITS_PER_TICK)
+
+#define TIMER_FREQ 1000000UL
+
+static uint64_t now = 0;      /* Start of the next period to render */
+static uint64_t frames_done = 0;
+
+/* DWT_CYCCNT: simulated time at HOST_CPU_MHZ, plus scripted cycles */
+static volatile uint32_t cycle_count = 0;
+static uint32_t extra_cycles = 0;
+
+/* Clock state */
+static uint16_t current_bpm = 120;
+static uint8_t clock_running = 0;
+static uint8_t current_pulse = 0;
+static ClockCallback clock_callback = NULL;
+static uint32_t period_ticks = 0; /* Pulse length, timer ticks (ARR + 1) */
+static uint64_t pulse_start = 0;  /* When the running pulse began */
+
+/**
+ * @brief Calculate timer period for given BPM (as sequencer_clock.c)
+ */
+static uint32_t calculate_period(uint16_t bpm) {
+  return (TIMER_FREQ * 60) / (bpm * 24);
+}
+
+void Clock_Init(void) {
+  clock_running = 0;
+  current_pulse = 0;
+  period_ticks = calculate_period(current_bpm);
+}
+
+void Clock_SetBPM(uint16_t bpm) {
+  if (bpm < 40)
+    bpm = 40;
+  if (bpm > 300)
+    bpm = 300;
+
+  /* ARR is preloaded: the running pulse keeps its length */
+  current_bpm = bpm;
+}
+
+uint16_t Clock_GetBPM(void) { return current_bpm; }
+
+void Clock_Start(void) {
+  clock_running = 1;
+  current_pulse = 0;
+  period_ticks = calculate_period(current_bpm);
+  pulse_start = now;
+}
+
+void Clock_Stop(void) {
+  clock_running = 0;
+  current_pulse = 0;
+}
+
+uint8_t Clock_IsRunning(void) { return clock_running; }
+
+uint8_t Clock_GetPulse(void) { return current_pulse; }
+
+uint8_t Clock_GetPulsePhase(void) {
+  uint64_t length = period_ticks * UNITS_PER_TICK;
+  if (now - pulse_start >= length)
+    return 255;
+  return (uint8_t)((now - pulse_start) * 256 / length);
+}
+
+void Clock_SetCallback(ClockCallback callback) { clock_callback = callback; }
+
+uint32_t HAL_GetTick(void) { return (uint32_t)(now / UNITS_PER_MS); }
+
+void Host_ClockPulse(void) {
+  if (!clock_running)
+    return;
+
+  PROFILE_ENTER(PROF_CLOCK);
+  TRACE(TRACE_CLOCK, current_pulse, 0);
+  if (clock_callback) {
+    clock_callback(current_pulse);
+  }
+
+  current_pulse++;
+  if (current_pulse >= 24) {
+    current_pulse = 0;
+  }
+  PROFILE_EXIT();
+}
+
+/**
+ * @brief Bring the cycle counter up to now
+ */
+static void update_cycles(void) {
+  cycle_count = (uint32_t)(now * HOST_CPU_MHZ / UNITS_PER_TICK) + extra_cycles;
+}
+
+/**
+ * @brief Run the TIM2 update interrupts that fell due by now
+ */
+static void run_clock(void) {
+  while (clock_running &&
+         now - pulse_start >= period_ticks * UNITS_PER_TICK) {
+    pulse_start += period_ticks * UNITS_PER_TICK;
+    period_ticks = calculate_period(current_bpm); /* Preload takes effect */
+    Host_ClockPulse();
+  }
+}
+
+void Host_Reset(void) {
+  now = 0;
+  frames_done = 0;
+  extra_cycles = 0;
+  update_cycles();
+  Clock_Stop();
+}
+
+void Host_Render(int16_t *output, uint32_t frames, uint32_t period) {
+  /* Latency mode for the trace, as dma.c records it (64 << mode frames) */
+  uint8_t mode = 0;
+  while (mode < 3 && (64u << mode) < period)
+    mode++;
+
+  for (uint32_t done = 0; done + period <= frames; done += period) {
+    run_clock();
+    PROFILE_ENTER(PROF_AUDIO);
+    AudioMonitor_Begin();
+    TRACE(TRACE_RENDER_BEGIN, mode, 0);
+    AudioMixer_Process(output + done * 2, period);
+    /* Never late: the other buffer has all of its frames left */
+    AudioMonitor_End(period, period, 0);
+    TRACE(TRACE_RENDER_END, 0, (period > 1020) ? 255 : period / 4);
+    PROFILE_EXIT();
+    now += period * UNITS_PER_FRAME;
+    frames_done += period;
+    update_cycles();
+  }
+}
+
+uint64_t Host_GetFrames(void) { return frames_done; }
+
+const volatile uint32_t *Host_CycleCounter(void) { return &cycle_count; }
+
+void Host_AdvanceCycles(uint32_t cycles) {
+  extra_cycles += cycles;
+  update_cycles();
+}
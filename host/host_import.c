@@ -0,0 +1,138 @@
+/*
+ * Fill the host disk image from a folder on the PC.
+ */
+#include "fat32.h"
+#include "host.h"
+#include "sdcard.h"
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#define IMPORT_MAX_SIZE (16UL * 1024 * 1024)
+
+static const char *const import_dirs[] = {"SAMPLES", "PATTERNS", "DRUMSETS",
+                                          "SONGS"};
+#define IMPORT_DIRS (sizeof(import_dirs) / sizeof(import_dirs[0]))
+
+/**
+ * @brief Upper-case an 8.3 name
+ * @return 0 if it fits 8.3, -1 otherwise
+ */
+static int short_name(const char *name, char *out) {
+  const char *dot = strrchr(name, '.');
+  size_t base = dot ? (size_t)(dot - name) : strlen(name);
+  size_t ext = dot ? strlen(dot + 1) : 0;
+
+  if (base < 1 || base > 8 || ext > 3 || (dot && ext == 0))
+    return -1;
+  for (size_t i = 0; name[i]; i++) {
+    unsigned char c = (unsigned char)name[i];
+    if (&name[i] == dot)
+      continue;
+    if (!isalnum(c) && !strchr("_-~!#$%&'()@^{}", c))
+      return -1;
+    out[i] = (char)toupper(c);
+  }
+  out[base + (dot ? ext + 1 : 0)] = '\0';
+  if (dot)
+    out[base] = '.';
+  return 0;
+}
+
+/**
+ * @brief Copy one file into a directory of the image
+ * @return 0 on success, negative on error
+ */
+static int import_file(const char *path, uint32_t dir_cluster,
+                       const char *name, uint32_t size) {
+  uint8_t block[512];
+  uint32_t sector;
+
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return -1;
+
+  int result = FAT32_CreateContiguous(dir_cluster, name, size, &sector);
+  for (uint32_t offset = 0; result == 0 && offset < size; offset += 512) {
+    memset(block, 0, sizeof(block));
+    size_t want = (size - offset < 512) ? size - offset : 512;
+    if (fread(block, 1, want, f) != want ||
+        SDCARD_WriteBlock(sector + offset / 512, block) != SDCARD_OK)
+      result = -2;
+  }
+  fclose(f);
+  return result;
+}
+
+int Host_DiskImport(const char *path) {
+  DIR *top = opendir(path);
+  if (!top)
+    return -1;
+
+  int copied = 0;
+  struct dirent *d;
+  while ((d = readdir(top)) != NULL) {
+    if (d->d_name[0] == '.')
+      continue;
+
+    char sub_path[4096];
+    struct stat st;
+    snprintf(sub_path, sizeof(sub_path), "%s/%s", path, d->d_name);
+    if (stat(sub_path, &st) != 0 || !S_ISDIR(st.st_mode))
+      continue;
+
+    uint32_t cluster = 0;
+    for (size_t i = 0; i < IMPORT_DIRS; i++) {
+      if (strcasecmp(d->d_name, import_dirs[i]) == 0)
+        cluster = FAT32_FindDir(FAT32_GetRootCluster(), import_dirs[i]);
+    }
+    if (cluster == 0) {
+      fprintf(stderr, "import: skipping folder %s\n", sub_path);
+      continue;
+    }
+
+    DIR *dir = opendir(sub_path);
+    if (!dir)
+      continue;
+    int in_dir = 0;
+    struct dirent *f;
+    while ((f = readdir(dir)) != NULL) {
+      char file_path[8192];
+      char name[FAT32_FILENAME_LEN];
+      if (f->d_name[0] == '.')
+        continue;
+      snprintf(file_path, sizeof(file_path), "%s/%s", sub_path, f->d_name);
+      if (stat(file_path, &st) != 0)
+        continue;
+      if (S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "import: skipping folder %s\n", file_path);
+        continue;
+      }
+      if (!S_ISREG(st.st_mode) || st.st_size > (off_t)IMPORT_MAX_SIZE ||
+          short_name(f->d_name, name) != 0) {
+        fprintf(stderr, "import: skipping %s (not an 8.3 file)\n",
+                file_path);
+        continue;
+      }
+      if (import_file(file_path, cluster, name, (uint32_t)st.st_size) != 0) {
+        fprintf(stderr, "import: cannot copy %s\n", file_path);
+        closedir(dir);
+        closedir(top);
+        return -1;
+      }
+      copied++;
+      if (++in_dir == FAT32_MAX_FILES + 1)
+        fprintf(stderr, "import: %s has more than %d files, the firmware "
+                        "lists only the first %d\n",
+                sub_path, FAT32_MAX_FILES, FAT32_MAX_FILES);
+    }
+    closedir(dir);
+  }
+
+  closedir(top);
+  return copied;
+}
@@ -0,0 +1,208 @@
+/*
+ * SD card for the host build: sdcard.h over a disk image file.
+ */
+#include "host.h"
+#include "sdcard.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BLOCK_SIZE 512
+
+/* Layout written by Host_DiskFormat */
+#define FMT_SEC_PER_CLUS 8
+#define FMT_RESERVED 32
+#define FMT_NUM_FATS 2
+#define FMT_ROOT_CLUSTER 2
+
+static const char *const fmt_dirs[] = {"SAMPLES", "PATTERNS", "DRUMSETS",
+                                       "SONGS"};
+#define FMT_DIRS (sizeof(fmt_dirs) / sizeof(fmt_dirs[0]))
+
+static FILE *disk = NULL;
+static uint32_t disk_blocks = 0;
+static HostDiskStats disk_stats;
+
+static void put_u16(uint8_t *buf, uint32_t offset, uint16_t value) {
+  buf[offset] = value & 0xFF;
+  buf[offset + 1] = (value >> 8) & 0xFF;
+}
+
+static void put_u32(uint8_t *buf, uint32_t offset, uint32_t value) {
+  put_u16(buf, offset, value & 0xFFFF);
+  put_u16(buf, offset + 2, value >> 16);
+}
+
+static int disk_write(uint32_t block, const uint8_t *data) {
+  if (fseek(disk, (long)block * BLOCK_SIZE, SEEK_SET) != 0 ||
+      fwrite(data, BLOCK_SIZE, 1, disk) != 1)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Fill a directory entry (8.3 name, space padded)
+ */
+static void dir_entry(uint8_t *entry, const char *name, uint8_t attr,
+                      uint32_t cluster) {
+  memset(entry, ' ', 11);
+  memcpy(entry, name, strlen(name));
+  entry[11] = attr;
+  put_u16(entry, 20, cluster >> 16);
+  put_u16(entry, 26, cluster & 0xFFFF);
+}
+
+int Host_DiskOpen(const char *path) {
+  Host_DiskClose();
+
+  disk = fopen(path, "r+b");
+  if (!disk)
+    return -1;
+
+  fseek(disk, 0, SEEK_END);
+  long size = ftell(disk);
+  if (size < BLOCK_SIZE) {
+    Host_DiskClose();
+    return -1;
+  }
+  disk_blocks = (uint32_t)(size / BLOCK_SIZE);
+  Host_DiskResetStats();
+  return 0;
+}
+
+int Host_DiskFormat(const char *path, uint32_t megabytes) {
+  if (megabytes < 16 || megabytes > 100)
+    return -1;
+
+  Host_DiskClose();
+  disk = fopen(path, "w+b");
+  if (!disk)
+    return -1;
+
+  uint32_t total = megabytes * 2048;
+  /* FAT entries for every cluster (a slight overestimate) */
+  uint32_t clusters = (total - FMT_RESERVED) / FMT_SEC_PER_CLUS;
+  uint32_t fat_size = (clusters + 2) * 4 / BLOCK_SIZE + 1;
+  uint32_t data_start = FMT_RESERVED + FMT_NUM_FATS * fat_size;
+  clusters = (total - data_start) / FMT_SEC_PER_CLUS;
+
+  uint8_t block[BLOCK_SIZE];
+  int result = 0;
+
+  /* Boot sector (and its backup) */
+  memset(block, 0, sizeof(block));
+  memcpy(block, "\xEB\x58\x90" "DRUMHOST", 11);
+  put_u16(block, 11, BLOCK_SIZE);
+  block[13] = FMT_SEC_PER_CLUS;
+  put_u16(block, 14, FMT_RESERVED);
+  block[16] = FMT_NUM_FATS;
+  block[21] = 0xF8; /* Fixed disk */
+  put_u16(block, 24, 32);
+  put_u16(block, 26, 64);
+  put_u32(block, 32, total);
+  put_u32(block, 36, fat_size);
+  put_u32(block, 44, FMT_ROOT_CLUSTER);
+  put_u16(block, 48, 1); /* FSInfo */
+  put_u16(block, 50, 6); /* Backup boot sector */
+  block[64] = 0x80;
+  block[66] = 0x29;
+  put_u32(block, 67, 0x44524D31);
+  memcpy(block + 71, "DRUMMODULE FAT32   ", 19);
+  block[510] = 0x55;
+  block[511] = 0xAA;
+  result |= disk_write(0, block);
+  result |= disk_write(6, block);
+
+  /* FSInfo: free count and next free unknown */
+  memset(block, 0, sizeof(block));
+  put_u32(block, 0, 0x41615252);
+  put_u32(block, 484, 0x61417272);
+  put_u32(block, 488, 0xFFFFFFFF);
+  put_u32(block, 492, 0xFFFFFFFF);
+  put_u32(block, 508, 0xAA550000);
+  result |= disk_write(1, block);
+
+  /* FAT: media, reserved, then root and each directory, one cluster each */
+  memset(block, 0, sizeof(block));
+  put_u32(block, 0, 0x0FFFFFF8);
+  put_u32(block, 4, 0x0FFFFFFF);
+  for (uint32_t c = 0; c <= FMT_DIRS; c++)
+    put_u32(block, (FMT_ROOT_CLUSTER + c) * 4, 0x0FFFFFFF);
+  for (uint32_t f = 0; f < FMT_NUM_FATS; f++) {
+    result |= disk_write(FMT_RESERVED + f * fat_size, block);
+  }
+  memset(block, 0, sizeof(block));
+  for (uint32_t f = 0; f < FMT_NUM_FATS; f++) {
+    for (uint32_t s = 1; s < fat_size; s++)
+      result |= disk_write(FMT_RESERVED + f * fat_size + s, block);
+  }
+
+  /* Directory clusters: root lists the others, each holds "." and ".." */
+  for (uint32_t c = 0; c <= FMT_DIRS; c++) {
+    uint32_t first = data_start + c * FMT_SEC_PER_CLUS;
+    memset(block, 0, sizeof(block));
+    if (c == 0) {
+      for (uint32_t d = 0; d < FMT_DIRS; d++)
+        dir_entry(block + d * 32, fmt_dirs[d], 0x10,
+                  FMT_ROOT_CLUSTER + 1 + d);
+    } else {
+      dir_entry(block, ".", 0x10, FMT_ROOT_CLUSTER + c);
+      dir_entry(block + 32, "..", 0x10, 0); /* Parent is the root */
+    }
+    result |= disk_write(first, block);
+    memset(block, 0, sizeof(block));
+    for (uint32_t s = 1; s < FMT_SEC_PER_CLUS; s++)
+      result |= disk_write(first + s, block);
+  }
+
+  /* Size the file; the data area stays sparse */
+  result |= disk_write(total - 1, block);
+  if (result != 0 || fflush(disk) != 0) {
+    Host_DiskClose();
+    return -1;
+  }
+
+  disk_blocks = total;
+  Host_DiskResetStats();
+  return 0;
+}
+
+void Host_DiskClose(void) {
+  if (disk)
+    fclose(disk);
+  disk = NULL;
+  disk_blocks = 0;
+}
+
+void Host_DiskGetStats(HostDiskStats *stats) { *stats = disk_stats; }
+
+void Host_DiskResetStats(void) { memset(&disk_stats, 0, sizeof(disk_stats)); }
+
+int SDCARD_Init(void) { return disk ? SDCARD_OK : SDCARD_ERROR_INIT; }
+
+int SDCARD_ReadMultiBlock(uint32_t block_addr, uint32_t count,
+                          uint8_t *buffer) {
+  if (!disk || count == 0 || block_addr >= disk_blocks ||
+      count > disk_blocks - block_addr)
+    return SDCARD_ERROR_READ;
+
+  if (fseek(disk, (long)block_addr * BLOCK_SIZE, SEEK_SET) != 0 ||
+      fread(buffer, BLOCK_SIZE, count, disk) != count)
+    return SDCARD_ERROR_READ;
+
+  disk_stats.reads++;
+  disk_stats.blocks_read += count;
+  return SDCARD_OK;
+}
+
+int SDCARD_ReadBlock(uint32_t block_addr, uint8_t *buffer) {
+  return SDCARD_ReadMultiBlock(block_addr, 1, buffer);
+}
+
+int SDCARD_WriteBlock(uint32_t block_addr, const uint8_t *buffer) {
+  if (!disk || block_addr >= disk_blocks || disk_write(block_addr, buffer))
+    return SDCARD_ERROR_WRITE;
+
+  disk_stats.writes++;
+  disk_stats.blocks_written++;
+  return SDCARD_OK;
+}
@@ -0,0 +1,51 @@
+/*
+ * Display SPI for the host build: spi.h counting what would go out.
+ */
+#include "host.h"
+#include "spi.h"
+#include <string.h>
+
+/* GPIOA as st7789.c sees it in the host build */
+volatile uint32_t host_gpioa_moder = 0;
+volatile uint32_t host_gpioa_bsrr = 0;
+
+static HostSpiStats spi_stats;
+
+/**
+ * @brief Count one byte (FNV-1a over the stream)
+ */
+static void put_byte(uint8_t data) {
+  spi_stats.bytes++;
+  spi_stats.checksum = (spi_stats.checksum ^ data) * 16777619u;
+}
+
+void SPI_Init(void) { Host_SpiResetStats(); }
+
+void SPI_Transmit(uint8_t data) {
+  spi_stats.writes++;
+  put_byte(data);
+}
+
+void SPI_WriteData8(uint8_t data) {
+  spi_stats.writes++;
+  put_byte(data);
+}
+
+void SPI_WriteData16(uint16_t data) {
+  spi_stats.writes++;
+  put_byte((uint8_t)(data >> 8)); /* MSB first, as SPI1 shifts it */
+  put_byte((uint8_t)data);
+}
+
+void SPI_SetDataSize16(void) {}
+
+void SPI_SetDataSize8(void) {}
+
+void SPI_WaitBusy(void) {}
+
+void Host_SpiGetStats(HostSpiStats *stats) { *stats = spi_stats; }
+
+void Host_SpiResetStats(void) {
+  memset(&spi_stats, 0, sizeof(spi_stats));
+  spi_stats.checksum = 2166136261u;
+}
@@ -0,0 +1,87 @@
+/*
+ * I2S output for the host build: 16-bit stereo WAV files.
+ */
+#include "audio_mixer.h"
+#include "host.h"
+#include <stdio.h>
+
+#define WAV_HEADER_SIZE 44
+
+static FILE *wav = NULL;
+static uint32_t wav_frames = 0;
+
+static void put_u16(uint8_t *buf, uint32_t offset, uint16_t value) {
+  buf[offset] = value & 0xFF;
+  buf[offset + 1] = (value >> 8) & 0xFF;
+}
+
+static void put_u32(uint8_t *buf, uint32_t offset, uint32_t value) {
+  put_u16(buf, offset, value & 0xFFFF);
+  put_u16(buf, offset + 2, value >> 16);
+}
+
+/**
+ * @brief Write the RIFF header for the frames written so far
+ */
+static int write_header(void) {
+  uint8_t h[WAV_HEADER_SIZE] = "RIFF\0\0\0\0WAVEfmt ";
+  uint32_t data_size = wav_frames * 4;
+
+  put_u32(h, 4, 36 + data_size);
+  put_u32(h, 16, 16);
+  put_u16(h, 20, 1); /* PCM */
+  put_u16(h, 22, 2);
+  put_u32(h, 24, AUDIO_SAMPLE_RATE);
+  put_u32(h, 28, AUDIO_SAMPLE_RATE * 4);
+  put_u16(h, 32, 4);
+  put_u16(h, 34, 16);
+  h[36] = 'd';
+  h[37] = 'a';
+  h[38] = 't';
+  h[39] = 'a';
+  put_u32(h, 40, data_size);
+
+  if (fseek(wav, 0, SEEK_SET) != 0 || fwrite(h, sizeof(h), 1, wav) != 1)
+    return -1;
+  return fseek(wav, 0, SEEK_END) == 0 ? 0 : -1;
+}
+
+int Host_WavOpen(const char *path) {
+  if (wav)
+    Host_WavClose();
+
+  wav = fopen(path, "wb");
+  if (!wav)
+    return -1;
+  wav_frames = 0;
+  return write_header();
+}
+
+int Host_WavWrite(const int16_t *frames, uint32_t count) {
+  uint8_t buf[256 * 4];
+
+  if (!wav)
+    return -1;
+  while (count > 0) {
+    uint32_t n = (count > 256) ? 256 : count;
+    for (uint32_t i = 0; i < n * 2; i++)
+      put_u16(buf, i * 2, (uint16_t)frames[i]);
+    if (fwrite(buf, 4, n, wav) != n)
+      return -1;
+    frames += n * 2;
+    count -= n;
+    wav_frames += n;
+  }
+  return 0;
+}
+
+int Host_WavClose(void) {
+  if (!wav)
+    return -1;
+
+  int result = write_header();
+  if (fclose(wav) != 0)
+    result = -1;
+  wav = NULL;
+  return result;
+}
@@ -0,0 +1,287 @@
+/*
+ * drumrender - render a kit and patterns to a WAV file, offline
+ *
+ * Usage: drumrender [-k kit] [-p chain | -s song] [-t seconds | -l loops]
+ *                   [-B bpm] [-b period] [-r tail] [-o out.wav]
+ *                   <image | folder>
+ *
+ * Plays the card the way the module does - the same kit loader, pattern
+ * bank, song engine, sequencer and mixer - with the clock following the
+ * rendered audio instead of TIM2, so it runs as fast as the host allows.
+ * A folder laid out like the card (SAMPLES, PATTERNS, DRUMSETS, SONGS) is
+ * copied into a scratch image first; an image is used read-write, as the
+ * module would (the pattern bank may be created on first use).
+ *
+ *   -k kit      Kit slot (default 1)
+ *   -p chain    Pattern slots played in turn, each optionally repeated:
+ *               "1,2x4,3" (default 1)
+ *   -s song     Song slot (SONGS/SONG-XXX.SNG), kit changes included
+ *   -t seconds  Length; default is one pass of the chain or song, ending
+ *               at the first buffer after its last loop
+ *   -l loops    Length in pattern loops
+ *   -B bpm      Tempo (default: the first pattern's)
+ *   -b period   Frames per render, as the DMA buffer (default 128)
+ *   -r tail     Seconds to keep rendering after the sequencer stops
+ *   -o out.wav  Output (default render.wav)
+ *
+ * Render throughput goes to stderr. The output depends only on the input,
+ * so it can be compared bit for bit across mixer changes.
+ */
+#include "audio_fx.h"
+#include "audio_mixer.h"
+#include "fat32.h"
+#include "host.h"
+#include "pattern_manager.h"
+#include "sample_cache.h"
+#include "sequencer.h"
+#include "song.h"
+#include "wav_loader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SCRATCH_MB 64
+
+static uint32_t fx_ram[16384 / 4];
+static int16_t output[512 * 2];
+static Drumset drumset;
+static SongEntry chain[SONG_MAX_ENTRIES];
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [-k kit] [-p chain | -s song] [-t seconds | -l loops]\n"
+          "       [-B bpm] [-b period] [-r tail] [-o out.wav] "
+          "<image | folder>\n",
+          name);
+}
+
+/**
+ * @brief Parse "1,2x4,3" into chain entries
+ * @return Number of entries, -1 on a malformed chain
+ */
+static int parse_chain(const char *text, uint32_t *loops) {
+  int count = 0;
+
+  *loops = 0;
+  while (*text && count < SONG_MAX_ENTRIES) {
+    char *end;
+    long slot = strtol(text, &end, 10);
+    long repeats = 1;
+    if (end == text || slot < 1 || slot > 100)
+      return -1;
+    if (*end == 'x') {
+      text = end + 1;
+      repeats = strtol(text, &end, 10);
+      if (end == text || repeats < 1 || repeats > 255)
+        return -1;
+    }
+    if (*end != ',' && *end != '\0')
+      return -1;
+
+    chain[count].pattern_slot = (uint8_t)slot;
+    chain[count].repeats = (uint8_t)repeats;
+    chain[count].kit_slot = 0;
+    *loops += (uint32_t)repeats;
+    count++;
+    text = (*end == ',') ? end + 1 : end;
+  }
+  return (*text == '\0' && count > 0) ? count : -1;
+}
+
+/**
+ * @brief Open the card: an image as is, or a folder copied into a scratch
+ * @return 0 on success, -1 on error
+ */
+static int open_card(const char *path, char *scratch, size_t scratch_len) {
+  struct stat st;
+
+  scratch[0] = '\0';
+  if (stat(path, &st) != 0)
+    return -1;
+  if (!S_ISDIR(st.st_mode))
+    return (Host_DiskOpen(path) == 0 && FAT32_Init() == 0) ? 0 : -1;
+
+  snprintf(scratch, scratch_len, "/tmp/drumrender-XXXXXX");
+  int fd = mkstemp(scratch);
+  if (fd < 0)
+    return -1;
+  close(fd);
+
+  if (Host_DiskFormat(scratch, SCRATCH_MB) != 0 || FAT32_Init() != 0 ||
+      Host_DiskImport(path) < 0)
+    return -1;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *wav_path = "render.wav";
+  const char *chain_text = "1";
+  int kit_slot = 1, song_slot = 0, bpm = 0;
+  uint32_t period = 128, loops = 0;
+  double seconds = 0, tail = 0;
+
+  int i;
+  for (i = 1; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i += 2) {
+    if (i + 1 >= argc || argv[i][2] != '\0') {
+      usage(argv[0]);
+      return 1;
+    }
+    const char *v = argv[i + 1];
+    switch (argv[i][1]) {
+    case 'k':
+      kit_slot = atoi(v);
+      break;
+    case 'p':
+      chain_text = v;
+      break;
+    case 's':
+      song_slot = atoi(v);
+      break;
+    case 't':
+      seconds = atof(v);
+      break;
+    case 'l':
+      loops = (uint32_t)atol(v);
+      break;
+    case 'B':
+      bpm = atoi(v);
+      break;
+    case 'b':
+      period = (uint32_t)atoi(v);
+      break;
+    case 'r':
+      tail = atof(v);
+      break;
+    case 'o':
+      wav_path = v;
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (i != argc - 1 || kit_slot < 1 || kit_slot > 100 || song_slot < 0 ||
+      song_slot > 100 || period < 16 || period > 512 || seconds < 0 ||
+      tail < 0 || (bpm != 0 && (bpm < 40 || bpm > 300))) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  uint32_t chain_loops = 0;
+  int entries = song_slot ? 0 : parse_chain(chain_text, &chain_loops);
+  if (entries < 0) {
+    fprintf(stderr, "%s: bad pattern chain \"%s\"\n", argv[0], chain_text);
+    return 1;
+  }
+
+  /* Boot order as in main.c */
+  Sequencer_Init();
+  AudioMixer_Init();
+  AudioFx_Init(fx_ram, sizeof(fx_ram));
+  SampleCache_Init();
+
+  char scratch[64];
+  if (open_card(argv[i], scratch, sizeof(scratch)) != 0) {
+    fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[i]);
+    if (scratch[0])
+      remove(scratch);
+    return 1;
+  }
+
+  int result = 1;
+  memset(&drumset, 0, sizeof(drumset));
+  if (Drumset_LoadFromSlot(&drumset, (uint8_t)kit_slot) != 0) {
+    fprintf(stderr, "%s: no kit in slot %d\n", argv[0], kit_slot);
+    goto out;
+  }
+
+  entries = song_slot ? Song_Load((uint8_t)song_slot)
+                      : Song_SetChain(chain, (uint8_t)entries);
+  if (entries < 0 || Song_Start(&drumset) != 0) {
+    fprintf(stderr, "%s: cannot load the %s\n", argv[0],
+            song_slot ? "song" : "first pattern");
+    goto out;
+  }
+
+  /* The sequencer keeps its tempo across patterns: start at the first's */
+  Pattern first;
+  if (!bpm && Pattern_Load(&first, Song_GetPatternSlot()) == 0)
+    bpm = first.bpm;
+  if (bpm)
+    Sequencer_SetBPM((uint16_t)bpm);
+
+  /* Length: frames, loops, or one pass of the chain */
+  uint32_t frames = (uint32_t)(seconds * AUDIO_SAMPLE_RATE);
+  uint8_t one_pass = (frames == 0 && loops == 0);
+  if (Host_WavOpen(wav_path) != 0) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], wav_path);
+    goto out;
+  }
+
+  Host_Reset();
+  Sequencer_Start();
+  uint32_t start_loop = Sequencer_GetLoopCount();
+  uint32_t tail_frames = (uint32_t)(tail * AUDIO_SAMPLE_RATE);
+  uint32_t stopped_at = 0, played = 0;
+  double t = now_s();
+
+  while (1) {
+    Host_Render(output, period, period);
+    if (Host_WavWrite(output, period) != 0) {
+      fprintf(stderr, "%s: cannot write %s\n", argv[0], wav_path);
+      Host_WavClose();
+      goto out;
+    }
+    uint32_t done = (uint32_t)Host_GetFrames();
+
+    /* Main loop work between buffers */
+    Pattern_CachePoll();
+    uint8_t events = Song_Poll();
+
+    if (Sequencer_IsPlaying()) {
+      played = Sequencer_GetLoopCount() - start_loop;
+      if ((frames && done >= frames) || (loops && played >= loops) ||
+          (one_pass && (events & SONG_EVENT_PATTERN) &&
+           Song_GetPosition() == 0) ||
+          (one_pass && !song_slot && played >= chain_loops)) {
+        Song_Stop();
+        Sequencer_Stop();
+        stopped_at = done;
+      }
+    }
+    if (!Sequencer_IsPlaying() && done >= stopped_at + tail_frames)
+      break;
+  }
+  t = now_s() - t;
+
+  uint32_t total = (uint32_t)Host_GetFrames();
+  if (Host_WavClose() != 0) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], wav_path);
+    goto out;
+  }
+
+  SongStats song;
+  Song_GetStats(&song);
+  fprintf(stderr,
+          "%s: %.3fs (%u frames, %u loops, %u transitions) in %.1fms: "
+          "%.2fM frames/s, %.0fx real time\n",
+          wav_path, (double)total / AUDIO_SAMPLE_RATE, total, played,
+          song.transitions, t * 1e3, total / t / 1e6,
+          total / t / AUDIO_SAMPLE_RATE);
+  result = 0;
+
+out:
+  Host_DiskClose();
+  if (scratch[0])
+    remove(scratch);
+  return result;
+}
@@ -0,0 +1,98 @@
+#include "live_record.h"
+#include "audio_mixer.h"
+#include "sequencer.h"
+#include "trace.h"
+
+/* Hits waiting for the main loop (input interrupt -> LiveRecord_Poll) */
+#define RECORD_QUEUE_SIZE 16 /* Power of two */
+typedef struct {
+  uint8_t channel;
+  uint8_t step;
+  uint8_t velocity;
+} RecordEvent;
+static RecordEvent record_queue[RECORD_QUEUE_SIZE];
+static volatile uint8_t record_head = 0; /* Written by LiveRecord_Hit only */
+static volatile uint8_t record_tail = 0; /* Written by LiveRecord_Poll only */
+
+/* Settings */
+static volatile uint8_t record_mode = LIVE_RECORD_OFF;
+static volatile uint8_t quantize = 100;
+
+/* Tracks already cleared in this REPLACE take */
+static uint8_t replaced_mask = 0;
+static volatile uint8_t take_restart = 0;
+
+void LiveRecord_SetMode(uint8_t mode) {
+  if (mode > LIVE_RECORD_REPLACE)
+    return;
+  record_mode = mode;
+  take_restart = 1;
+}
+
+uint8_t LiveRecord_GetMode(void) { return record_mode; }
+
+void LiveRecord_SetQuantize(uint8_t percent) {
+  quantize = (percent > 100) ? 100 : percent;
+}
+
+uint8_t LiveRecord_GetQuantize(void) { return quantize; }
+
+void LiveRecord_Hit(uint8_t channel, uint8_t velocity) {
+  if (channel >= NUM_CHANNELS || velocity == 0)
+    return;
+
+  /* Sound first: the mixer starts it on its next block */
+  TRACE(TRACE_PAD, channel, velocity);
+  AudioMixer_PostTrigger(channel, velocity);
+
+  if (record_mode == LIVE_RECORD_OFF || !Sequencer_IsPlaying())
+    return;
+
+  uint8_t head = record_head;
+  if ((uint8_t)(head - record_tail) >= RECORD_QUEUE_SIZE)
+    return;
+
+  /* Late in the step: move the hit to the step ahead, which must not
+   * trigger again when the playhead gets there */
+  uint8_t step = Sequencer_GetTrackStep(channel);
+  uint16_t threshold = 256 - (uint16_t)quantize * 128 / 100;
+  if (Sequencer_GetTrackPhase(channel) >= threshold) {
+    step++;
+    if (step >= Sequencer_GetTrackLength(channel))
+      step = 0;
+    Sequencer_SkipTrig(channel, step);
+  }
+
+  RecordEvent *e = &record_queue[head & (RECORD_QUEUE_SIZE - 1)];
+  e->channel = channel;
+  e->step = step;
+  e->velocity = velocity;
+  __asm volatile("" : : : "memory"); /* Entry before index */
+  record_head = head + 1;
+}
+
+uint8_t LiveRecord_Poll(void) {
+  if (take_restart) {
+    take_restart = 0;
+    replaced_mask = 0;
+  }
+
+  uint8_t written = 0;
+  uint8_t tail = record_tail;
+  while (tail != record_head) {
+    RecordEvent *e = &record_queue[tail & (RECORD_QUEUE_SIZE - 1)];
+
+    if (record_mode == LIVE_RECORD_REPLACE &&
+        !(replaced_mask & (1 << e->channel))) {
+      for (uint8_t step = 0; step < MAX_STEPS; step++)
+        Sequencer_SetStep(e->channel, step, 0);
+      replaced_mask |= (uint8_t)(1 << e->channel);
+    }
+    Sequencer_SetStep(e->channel, e->step, e->velocity);
+
+    written++;
+    tail++;
+  }
+  record_tail = tail;
+  return written;
+}
@@ -0,0 +1,56 @@
+#ifndef LIVE_RECORD_H
+#define LIVE_RECORD_H
+
+#include <stdint.h>
+
+/* Record modes */
+#define LIVE_RECORD_OFF 0     /* Pads only play */
+#define LIVE_RECORD_OVERDUB 1 /* Hits are added to the pattern */
+#define LIVE_RECORD_REPLACE 2 /* First hit on a track clears it, then adds */
+
+/**
+ * @brief Set record mode
+ * @details Starting a new take (any mode change) re-arms REPLACE clearing.
+ * @param mode LIVE_RECORD_* mode
+ */
+void LiveRecord_SetMode(uint8_t mode);
+
+/**
+ * @brief Get record mode
+ * @return LIVE_RECORD_* mode
+ */
+uint8_t LiveRecord_GetMode(void);
+
+/**
+ * @brief Set quantize strength
+ * @details Decides how early a hit may be and still land on the step
+ *          ahead: 100 = nearest step, 50 = last quarter of a step,
+ *          0 = always the step being played.
+ * @param percent Strength (0-100)
+ */
+void LiveRecord_SetQuantize(uint8_t percent);
+
+/**
+ * @brief Get quantize strength
+ * @return Strength (0-100)
+ */
+uint8_t LiveRecord_GetQuantize(void);
+
+/**
+ * @brief Play a hit and record it if armed
+ * @details Called from the input interrupt, which must run at the clock
+ *          interrupt's priority. The sound goes straight to the mixer
+ *          queue; the step write is left to LiveRecord_Poll().
+ * @param channel Channel (0-5)
+ * @param velocity Velocity (1-255)
+ */
+void LiveRecord_Hit(uint8_t channel, uint8_t velocity);
+
+/**
+ * @brief Write recorded hits into the pattern
+ * @details Call from the main loop.
+ * @return Number of steps written
+ */
+uint8_t LiveRecord_Poll(void);
+
+#endif
@@ -1,13 +1,21 @@
+#include "audio_fx.h"
 #include "audio_mixer.h"
+#include "audio_monitor.h"
 #include "buttons.h"
 #include "dma.h"
 #include "encoder.h"
 #include "fat32.h"
 #include "i2s.h"
+#include "live_record.h"
 #include "pattern_manager.h"
+#include "profiler.h"
+#include "ramfunc.h"
+#include "sample_cache.h"
+#include "song.h"
 #include "sequencer.h"
 #include "spi.h"
 #include "st7789.h"
+#include "trace.h"
 #include "wav_loader.h"
 #include <stdint.h>
 #include <stdio.h>
@@ -49,6 +57,15 @@
 #define STK_CALIB (*(volatile uint32_t *)0xE000E01C)
 #define NVIC_IPR_BASE ((volatile uint8_t *)0xE000E400)
 
+/* Cycle counter (mixer CPU guard) */
+#define DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+/* Effects RAM: fixed budget reserved by STM32F411.ld (.fx_ram) */
+extern uint8_t _sfx[];
+extern uint8_t _efx[];
+
 /* GPIO Registers */
 #define GPIOA_MODER (*(volatile uint32_t *)(AHB1PERIPH_BASE + 0x0000UL + 0x00))
 #define GPIOA_PUPDR (*(volatile uint32_t *)(AHB1PERIPH_BASE + 0x0000UL + 0x0C))
@@ -60,6 +77,15 @@
 #define GPIOB_BASE (AHB1PERIPH_BASE + 0x0400UL)
 #define GPIOB_IDR (*(volatile uint32_t *)(GPIOB_BASE + 0x10))
 
+/* Flash Access Control Register Bits */
+#define FLASH_ACR_LATENCY_3WS (3 << 0) /* 90-100MHz at 2.7-3.6V */
+#define FLASH_ACR_LATENCY_MASK (0xF << 0)
+#define FLASH_ACR_PRFTEN (1 << 8) /* Prefetch */
+#define FLASH_ACR_ICEN (1 << 9)   /* ART instruction cache */
+#define FLASH_ACR_DCEN (1 << 10)  /* ART data cache */
+#define FLASH_ACR_ICRST (1 << 11)
+#define FLASH_ACR_DCRST (1 << 12)
+
 /* RCC Control Register Bits */
 #define RCC_CR_HSION (1 << 0)
 #define RCC_CR_HSIRDY (1 << 1)
@@ -83,7 +109,11 @@ void _init(void) {}
 
 static volatile uint32_t ms_ticks = 0;
 
-void SysTick_Handler(void) { ms_ticks++; }
+void SysTick_Handler(void) {
+  PROFILE_ENTER(PROF_SYSTICK);
+  ms_ticks++;
+  PROFILE_EXIT();
+}
 
 uint32_t HAL_GetTick(void) { return ms_ticks; }
 
@@ -108,7 +138,14 @@ void SystemClock_Config(void) {
   while (!(RCC_CR & RCC_CR_PLLI2SRDY) && timeout++ < 10000)
     ;
 
-  FLASH_ACR = (1 << 8) | (1 << 9) | (1 << 10) | 3;
+  /* Wait states for 96MHz before switching, then the ART accelerator:
+   * caches reset while still off, enabled with prefetch */
+  FLASH_ACR = FLASH_ACR_LATENCY_3WS;
+  while ((FLASH_ACR & FLASH_ACR_LATENCY_MASK) != FLASH_ACR_LATENCY_3WS)
+    ;
+  FLASH_ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+  FLASH_ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+  FLASH_ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
   RCC_CFGR |= (4 << 10);
 
   if (RCC_CR & RCC_CR_PLLRDY) {
@@ -121,6 +158,7 @@ void SystemClock_Config(void) {
 
 /* Private function prototypes */
 static void LoadTestPattern(void);
+static int LoadBootPattern(void);
 static void DrawMainScreen(Drumset *drumset);
 static void DrawDrumsetMenu(uint8_t full_redraw);
 static void DrawPatternMenu(uint8_t full_redraw);
@@ -130,11 +168,15 @@ static void UpdateBlinker(uint8_t channel, uint8_t active);
 static void OnButtonEvent(uint8_t button_id, uint8_t pressed);
 static void DrawStepEditScreen(uint8_t full_redraw);
 static void ShowPopup(const char *msg, uint16_t color, uint8_t exit_type);
+static void DrawLimiterMeter(uint8_t full_redraw);
+static void DrawDiagnostics(uint8_t full_redraw);
+static void DrawCpuMeter(uint8_t full_redraw);
 
 /* Global state for display and control */
 static volatile uint8_t is_playing = 0;
 static volatile uint8_t is_edit_mode = 0; /* 0=Normal, 1=Drumset Edit */
-/* Channel Edit Mode States: 0=Off, 1=Menu, 2=Browser, 3=Vol, 4=Pan */
+/* Channel Edit Mode States: 0=Off, 1=Menu, 2=Browser, 3=Vol, 4=Pan,
+ * 5=Hold, 6=Decay, 7=Filter, 8=Cutoff, 9=Resonance (menu row + 2) */
 static volatile uint8_t is_channel_edit_mode = 0;
 static volatile uint8_t selected_channel = 0;
 static volatile uint32_t saved_bpm = 120;
@@ -160,20 +202,25 @@ static int last_is_edit = -1;
 static int last_is_pattern_edit = -1;
 static int last_is_playing = -1;
 static uint8_t last_drawn_channel = 0xFF;
+static uint32_t drawn_step_mask = 0; /* Trig bitmap shown in step edit */
 
 static FAT32_FileEntry file_list[FAT32_MAX_FILES];
 static int file_count = 0;
 static int selected_file_index = 0;
 static int last_selected_file_index = 0;
-static int edit_menu_index = 0; /* 0=Sample, 1=Vol, 2=Pan */
+/* 0=Sample, 1=Vol, 2=Pan, 3=Hold, 4=Decay, 5=Filter, 6=Cutoff, 7=Res */
+static int edit_menu_index = 0;
+#define CHANNEL_MENU_ITEMS 8
 static int last_menu_index = 0;
 static Drumset *current_drumset = NULL;
 static uint32_t current_cluster = 0; /* Current directory cluster for browser */
 static char browser_path[128] = "SAMPLES";
 
-/* Drumset Menu States: 0=Off, 1=Menu, 2=Save Slots, 3=Load Slots */
+/* Drumset Menu States: 0=Off, 1=Menu, 2=Save Slots, 3=Load Slots,
+ * 4=Bake Slots */
 static volatile uint8_t is_drumset_menu_mode = 0;
-static int drumset_menu_index = 0;  /* 0=Save, 1=Load, 2=Back */
+static int drumset_menu_index = 0;  /* 0=Load, 1=Save, 2=Bake, 3=Back */
+#define DRUMSET_MENU_ITEMS 4
 static uint8_t selected_slot = 1;   /* Current slot selection (1-100) */
 static uint8_t occupied_slots[100]; /* List of occupied slots */
 static int occupied_slot_count = 0;
@@ -190,7 +237,14 @@ static uint8_t button_pattern_pressed = 0;
 
 /* Pattern Menu States: 0=Off, 1=Menu, 2=Save Slots, 3=Load Slots */
 static volatile uint8_t is_pattern_menu_mode = 0;
-static int pattern_menu_index = 0; /* 0=Save, 1=Load, 2=Back */
+/* 0=Load, 1=Save, 2=Song, 3=Record, 4=Quantize, 5=Diag, 6=Trace, 7=Back */
+#define PATTERN_MENU_ITEMS 8
+static int pattern_menu_index = 0;
+static uint8_t diag_latency = AUDIO_LATENCY_DEFAULT; /* Mode under cursor */
+
+#if PROFILER_ENABLE
+static ProfilerStats cpu_profile; /* Latest half-second snapshot */
+#endif
 
 /* Cyan Color for Pattern Menu */
 #define CYAN 0x07FF
@@ -205,14 +259,16 @@ static int str_ends_with(const char *str, const char *suffix) {
 }
 
 static void ScanDirectory(void) {
-  /* Use static buffer to avoid stack overflow (~1KB) */
-  static FAT32_FileEntry all_files[FAT32_MAX_FILES];
-  int count = FAT32_ListDir(current_cluster, all_files, FAT32_MAX_FILES);
+  /* Listed straight into file_list and filtered in place, no second
+   * buffer; at the root the first entry is kept for the [EMPTY] option */
+  int first = (current_cluster == FAT32_GetRootCluster()) ? 1 : 0;
+  int count = FAT32_ListDir(current_cluster, &file_list[first],
+                            FAT32_MAX_FILES - first);
 
   file_count = 0;
 
   /* Add [EMPTY] option at root level */
-  if (current_cluster == FAT32_GetRootCluster()) {
+  if (first) {
     strcpy(file_list[file_count].name, "[EMPTY]");
     file_list[file_count].is_dir = 0;
     file_list[file_count].size = 0;
@@ -220,26 +276,27 @@ static void ScanDirectory(void) {
     file_count++;
   }
 
-  /* Filter pass */
-  for (int i = 0; i < count; i++) {
+  /* Filter pass (never writes ahead of the entry it reads) */
+  for (int i = first; i < first + count; i++) {
+    FAT32_FileEntry *entry = &file_list[i];
+
     /* Skip dotfiles (hidden), but allow ".." */
-    if (all_files[i].name[0] == '.') {
-      if (strcmp(all_files[i].name, "..") != 0) {
+    if (entry->name[0] == '.') {
+      if (strcmp(entry->name, "..") != 0) {
         continue;
       }
     }
 
     /* Explicitly filter out TRASH folder if attributes didn't catch it */
-    if (strncmp(all_files[i].name, "TRASH-~1", 8) == 0) {
+    if (strncmp(entry->name, "TRASH-~1", 8) == 0) {
       continue;
     }
 
     /* Show directories and .WAV files only */
-    if (all_files[i].is_dir || str_ends_with(all_files[i].name, ".WAV")) {
-      if (file_count < FAT32_MAX_FILES) {
-        file_list[file_count] = all_files[i];
-        file_count++;
-      }
+    if (entry->is_dir || str_ends_with(entry->name, ".WAV")) {
+      if (file_count != i)
+        file_list[file_count] = *entry;
+      file_count++;
     }
   }
 
@@ -247,6 +304,63 @@ static void ScanDirectory(void) {
     file_count = 0;
 }
 
+/* Channel edit menu rows (8 rows fit below the title at this pitch) */
+#define CH_ROW_Y(row) (36 + (row) * 25)
+#define CH_ROW_H 24
+
+/**
+ * @brief Draw a text row of the channel edit menu, with an optional bar
+ * @param row Menu row
+ * @param text Row text
+ * @param bar Bar fill (0-255), -1 for no bar
+ * @param highlight Row is selected in the menu
+ * @param editing Row is being edited
+ * @param full_redraw Screen was just cleared
+ */
+static void DrawChannelRow(int row, const char *text, int bar,
+                           uint8_t highlight, uint8_t editing,
+                           uint8_t full_redraw) {
+  int y = CH_ROW_Y(row);
+  uint16_t c = highlight ? WHITE : GRAY;
+  uint16_t bg = highlight ? DARKBLUE : BLACK;
+  if (editing) {
+    c = RED;
+    bg = BLACK;
+  }
+
+  /* Only fill background if not actively editing (to prevent flicker) */
+  if (!editing || full_redraw) {
+    ST7789_FillRect(0, y, 240, CH_ROW_H, bg);
+  }
+  ST7789_WriteString(10, y + 5, text, c, bg, 2);
+
+  if (bar >= 0) {
+    /* Bar Graph (Split Fill for Flicker-Free Update) */
+    ST7789_DrawThickFrame(130, y + 2, 100, 20, 1, c);
+    int bar_w = (bar * 96) / 255;
+    ST7789_FillRect(132, y + 4, bar_w, 16, c);
+    ST7789_FillRect(132 + bar_w, y + 4, 96 - bar_w, 16, bg);
+  }
+}
+
+/**
+ * @brief Get the drumset field edited by a channel menu row (3-7)
+ */
+static uint8_t *ChannelParam(int row) {
+  switch (row) {
+  case 3:
+    return &current_drumset->holds[selected_channel];
+  case 4:
+    return &current_drumset->decays[selected_channel];
+  case 5:
+    return &current_drumset->filter_modes[selected_channel];
+  case 6:
+    return &current_drumset->cutoffs[selected_channel];
+  default:
+    return &current_drumset->resonances[selected_channel];
+  }
+}
+
 static void DrawChannelEditScreen(uint8_t full_redraw) {
   if (full_redraw) {
     ST7789_Fill(BLACK);
@@ -255,39 +369,30 @@ static void DrawChannelEditScreen(uint8_t full_redraw) {
     ST7789_WriteString(10, 10, buf, YELLOW, BLACK, 2);
   }
 
-  if (is_channel_edit_mode == 1 || is_channel_edit_mode == 3 ||
-      is_channel_edit_mode == 4) {
+  if (is_channel_edit_mode == 1 || is_channel_edit_mode >= 3) {
+    static const char *filter_names[] = {"OFF", "LP", "BP", "HP"};
     char buf[32];
+    uint8_t ch = selected_channel;
 
     /* Determine which rows to draw */
-    int draw_r0 = full_redraw;
-    int draw_r1 = full_redraw;
-    int draw_r2 = full_redraw;
-
-    /* Mode 1: Menu Navigation */
-    if (is_channel_edit_mode == 1 && !full_redraw) {
-      if (edit_menu_index != last_menu_index) {
-        if (last_menu_index == 0 || edit_menu_index == 0)
-          draw_r0 = 1;
-        if (last_menu_index == 1 || edit_menu_index == 1)
-          draw_r1 = 1;
-        if (last_menu_index == 2 || edit_menu_index == 2)
-          draw_r2 = 1;
-      }
-    }
-
-    /* Mode 3: Vol Edit - Only update R1 */
-    if (is_channel_edit_mode == 3) {
-      draw_r1 = 1;
-      draw_r0 = 0;
-      draw_r2 = 0;
+    uint8_t draw[CHANNEL_MENU_ITEMS];
+    for (int r = 0; r < CHANNEL_MENU_ITEMS; r++)
+      draw[r] = full_redraw;
+
+    /* Mode 1: Menu Navigation - old and new selection */
+    if (is_channel_edit_mode == 1 && !full_redraw &&
+        edit_menu_index != last_menu_index) {
+      if (last_menu_index >= 0 && last_menu_index < CHANNEL_MENU_ITEMS)
+        draw[last_menu_index] = 1;
+      draw[edit_menu_index] = 1;
     }
 
-    /* Mode 4: Pan Edit - Only update R2 */
-    if (is_channel_edit_mode == 4) {
-      draw_r2 = 1;
-      draw_r0 = 0;
-      draw_r1 = 0;
+    /* Modes 3+: Value Edit - Only update the edited row */
+    int editing_row = -1;
+    if (is_channel_edit_mode >= 3) {
+      editing_row = is_channel_edit_mode - 2;
+      for (int r = 0; r < CHANNEL_MENU_ITEMS; r++)
+        draw[r] = (r == editing_row);
     }
 
     int highlight_row = -1;
@@ -295,66 +400,45 @@ static void DrawChannelEditScreen(uint8_t full_redraw) {
       highlight_row = edit_menu_index;
 
     /* Row 0: Sample Name */
-    if (draw_r0) {
-      uint16_t c0 = (highlight_row == 0) ? WHITE : GRAY;
-      uint16_t bg0 = (highlight_row == 0) ? DARKBLUE : BLACK;
-      ST7789_FillRect(0, 40, 240, 30, bg0);
-      snprintf(buf, sizeof(buf), "SMP: %s",
-               current_drumset->sample_names[selected_channel]);
-      ST7789_WriteString(10, 48, buf, c0, bg0, 2);
+    if (draw[0]) {
+      snprintf(buf, sizeof(buf), "SMP: %s", current_drumset->sample_names[ch]);
+      DrawChannelRow(0, buf, -1, highlight_row == 0, 0, full_redraw);
     }
 
     /* Row 1: Volume */
-    if (draw_r1) {
-      uint16_t c1 = (highlight_row == 1) ? WHITE : GRAY;
-      uint16_t bg1 = (highlight_row == 1) ? DARKBLUE : BLACK;
-      if (is_channel_edit_mode == 3) {
-        c1 = RED;
-        bg1 = BLACK;
-      }
-
-      /* Only fill background if not actively editing (to prevent flicker) */
-      if (is_channel_edit_mode != 3 || full_redraw) {
-        ST7789_FillRect(0, 80, 240, 30, bg1);
-      }
-
-      uint8_t vol = current_drumset->volumes[selected_channel];
+    if (draw[1]) {
+      uint8_t vol = current_drumset->volumes[ch];
       snprintf(buf, sizeof(buf), "VOL: %d   ", vol);
-      ST7789_WriteString(10, 88, buf, c1, bg1, 2);
-      /* Bar Graph (Split Fill for Flicker-Free Update) */
-      ST7789_DrawThickFrame(130, 85, 100, 20, 1, c1);
-      int bar_w = (vol * 96) / 255;
-      /* Draw filled part */
-      ST7789_FillRect(132, 87, bar_w, 16, c1);
-      /* Draw empty part */
-      ST7789_FillRect(132 + bar_w, 87, 96 - bar_w, 16, bg1);
+      DrawChannelRow(1, buf, vol, highlight_row == 1, editing_row == 1,
+                     full_redraw);
     }
 
     /* Row 2: Pan */
-    if (draw_r2) {
+    if (draw[2]) {
+      int y = CH_ROW_Y(2);
       uint16_t c2 = (highlight_row == 2) ? WHITE : GRAY;
       uint16_t bg2 = (highlight_row == 2) ? DARKBLUE : BLACK;
-      if (is_channel_edit_mode == 4) {
+      if (editing_row == 2) {
         c2 = RED;
         bg2 = BLACK;
       }
 
       /* Only fill background if not actively editing (to prevent flicker) */
-      if (is_channel_edit_mode != 4 || full_redraw) {
-        ST7789_FillRect(0, 120, 240, 30, bg2);
+      if (editing_row != 2 || full_redraw) {
+        ST7789_FillRect(0, y, 240, CH_ROW_H, bg2);
       }
 
-      uint8_t pan = current_drumset->pans[selected_channel];
+      uint8_t pan = current_drumset->pans[ch];
       char pan_char = 'C';
       if (pan < 120)
         pan_char = 'L';
       if (pan > 136)
         pan_char = 'R';
       snprintf(buf, sizeof(buf), "PAN: %c %d   ", pan_char, pan);
-      ST7789_WriteString(10, 128, buf, c2, bg2, 2);
+      ST7789_WriteString(10, y + 5, buf, c2, bg2, 2);
 
       /* Pan Graph (3-Chunk Fill for Flicker-Free Update) */
-      ST7789_DrawThickFrame(130, 125, 100, 20, 1, c2);
+      ST7789_DrawThickFrame(130, y + 2, 100, 20, 1, c2);
       int x_pan = 132 + ((pan * 96) / 255);
       int cursor_w = 4;
       int x_start = 132;
@@ -362,23 +446,74 @@ static void DrawChannelEditScreen(uint8_t full_redraw) {
 
       /* Left BG */
       if (x_pan - 2 > x_start) {
-        ST7789_FillRect(x_start, 127, (x_pan - 2) - x_start, 16, bg2);
+        ST7789_FillRect(x_start, y + 4, (x_pan - 2) - x_start, 16, bg2);
       }
       /* Cursor */
-      ST7789_FillRect(x_pan - 2, 127, cursor_w, 16,
-                      (is_channel_edit_mode == 4) ? RED : c2);
+      ST7789_FillRect(x_pan - 2, y + 4, cursor_w, 16,
+                      (editing_row == 2) ? RED : c2);
       /* Right BG */
       if (x_pan + 2 < x_start + width) {
-        ST7789_FillRect(x_pan + 2, 127, (x_start + width) - (x_pan + 2), 16,
+        ST7789_FillRect(x_pan + 2, y + 4, (x_start + width) - (x_pan + 2), 16,
                         bg2);
       }
 
       /* Redraw Center Marker if not covered by cursor */
       if (x_pan - 2 > 180 || x_pan + 2 < 180) {
-        ST7789_DrawVLine(180, 125, 20, c2);
+        ST7789_DrawVLine(180, y + 2, 20, c2);
       }
     }
 
+    /* Row 3: Envelope Hold */
+    if (draw[3]) {
+      uint8_t hold = current_drumset->holds[ch];
+      snprintf(buf, sizeof(buf), "HLD: %dms   ", hold * 10);
+      DrawChannelRow(3, buf, hold, highlight_row == 3, editing_row == 3,
+                     full_redraw);
+    }
+
+    /* Row 4: Envelope Decay (0 = play the whole sample) */
+    if (draw[4]) {
+      uint8_t decay = current_drumset->decays[ch];
+      if (decay == 0)
+        snprintf(buf, sizeof(buf), "DEC: OFF   ");
+      else
+        snprintf(buf, sizeof(buf), "DEC: %dms   ", decay * 10);
+      DrawChannelRow(4, buf, decay, highlight_row == 4, editing_row == 4,
+                     full_redraw);
+    }
+
+    /* Row 5: Filter Mode */
+    if (draw[5]) {
+      snprintf(buf, sizeof(buf), "FLT: %s   ",
+               filter_names[current_drumset->filter_modes[ch] & 3]);
+      DrawChannelRow(5, buf, -1, highlight_row == 5, editing_row == 5,
+                     full_redraw);
+    }
+
+    /* Row 6: Filter Cutoff (same curve as the mixer: 20Hz-18kHz) */
+    if (draw[6]) {
+      uint8_t cutoff = current_drumset->cutoffs[ch];
+      uint32_t hz = 200; /* 0.1Hz units */
+      for (int i = 0; i < cutoff; i++)
+        hz = (hz * 10270 + 5000) / 10000; /* x 900^(1/255) */
+      hz /= 10;
+      if (hz < 1000)
+        snprintf(buf, sizeof(buf), "CUT: %luHz  ", (unsigned long)hz);
+      else
+        snprintf(buf, sizeof(buf), "CUT: %lu.%luk  ", (unsigned long)hz / 1000,
+                 (unsigned long)(hz % 1000) / 100);
+      DrawChannelRow(6, buf, cutoff, highlight_row == 6, editing_row == 6,
+                     full_redraw);
+    }
+
+    /* Row 7: Filter Resonance */
+    if (draw[7]) {
+      uint8_t res = current_drumset->resonances[ch];
+      snprintf(buf, sizeof(buf), "RES: %d   ", res);
+      DrawChannelRow(7, buf, res, highlight_row == 7, editing_row == 7,
+                     full_redraw);
+    }
+
     last_menu_index = edit_menu_index;
 
   } else if (is_channel_edit_mode == 2) {
@@ -423,8 +558,9 @@ static void DrawDrumsetMenu(uint8_t full_redraw) {
     /* Main Menu */
     ST7789_WriteString(10, 10, "DRUMSET MENU", YELLOW, BLACK, 2);
 
-    const char *menu_items[] = {"LOAD", "SAVE", "BACK"};
-    for (int i = 0; i < 3; i++) {
+    const char *menu_items[DRUMSET_MENU_ITEMS] = {"LOAD", "SAVE", "BAKE",
+                                                  "BACK"};
+    for (int i = 0; i < DRUMSET_MENU_ITEMS; i++) {
       uint16_t y_pos = 60 + (i * 40);
       uint16_t color = (i == drumset_menu_index) ? WHITE : GRAY;
 
@@ -432,9 +568,11 @@ static void DrawDrumsetMenu(uint8_t full_redraw) {
                          YELLOW, BLACK, 2);
       ST7789_WriteString(40, y_pos, menu_items[i], color, BLACK, 2);
     }
-  } else if (is_drumset_menu_mode == 2) {
-    /* Save Slots */
-    ST7789_WriteString(10, 10, "SAVE KIT", YELLOW, BLACK, 2);
+  } else if (is_drumset_menu_mode == 2 || is_drumset_menu_mode == 4) {
+    /* Save / Bake Slots */
+    ST7789_WriteString(10, 10,
+                       (is_drumset_menu_mode == 4) ? "BAKE KIT" : "SAVE KIT",
+                       YELLOW, BLACK, 2);
 
     /* Display 8 slots in a stable window (starts at start_slot) */
     int start_slot = ((selected_slot - 1) / 8) * 8 + 1;
@@ -518,7 +656,7 @@ static void TriggerChannelEdit(void) {
   is_channel_edit_mode = 1; /* Go to Menu */
   edit_menu_index = 0;
   last_menu_index = 0;
-  Encoder_SetLimits(0, 2); /* 3 Menu Items */
+  Encoder_SetLimits(0, CHANNEL_MENU_ITEMS - 1);
   Encoder_SetValue(0);
   Encoder_ResetIncrement();
   mode_changed = 1;
@@ -574,9 +712,23 @@ static void DrawPatternMenu(uint8_t full_redraw) {
     /* Main Menu */
     ST7789_WriteString(10, 10, "PATTERN MENU", CYAN, BLACK, 2);
 
-    const char *menu_items[] = {"LOAD", "SAVE", "BACK"};
-    for (int i = 0; i < 3; i++) {
-      uint16_t y_pos = 60 + (i * 40);
+    static const char *rec_labels[] = {"REC: OFF ", "REC: DUB ",
+                                       "REC: REPL"};
+    char qnt_label[16];
+    snprintf(qnt_label, sizeof(qnt_label), "QNT: %d%%  ",
+             LiveRecord_GetQuantize());
+
+    const char *menu_items[PATTERN_MENU_ITEMS] = {
+        "LOAD",
+        "SAVE",
+        Song_IsActive() ? "SONG OFF" : "SONG    ",
+        rec_labels[LiveRecord_GetMode()],
+        qnt_label,
+        "DIAG",
+        "TRACE",
+        "BACK"};
+    for (int i = 0; i < PATTERN_MENU_ITEMS; i++) {
+      uint16_t y_pos = 46 + (i * 24);
       uint16_t color = (i == pattern_menu_index) ? WHITE : GRAY;
 
       ST7789_WriteString(10, y_pos, (i == pattern_menu_index) ? ">" : " ", CYAN,
@@ -652,6 +804,8 @@ static void DrawPatternMenu(uint8_t full_redraw) {
         }
       }
     }
+  } else if (is_pattern_menu_mode == 4) {
+    DrawDiagnostics(full_redraw);
   }
 }
 
@@ -693,8 +847,24 @@ int main(void) {
   Sequencer_Init();
   Button_Init();
   Button_SetCallback(OnButtonEvent);
+  Button_SetPadCallback(LiveRecord_Hit);
 
   AudioMixer_Init();
+  AudioFx_Init(_sfx, (uint32_t)(_efx - _sfx));
+  SampleCache_Init();
+
+  /* Start the cycle counter so the mixer can watch its deadline */
+  DEMCR |= (1UL << 24); /* TRCENA */
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= (1UL << 0); /* CYCCNTENA */
+  AudioMixer_SetCycleCounter(&DWT_CYCCNT, 96000000 / AUDIO_SAMPLE_RATE);
+  AudioMonitor_Init(&DWT_CYCCNT, 96000000 / AUDIO_SAMPLE_RATE);
+#if PROFILER_ENABLE
+  Profiler_Init(&DWT_CYCCNT);
+#endif
+#if TRACE_ENABLE
+  Trace_Init(&DWT_CYCCNT, 96);
+#endif
 
   /* Configure SysTick for 1ms (assuming 96MHz HCLK) */
   STK_LOAD = 96000 - 1;
@@ -713,6 +883,9 @@ int main(void) {
   NVIC_IPR_BASE[50] =
       (3 << 4); /* Lower Priority - Heavy SD operations happen here */
   NVIC_IPR_BASE[23] = (3 << 4); /* Lower Priority */
+  /* EXTI15_10 (Trigger Pads): IRQ 40 - same as the clock, so a hit reads a
+   * consistent step position */
+  NVIC_IPR_BASE[40] = (1 << 4);
 
   /* SD initialization and sample auto-load (Slot 1) */
   (void)FAT32_Init();
@@ -722,6 +895,7 @@ int main(void) {
     strcpy(drumset.sample_names[i], "EMPTY");
     drumset.volumes[i] = 255;
     drumset.pans[i] = 127;
+    drumset.cutoffs[i] = 255;
   }
   current_drumset = &drumset;
 
@@ -739,19 +913,15 @@ int main(void) {
   /* Start audio subsystem as early as possible for PLLI2S stability */
   int audio_status = I2S_Init();
   if (audio_status == 0) {
-    for (int i = 0; i < AUDIO_BUFFER_SIZE; i++)
-      audio_buffer[i] = 0;
-    DMA_Init_I2S(audio_buffer, AUDIO_BUFFER_SIZE);
+    DMA_Init_I2S(AUDIO_LATENCY_DEFAULT);
     I2S_Start();
   }
 
   /* Attempt to load Pattern Slot 1 on boot */
-  Pattern *boot_pat = Sequencer_GetPattern();
   uint16_t default_bpm = 120;
-  if (Pattern_Load(boot_pat, 1) == 0) {
+  if (LoadBootPattern() == 0) {
     loaded_pattern_slot = 1;
     /* Force default 120 BPM regardless of file content */
-    boot_pat->bpm = default_bpm;
     Sequencer_SetBPM(default_bpm);
   } else {
     /* Fallback to Test Pattern if no SD pattern found */
@@ -768,12 +938,57 @@ int main(void) {
   uint32_t channel_blink_times[NUM_CHANNELS] = {0}; // For sequencer blinkers
 
   while (1) {
+    PROFILE_ENTER(PROF_EVENTS);
     Button_HandleEvents();
+    PROFILE_EXIT();
+    Pattern_CachePoll();
+    LiveRecord_Poll(); /* Step edit redraws changed cells by itself */
+
+    /* Song chain: kit changes update the footer or the channel editor */
+    if (Song_Poll() & SONG_EVENT_KIT) {
+      if (is_channel_edit_mode) {
+        full_redraw_needed = 1;
+        mode_changed = 1;
+      } else if (!is_drumset_menu_mode && !is_pattern_menu_mode &&
+                 !is_pattern_edit_mode && !is_ui_popup) {
+        ST7789_WriteString(230, 220, current_drumset->name, WHITE, BLACK, 2);
+      }
+    }
+
+    /* Master limiter meter, main screen only */
+    static uint32_t last_meter_time = 0;
+    if (HAL_GetTick() - last_meter_time >= 50) {
+      last_meter_time = HAL_GetTick();
+      if (!is_channel_edit_mode && !is_drumset_menu_mode &&
+          !is_pattern_menu_mode && !is_pattern_detail_mode && !is_ui_popup)
+        DrawLimiterMeter(0);
+    }
+
+#if PROFILER_ENABLE
+    /* CPU load over the last half second; bar on the main screen only */
+    static uint32_t last_cpu_time = 0;
+    if (HAL_GetTick() - last_cpu_time >= 500) {
+      last_cpu_time = HAL_GetTick();
+      Profiler_Snapshot(&cpu_profile);
+      if (!is_channel_edit_mode && !is_drumset_menu_mode &&
+          !is_pattern_menu_mode && !is_pattern_detail_mode && !is_ui_popup)
+        DrawCpuMeter(0);
+    }
+#endif
+
+    /* Audio diagnostics page follows the live statistics */
+    static uint32_t last_diag_time = 0;
+    if (is_pattern_menu_mode == 4 && !is_ui_popup &&
+        HAL_GetTick() - last_diag_time >= 250) {
+      last_diag_time = HAL_GetTick();
+      DrawDiagnostics(0);
+    }
 
     /* Handle Mode Change */
     if (mode_changed) {
       mode_changed = 0;
       last_encoder = Encoder_GetValue();
+      TRACE(TRACE_UI_BEGIN, full_redraw_needed, 0);
 
       if (full_redraw_needed) {
         if (is_channel_edit_mode) {
@@ -802,6 +1017,7 @@ int main(void) {
           UpdateModeUI();
         }
       }
+      TRACE(TRACE_UI_END, 0, 0);
     }
 
     /* Handle Async Popup (Success/Error) */
@@ -829,7 +1045,7 @@ int main(void) {
         /* Long-press (0.5s) detected */
         is_drumset_menu_mode = 1;
         drumset_menu_index = 0;
-        Encoder_SetLimits(0, 2);
+        Encoder_SetLimits(0, DRUMSET_MENU_ITEMS - 1);
         Encoder_SetValue(0);
         DrawDrumsetMenu(1); /* Full redraw on entry */
         button_drumset_handled = 1;
@@ -843,7 +1059,7 @@ int main(void) {
         /* Long-press (0.5s) detected */
         is_pattern_menu_mode = 1;
         pattern_menu_index = 0;
-        Encoder_SetLimits(0, 2);
+        Encoder_SetLimits(0, PATTERN_MENU_ITEMS - 1);
         Encoder_SetValue(0);
         DrawPatternMenu(1); /* Full redraw on entry */
         button_pattern_handled = 1;
@@ -927,8 +1143,8 @@ int main(void) {
         /* Drumset menu navigation */
         drumset_menu_index = encoder_val;
         DrawDrumsetMenu(0); /* Partial redraw */
-      } else if (is_drumset_menu_mode == 2) {
-        /* Save slot selection */
+      } else if (is_drumset_menu_mode == 2 || is_drumset_menu_mode == 4) {
+        /* Save / Bake slot selection */
         selected_slot = (uint8_t)encoder_val;
         DrawDrumsetMenu(0); /* Partial redraw */
       } else if (is_drumset_menu_mode == 3) {
@@ -953,6 +1169,18 @@ int main(void) {
         current_drumset->pans[selected_channel] = (uint8_t)encoder_val;
         AudioMixer_SetPan(selected_channel, (uint8_t)encoder_val);
         DrawChannelEditScreen(0);
+      } else if (is_channel_edit_mode >= 5) {
+        /* Envelope / Filter Edit */
+        uint8_t ch = selected_channel;
+        *ChannelParam(edit_menu_index) = (uint8_t)encoder_val;
+        if (is_channel_edit_mode <= 6)
+          AudioMixer_SetEnvelope(ch, current_drumset->holds[ch],
+                                 current_drumset->decays[ch]);
+        else
+          AudioMixer_SetFilter(ch, current_drumset->filter_modes[ch],
+                               current_drumset->cutoffs[ch],
+                               current_drumset->resonances[ch]);
+        DrawChannelEditScreen(0);
       } else if (is_pattern_menu_mode == 1) {
         pattern_menu_index = encoder_val;
         DrawPatternMenu(0);
@@ -964,6 +1192,9 @@ int main(void) {
           selected_slot = occupied_slots[encoder_val];
           DrawPatternMenu(0);
         }
+      } else if (is_pattern_menu_mode == 4) {
+        diag_latency = (uint8_t)encoder_val;
+        DrawPatternMenu(0);
       } else if (is_pattern_detail_mode) {
         pattern_cursor = (int8_t)encoder_val;
         DrawStepEditScreen(0); /* Incremental redraw of step cursor */
@@ -1051,8 +1282,9 @@ int main(void) {
           ST7789_WriteString(255, 10, buf, WHITE, BLACK, 2);
 
           for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
-            uint8_t velocity = Sequencer_GetStep(i, step);
-            if (velocity > 0) {
+            /* Tracks may run their own length/clock (polymeter) */
+            uint32_t trig_mask = Sequencer_GetTrackMask(i);
+            if ((trig_mask >> Sequencer_GetTrackStep(i)) & 1) {
               if (!is_pattern_edit_mode) {
                 UpdateBlinker(i, 1);
               }
@@ -1144,15 +1376,20 @@ int main(void) {
         }
       }
 
-      if (needs_full_grid_update) {
+      /* Steps changed outside the editor: redraw just those cells */
+      if (needs_full_grid_update ||
+          (is_pattern_detail_mode &&
+           Sequencer_GetTrackMask(selected_channel) != drawn_step_mask)) {
         needs_full_grid_update = 0;
-        if (is_pattern_edit_mode) {
-          DrawStepEditScreen(2); /* Flicker-free full grid refresh */
+        if (is_pattern_detail_mode) {
+          DrawStepEditScreen(2); /* Flicker-free grid refresh */
         }
       }
     }
 
+    PROFILE_ENTER(PROF_IDLE);
     __asm volatile("wfi");
+    PROFILE_EXIT();
   }
 }
 
@@ -1202,6 +1439,180 @@ static void LoadTestPattern(void) {
   Sequencer_SetStep(5, 16, 100); // Start of Bar 2 accent
 }
 
+/**
+ * @brief Load pattern slot 1 into the sequencer
+ * @return 0 on success, -1 if the slot is empty or unreadable
+ */
+static int LoadBootPattern(void) {
+  Pattern pattern; /* Only on the stack while booting */
+  if (Pattern_Load(&pattern, 1) != 0)
+    return -1;
+  Sequencer_LoadPattern(&pattern);
+  return 0;
+}
+
+#define METER_X 172
+#define METER_Y 222
+#define METER_W 48 /* 4px per dB */
+#define METER_H 12
+
+/**
+ * @brief Draw the master limiter gain reduction in the footer
+ * @details Shows the deepest reduction since the last call, 0-12dB
+ * @param full_redraw Screen was just cleared
+ */
+static void DrawLimiterMeter(uint8_t full_redraw) {
+  static int last_w = -1;
+  uint32_t gain = 32768 - AudioMixer_GetGainReduction();
+
+  /* Whole dB below unity: -1dB is x0.891 (29204 in Q15) */
+  uint32_t level = 32768;
+  int db = 0;
+  while (level > gain && db < METER_W / 4) {
+    level = (level * 29204) >> 15;
+    db++;
+  }
+
+  int w = db * 4;
+  if (full_redraw) {
+    ST7789_DrawThickFrame(METER_X - 2, METER_Y - 2, METER_W + 4, METER_H + 4, 1,
+                          GRAY);
+    last_w = -1;
+  }
+  if (w == last_w)
+    return;
+  ST7789_FillRect(METER_X, METER_Y, w, METER_H, RED);
+  ST7789_FillRect(METER_X + w, METER_Y, METER_W - w, METER_H, BLACK);
+  last_w = w;
+}
+
+#define DIAG_BARS_Y 174
+#define DIAG_BARS_H 44
+
+/**
+ * @brief Draw the audio diagnostics page (pattern menu, DIAG)
+ * @details Render times of the audio interrupt against the buffer period,
+ *          underruns and the block size. The encoder picks a block size,
+ *          a press applies it and clears the statistics.
+ * @param full_redraw Screen was just cleared
+ */
+static void DrawDiagnostics(uint8_t full_redraw) {
+  static const char *labels[AUDIO_MONITOR_BINS] = {
+      "<1/8", "", "", "1/2", "", "", "", "7/8", "LATE"};
+  AudioMonitorStats st;
+  AudioFxStats fx;
+  char line[32];
+
+  AudioMonitor_GetStats(&st);
+  AudioFx_GetStats(&fx);
+
+  if (full_redraw) {
+    ST7789_WriteString(10, 10, "AUDIO DIAG", CYAN, BLACK, 2);
+    /* Build profile, so render times can be compared (make size-report) */
+#if RAMFUNC_ENABLE
+    ST7789_WriteString(250, 14, "REL RAM", GRAY, BLACK, 1);
+#elif defined(__OPTIMIZE__)
+    ST7789_WriteString(250, 14, "REL", GRAY, BLACK, 1);
+#else
+    ST7789_WriteString(250, 14, "DEBUG", GRAY, BLACK, 1);
+#endif
+    for (int i = 0; i < AUDIO_MONITOR_BINS; i++)
+      ST7789_WriteString(10 + i * 34, DIAG_BARS_Y + DIAG_BARS_H + 6,
+                         labels[i], GRAY, BLACK, 1);
+  }
+
+  /* Block size under the cursor; yellow until pushed */
+  uint8_t active = (diag_latency == DMA_GetLatency());
+  uint32_t frames = DMA_GetPeriodFrames(diag_latency);
+  uint32_t tenths = frames * 10000 / AUDIO_SAMPLE_RATE;
+  snprintf(line, sizeof(line), "BUF %3lu %2lu.%lums %s",
+           (unsigned long)frames, (unsigned long)(tenths / 10),
+           (unsigned long)(tenths % 10), active ? "    " : "PUSH");
+  ST7789_WriteString(10, 40, line, active ? WHITE : YELLOW, BLACK, 2);
+
+  /* Render min/avg/max in microseconds (96 cycles each) */
+  snprintf(line, sizeof(line), "US %4lu/%4lu/%4lu   ",
+           (unsigned long)(st.min_cycles / 96),
+           (unsigned long)(st.avg_cycles / 96),
+           (unsigned long)(st.max_cycles / 96));
+  ST7789_WriteString(10, 64, line, WHITE, BLACK, 2);
+
+  uint32_t deadline = st.deadline_cycles ? st.deadline_cycles : 1;
+  snprintf(line, sizeof(line), "LOAD %3lu%% MAX %3lu%%  ",
+           (unsigned long)((uint64_t)st.avg_cycles * 100 / deadline),
+           (unsigned long)((uint64_t)st.max_cycles * 100 / deadline));
+  ST7789_WriteString(10, 88, line, WHITE, BLACK, 2);
+
+  snprintf(line, sizeof(line), "LATE %-6lu MRG %-4lu",
+           (unsigned long)st.underruns, (unsigned long)st.min_margin);
+  ST7789_WriteString(10, 112, line, st.underruns ? RED : WHITE, BLACK, 2);
+
+  snprintf(line, sizeof(line), "FX SKIP %-6lu", (unsigned long)fx.bypassed);
+  ST7789_WriteString(10, 136, line, fx.bypassed ? YELLOW : WHITE, BLACK, 2);
+
+  /* Render time histogram, scaled to the fullest bin */
+  uint32_t peak = 1;
+  for (int i = 0; i < AUDIO_MONITOR_BINS; i++) {
+    if (st.histogram[i] > peak)
+      peak = st.histogram[i];
+  }
+  for (int i = 0; i < AUDIO_MONITOR_BINS; i++) {
+    uint16_t h = (uint16_t)((uint64_t)st.histogram[i] * DIAG_BARS_H / peak);
+    if (st.histogram[i] && h == 0)
+      h = 1;
+    uint16_t x = 10 + i * 34;
+    if (h < DIAG_BARS_H)
+      ST7789_FillRect(x, DIAG_BARS_Y, 30, DIAG_BARS_H - h, BLACK);
+    if (h)
+      ST7789_FillRect(x, DIAG_BARS_Y + DIAG_BARS_H - h, 30, h,
+                      (i == AUDIO_MONITOR_BINS - 1) ? RED : GREEN);
+  }
+}
+
+#define CPU_X 100
+#define CPU_Y 222
+#define CPU_W 60 /* 6px per 10% */
+#define CPU_H 12
+
+/**
+ * @brief Draw the CPU load in the footer, split by where it went
+ * @details Audio red, other interrupts orange, SD yellow, drawing cyan,
+ *          button handling magenta, the rest of the main loop gray; idle
+ *          stays black.
+ * @param full_redraw Screen was just cleared
+ */
+static void DrawCpuMeter(uint8_t full_redraw) {
+#if PROFILER_ENABLE
+  static const uint8_t order[] = {PROF_AUDIO, PROF_CLOCK, PROF_PADS,
+                                  PROF_INPUT, PROF_DEBOUNCE, PROF_SYSTICK,
+                                  PROF_SD, PROF_UI, PROF_EVENTS, PROF_OTHER};
+  static const uint16_t colors[PROF_SOURCES] = {
+      RED, ORANGE, ORANGE, ORANGE, ORANGE, ORANGE, CYAN, YELLOW, MAGENTA,
+      BLACK, GRAY};
+
+  if (full_redraw)
+    ST7789_DrawThickFrame(CPU_X - 2, CPU_Y - 2, CPU_W + 4, CPU_H + 4, 1,
+                          GRAY);
+
+  uint16_t x = CPU_X;
+  uint32_t done = 0;
+  for (uint32_t i = 0; i < sizeof(order); i++) {
+    /* Round the running total so the segments always add up */
+    done += cpu_profile.load[order[i]];
+    uint16_t end = CPU_X + (uint16_t)((done * CPU_W + 500) / 1000);
+    if (end > CPU_X + CPU_W)
+      end = CPU_X + CPU_W;
+    if (end > x)
+      ST7789_FillRect(x, CPU_Y, end - x, CPU_H, colors[order[i]]);
+    x = end;
+  }
+  if (x < CPU_X + CPU_W)
+    ST7789_FillRect(x, CPU_Y, CPU_X + CPU_W - x, CPU_H, BLACK);
+#else
+  (void)full_redraw;
+#endif
+}
+
 static void DrawMainScreen(Drumset *drumset) {
   ST7789_Fill(BLACK);
 
@@ -1228,12 +1639,14 @@ static void DrawMainScreen(Drumset *drumset) {
   }
 
   /* Status indicator - Always show PLAY/STOP for clarity */
-  const char *status = is_playing ? "PLAYING      " : "STOPPED      ";
+  const char *status = is_playing ? "PLAYING" : "STOPPED";
   uint16_t status_color = is_playing ? GREEN : RED;
   ST7789_WriteString(10, 220, status, status_color, BLACK, 2);
 
   /* Show Loaded Kit Name in Footer (Right Aligned, Yellow) */
   ST7789_WriteString(230, 220, drumset->name, WHITE, BLACK, 2);
+  DrawLimiterMeter(1);
+  DrawCpuMeter(1);
 
   /* 3x2 Grid Layout
    * Width 90px, Height 80px
@@ -1322,7 +1735,7 @@ static void UpdateModeUI(void) {
 
   /* Update Status Footer only on playback state change */
   if (is_playing != last_is_playing) {
-    const char *status = is_playing ? "PLAYING      " : "STOPPED      ";
+    const char *status = is_playing ? "PLAYING" : "STOPPED";
     uint16_t status_color = is_playing ? GREEN : RED;
     ST7789_WriteString(10, 220, status, status_color, BLACK, 2);
     last_is_playing = is_playing;
@@ -1438,6 +1851,14 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
             mode_changed = 1;
             full_redraw_needed = 1;
           } else if (drumset_menu_index == 2) {
+            /* BAKE Kit */
+            occupied_slot_count = Drumset_GetOccupiedSlots(occupied_slots, 100);
+            is_drumset_menu_mode = 4; /* Bake Slot Selection */
+            Encoder_SetLimits(1, 100);
+            Encoder_SetValue(selected_slot);
+            mode_changed = 1;
+            full_redraw_needed = 1;
+          } else if (drumset_menu_index == 3) {
             /* BACK */
             ExitDrumsetMenu();
           }
@@ -1448,6 +1869,13 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
           } else {
             ShowPopup("ERR SAVE", RED, 0);
           }
+        } else if (is_drumset_menu_mode == 4) {
+          /* BAKE Action */
+          if (Drumset_Bake(current_drumset, selected_slot) == 0) {
+            ShowPopup("DRUMSET BAKED", GREEN, 1);
+          } else {
+            ShowPopup("ERR BAKE", RED, 0);
+          }
         } else if (is_drumset_menu_mode == 3) {
           /* LOAD Action */
           if (Drumset_LoadFromSlot(current_drumset, selected_slot) == 0) {
@@ -1464,7 +1892,7 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
           /* Go back to main menu */
           is_drumset_menu_mode = 1;
           drumset_menu_index = 0;
-          Encoder_SetLimits(0, 2);
+          Encoder_SetLimits(0, DRUMSET_MENU_ITEMS - 1);
           Encoder_SetValue(0);
           mode_changed = 1;
           full_redraw_needed = 1;
@@ -1496,6 +1924,40 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
             Encoder_SetValue(1);
             occupied_slot_count = Pattern_GetOccupiedSlots(occupied_slots, 100);
             full_redraw_needed = 1;
+          } else if (pattern_menu_index == 2) { /* SONG */
+            if (Song_IsActive()) {
+              Song_Stop();
+              ShowPopup("SONG OFF", GREEN, 2);
+            } else if (Song_Load(1) > 0 && Song_Start(current_drumset) == 0) {
+              loaded_pattern_slot = Song_GetPatternSlot();
+              ShowPopup("SONG ON", GREEN, 2);
+            } else {
+              ShowPopup("NO SONG", RED, 0);
+            }
+          } else if (pattern_menu_index == 3) { /* REC: OFF -> DUB -> REPL */
+            LiveRecord_SetMode((LiveRecord_GetMode() + 1) %
+                               (LIVE_RECORD_REPLACE + 1));
+          } else if (pattern_menu_index == 4) { /* QNT: 100 -> 75 ... 0 */
+            uint8_t quantize = LiveRecord_GetQuantize();
+            LiveRecord_SetQuantize(quantize >= 25 ? quantize - 25 : 100);
+          } else if (pattern_menu_index == 5) { /* DIAG */
+            is_pattern_menu_mode = 4;
+            uint8_t top = AUDIO_LATENCY_512;
+            while (DMA_GetPeriodFrames(top) > AUDIO_PERIOD_MAX)
+              top--;
+            diag_latency = DMA_GetLatency();
+            Encoder_SetLimits(0, top);
+            Encoder_SetValue(diag_latency);
+            full_redraw_needed = 1;
+          } else if (pattern_menu_index == 6) { /* TRACE: dump over SWO */
+#if TRACE_ENABLE
+            if (Trace_DumpITM() == 0)
+              ShowPopup("TRACE SENT", GREEN, 0);
+            else
+              ShowPopup("NO SWO", RED, 0);
+#else
+            ShowPopup("NO TRACE", RED, 0);
+#endif
           } else { /* BACK */
             ExitPatternMenu();
           }
@@ -1509,11 +1971,19 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
           } else {
             ShowPopup("ERR SAVE", RED, 0);
           }
+        } else if (is_pattern_menu_mode == 4) {
+          /* Apply the block size under the cursor, start counting afresh */
+          if (DMA_SetLatency(diag_latency) == 0)
+            AudioMonitor_Reset();
+          DrawPatternMenu(0);
         } else if (is_pattern_menu_mode == 3) {
           /* LOAD selected pattern */
           if (occupied_slot_count > 0) {
             Pattern temp_pat;
             if (Pattern_Load(&temp_pat, selected_slot) == 0) {
+              /* Manual pick takes over from the song chain */
+              Song_Stop();
+
               /* Always switch to main screen on pattern load */
               is_pattern_edit_mode = 0;
               is_pattern_detail_mode = 0;
@@ -1524,11 +1994,8 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
                 Sequencer_QueuePattern(&temp_pat, selected_slot);
                 ExitPatternMenu();
               } else {
-                /* Load immediately */
-                Pattern *current = Sequencer_GetPattern();
-                uint16_t current_bpm = current->bpm;
-                memcpy(current, &temp_pat, sizeof(Pattern));
-                current->bpm = current_bpm; /* Restore current tempo */
+                /* Load immediately, keeping the current tempo */
+                Sequencer_LoadPattern(&temp_pat);
                 /* Note: BPM update intentionally disabled per user request */
                 loaded_pattern_slot = selected_slot;
                 ExitPatternMenu();
@@ -1548,7 +2015,7 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
           /* Go back to main pattern menu */
           is_pattern_menu_mode = 1;
           pattern_menu_index = 0;
-          Encoder_SetLimits(0, 2);
+          Encoder_SetLimits(0, PATTERN_MENU_ITEMS - 1);
           Encoder_SetValue(0);
           mode_changed = 1;
           full_redraw_needed = 1;
@@ -1609,6 +2076,12 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
           Encoder_SetValue(current_drumset->pans[selected_channel]);
           is_channel_edit_mode = 4;
           mode_changed = 1; /* Redraw will clear selection frame */
+        } else {
+          /* Go to Envelope / Filter Edit */
+          Encoder_SetLimits(0, (edit_menu_index == 5) ? AUDIO_FILTER_HP : 255);
+          Encoder_SetValue(*ChannelParam(edit_menu_index));
+          is_channel_edit_mode = edit_menu_index + 2;
+          mode_changed = 1; /* Redraw will clear selection frame */
         }
       } else if (is_channel_edit_mode == 2) {
         /* Browser Action */
@@ -1665,7 +2138,7 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
               WAV_UnloadChannel(selected_channel, current_drumset);
               /* Return to Menu */
               is_channel_edit_mode = 1;
-              Encoder_SetLimits(0, 2);
+              Encoder_SetLimits(0, CHANNEL_MENU_ITEMS - 1);
               Encoder_SetValue(0);
               mode_changed = 1;
               full_redraw_needed = 1;
@@ -1694,10 +2167,10 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
             }
           }
         }
-      } else if (is_channel_edit_mode == 3 || is_channel_edit_mode == 4) {
-        /* Confirm Vol/Pan Change -> Return to Menu */
+      } else if (is_channel_edit_mode >= 3) {
+        /* Confirm Vol/Pan/Envelope Change -> Return to Menu */
         is_channel_edit_mode = 1;
-        Encoder_SetLimits(0, 2);
+        Encoder_SetLimits(0, CHANNEL_MENU_ITEMS - 1);
         Encoder_SetValue(edit_menu_index);
         mode_changed = 1;
         last_menu_index = -1;
@@ -1723,8 +2196,8 @@ static void OnButtonEvent(uint8_t button_id, uint8_t pressed) {
       if (is_channel_edit_mode == 2) {
         /* Back from Browser -> Menu */
         is_channel_edit_mode = 1; /* Go to Menu */
-        Encoder_SetLimits(0, 2);  /* 3 Menu Items */
-        Encoder_SetValue(0);      /* Reset to Sample Item */
+        Encoder_SetLimits(0, CHANNEL_MENU_ITEMS - 1);
+        Encoder_SetValue(0); /* Reset to Sample Item */
         mode_changed = 1;
         full_redraw_needed = 1;
       } else if (is_channel_edit_mode) {
@@ -1787,7 +2260,8 @@ static void DrawStepEditScreen(uint8_t full_redraw) {
 
   uint16_t ch_color = GetChannelColor(selected_channel);
   uint16_t bg_box_color = 0x2104;
-  uint8_t current_play_step = is_playing ? Sequencer_GetCurrentStep() : 0xFF;
+  uint8_t current_play_step =
+      is_playing ? Sequencer_GetTrackStep(selected_channel) : 0xFF;
 
   if (full_redraw) {
     ST7789_Fill(BLACK);
@@ -1809,15 +2283,13 @@ static void DrawStepEditScreen(uint8_t full_redraw) {
     /* Incremental update guard: Don't draw if menu is active */
     if (is_pattern_menu_mode || is_drumset_menu_mode || full_redraw_needed)
       return;
-
-    if (full_redraw == 2) {
-      /* Mode 2: Full grid refresh without ST7789_Fill(BLACK) */
-      /* We just reset last_cursor/last_play_step to force redraw of all */
-      last_cursor = -1;
-      last_play_step = -1;
-    }
   }
 
+  /* Cells whose trig changed since the last draw are always redrawn; mode 2
+   * (refresh without ST7789_Fill) sends only those */
+  uint32_t step_mask = Sequencer_GetTrackMask(selected_channel);
+  uint32_t changed_mask = step_mask ^ drawn_step_mask;
+
   /* Draw 32 steps (4x8 grid) */
   for (int i = 0; i < 32; i++) {
     int row = i / 8;
@@ -1826,7 +2298,7 @@ static void DrawStepEditScreen(uint8_t full_redraw) {
     int y = START_Y + row * (BOX_H + GAP_Y);
 
     /* Optimized incremental redraw condition to prevent flicker */
-    uint8_t redraw = (full_redraw == 1 || full_redraw == 2);
+    uint8_t redraw = (full_redraw == 1) || ((changed_mask >> i) & 1);
     if (i == current_play_step || i == last_play_step)
       redraw = 1;
     if (i == pattern_cursor || i == last_cursor) {
@@ -1856,6 +2328,17 @@ static void DrawStepEditScreen(uint8_t full_redraw) {
         }
       }
 
+      /* Ratchet: one tick per hit along the bottom edge */
+      uint8_t hits = Sequencer_GetRatchet(selected_channel, i, NULL);
+      if (velocity > 0 && hits > 1) {
+        for (int h = 0; h < hits; h++)
+          ST7789_FillRect(x + 2 + h * 4, y + BOX_H - 4, 2, 3, WHITE);
+      }
+
+      /* Trig condition: marker in the top-right corner */
+      if (velocity > 0 && Sequencer_GetCondition(selected_channel, i))
+        ST7789_FillRect(x + BOX_W - 7, y + 3, 4, 4, WHITE);
+
       /* 3. Draw Manual Selection Frame (White) */
       if (i == pattern_cursor) {
         ST7789_DrawThickFrame(x, y, BOX_W, BOX_H, 2, WHITE);
@@ -1871,4 +2354,5 @@ static void DrawStepEditScreen(uint8_t full_redraw) {
 
   last_cursor = pattern_cursor;
   last_play_step = current_play_step;
+  drawn_step_mask = step_mask;
 }
@@ -0,0 +1,253 @@
+/* Generated by tools/mixtables.c - do not edit */
+#ifndef MIXER_TABLES_H
+#define MIXER_TABLES_H
+
+#include <stdint.h>
+
+/* Constant-power pan, Q15: right gain = [pan], left = [255 - pan] */
+static const uint16_t mixer_pan_law[256] = {
+        0,   285,   571,   856,  1142,  1427,  1712,  1998,
+     2283,  2568,  2853,  3138,  3422,  3707,  3991,  4276,
+     4560,  4844,  5128,  5411,  5695,  5978,  6261,  6544,
+     6826,  7108,  7390,  7672,  7953,  8234,  8515,  8796,
+     9076,  9355,  9635,  9914, 10193, 10471, 10749, 11026,
+    11303, 11580, 11856, 12132, 12407, 12682, 12956, 13230,
+    13503, 13776, 14048, 14320, 14591, 14862, 15132, 15402,
+    15671, 15939, 16207, 16474, 16740, 17006, 17271, 17536,
+    17800, 18063, 18326, 18587, 18849, 19109, 19369, 19628,
+    19886, 20143, 20400, 20656, 20911, 21165, 21419, 21672,
+    21924, 22175, 22425, 22674, 22923, 23170, 23417, 23663,
+    23908, 24152, 24395, 24638, 24879, 25119, 25359, 25597,
+    25835, 26071, 26307, 26541, 26775, 27007, 27239, 27469,
+    27698, 27927, 28154, 28380, 28605, 28829, 29052, 29274,
+    29495, 29714, 29933, 30150, 30366, 30582, 30795, 31008,
+    31220, 31430, 31639, 31847, 32054, 32260, 32464, 32667,
+    32869, 33069, 33269, 33467, 33664, 33859, 34053, 34246,
+    34438, 34628, 34817, 35005, 35192, 35377, 35560, 35743,
+    35924, 36103, 36282, 36459, 36634, 36808, 36981, 37152,
+    37322, 37491, 37658, 37823, 37988, 38150, 38312, 38472,
+    38630, 38787, 38942, 39096, 39249, 39400, 39549, 39697,
+    39844, 39989, 40132, 40274, 40415, 40554, 40691, 40827,
+    40961, 41094, 41225, 41355, 41483, 41609, 41734, 41857,
+    41979, 42099, 42218, 42335, 42450, 42564, 42676, 42786,
+    42895, 43002, 43108, 43212, 43314, 43415, 43514, 43611,
+    43707, 43801, 43893, 43984, 44073, 44160, 44246, 44330,
+    44412, 44493, 44572, 44649, 44725, 44799, 44871, 44941,
+    45010, 45077, 45143, 45206, 45268, 45328, 45387, 45444,
+    45499, 45552, 45603, 45653, 45701, 45748, 45793, 45835,
+    45877, 45916, 45954, 45990, 46024, 46056, 46087, 46116,
+    46143, 46169, 46192, 46214, 46235, 46253, 46270, 46285,
+    46298, 46309, 46319, 46327, 46333, 46337, 46340, 46341,
+};
+
+/* Velocity curves, Q15: linear, exponential, logarithmic */
+static const uint16_t mixer_velocity[3][256] = {
+    {
+            0,   129,   257,   386,   514,   643,   771,   900,
+         1028,  1157,  1285,  1414,  1542,  1671,  1799,  1928,
+         2056,  2185,  2313,  2442,  2570,  2699,  2827,  2956,
+         3084,  3213,  3341,  3470,  3598,  3727,  3855,  3984,
+         4112,  4241,  4369,  4498,  4626,  4755,  4883,  5012,
+         5140,  5269,  5397,  5526,  5654,  5783,  5911,  6040,
+         6168,  6297,  6425,  6554,  6682,  6811,  6939,  7068,
+         7196,  7325,  7453,  7582,  7710,  7839,  7967,  8096,
+         8224,  8353,  8481,  8610,  8738,  8867,  8995,  9124,
+         9252,  9381,  9509,  9638,  9766,  9895, 10023, 10152,
+        10280, 10409, 10537, 10666, 10794, 10923, 11051, 11180,
+        11308, 11437, 11565, 11694, 11822, 11951, 12079, 12208,
+        12336, 12465, 12593, 12722, 12850, 12979, 13107, 13236,
+        13364, 13493, 13621, 13750, 13878, 14007, 14135, 14264,
+        14392, 14521, 14649, 14778, 14906, 15035, 15163, 15292,
+        15420, 15549, 15677, 15806, 15934, 16063, 16191, 16320,
+        16448, 16577, 16705, 16834, 16962, 17091, 17219, 17348,
+        17476, 17605, 17733, 17862, 17990, 18119, 18247, 18376,
+        18504, 18633, 18761, 18890, 19018, 19147, 19275, 19404,
+        19532, 19661, 19789, 19918, 20046, 20175, 20303, 20432,
+        20560, 20689, 20817, 20946, 21074, 21203, 21331, 21460,
+        21588, 21717, 21845, 21974, 22102, 22231, 22359, 22488,
+        22616, 22745, 22873, 23002, 23130, 23259, 23387, 23516,
+        23644, 23773, 23901, 24030, 24158, 24287, 24415, 24544,
+        24672, 24801, 24929, 25058, 25186, 25315, 25443, 25572,
+        25700, 25829, 25957, 26086, 26214, 26343, 26471, 26600,
+        26728, 26857, 26985, 27114, 27242, 27371, 27499, 27628,
+        27756, 27885, 28013, 28142, 28270, 28399, 28527, 28656,
+        28784, 28913, 29041, 29170, 29298, 29427, 29555, 29684,
+        29812, 29941, 30069, 30198, 30326, 30455, 30583, 30712,
+        30840, 30969, 31097, 31226, 31354, 31483, 31611, 31740,
+        31868, 31997, 32125, 32254, 32382, 32511, 32639, 32768,
+    },
+    {
+            0,    10,    19,    29,    40,    50,    60,    71,
+           82,    93,   104,   115,   127,   138,   150,   162,
+          174,   187,   199,   212,   225,   239,   252,   266,
+          279,   294,   308,   322,   337,   352,   367,   383,
+          399,   415,   431,   447,   464,   481,   498,   516,
+          534,   552,   570,   589,   608,   627,   647,   667,
+          687,   707,   728,   749,   771,   793,   815,   837,
+          860,   884,   907,   931,   956,   980,  1005,  1031,
+         1057,  1083,  1110,  1137,  1165,  1193,  1222,  1251,
+         1280,  1310,  1340,  1371,  1403,  1434,  1467,  1500,
+         1533,  1567,  1601,  1636,  1672,  1708,  1745,  1782,
+         1820,  1858,  1897,  1937,  1977,  2018,  2060,  2102,
+         2145,  2188,  2233,  2278,  2323,  2370,  2417,  2465,
+         2513,  2563,  2613,  2664,  2716,  2768,  2822,  2876,
+         2931,  2987,  3044,  3102,  3160,  3220,  3281,  3342,
+         3405,  3468,  3533,  3598,  3665,  3732,  3801,  3871,
+         3942,  4014,  4087,  4161,  4236,  4313,  4391,  4470,
+         4550,  4632,  4715,  4799,  4885,  4972,  5060,  5149,
+         5241,  5333,  5427,  5522,  5619,  5718,  5818,  5920,
+         6023,  6128,  6234,  6343,  6453,  6564,  6678,  6793,
+         6910,  7029,  7150,  7272,  7397,  7524,  7652,  7783,
+         7916,  8050,  8187,  8326,  8468,  8611,  8757,  8905,
+         9056,  9209,  9364,  9521,  9682,  9844, 10010, 10178,
+        10348, 10521, 10697, 10876, 11058, 11242, 11430, 11620,
+        11814, 12010, 12210, 12412, 12618, 12827, 13040, 13256,
+        13475, 13697, 13924, 14154, 14387, 14624, 14865, 15110,
+        15358, 15611, 15867, 16128, 16392, 16661, 16934, 17212,
+        17493, 17780, 18070, 18366, 18666, 18971, 19280, 19595,
+        19914, 20239, 20568, 20903, 21243, 21589, 21940, 22296,
+        22658, 23026, 23400, 23780, 24165, 24557, 24955, 25359,
+        25770, 26187, 26610, 27041, 27478, 27922, 28373, 28831,
+        29297, 29770, 30250, 30738, 31234, 31737, 32248, 32768,
+    },
+    {
+            0,   676,  1315,  1921,  2497,  3047,  3573,  4076,
+         4558,  5022,  5468,  5897,  6312,  6713,  7100,  7476,
+         7839,  8192,  8535,  8868,  9191,  9507,  9814, 10113,
+        10405, 10689, 10967, 11239, 11505, 11765, 12019, 12268,
+        12511, 12750, 12984, 13214, 13439, 13660, 13876, 14089,
+        14299, 14504, 14706, 14905, 15100, 15292, 15481, 15668,
+        15851, 16031, 16209, 16384, 16557, 16727, 16894, 17060,
+        17223, 17383, 17542, 17699, 17853, 18006, 18156, 18305,
+        18452, 18597, 18740, 18881, 19021, 19159, 19296, 19431,
+        19565, 19697, 19827, 19957, 20084, 20211, 20336, 20460,
+        20582, 20703, 20823, 20942, 21060, 21176, 21291, 21406,
+        21519, 21631, 21742, 21852, 21960, 22068, 22175, 22281,
+        22386, 22491, 22594, 22696, 22798, 22898, 22998, 23097,
+        23195, 23292, 23389, 23484, 23579, 23673, 23767, 23860,
+        23951, 24043, 24133, 24223, 24312, 24401, 24489, 24576,
+        24663, 24749, 24834, 24919, 25003, 25086, 25169, 25252,
+        25333, 25415, 25495, 25575, 25655, 25734, 25813, 25891,
+        25968, 26045, 26122, 26198, 26273, 26348, 26423, 26497,
+        26570, 26644, 26716, 26789, 26860, 26932, 27003, 27073,
+        27144, 27213, 27283, 27351, 27420, 27488, 27556, 27623,
+        27690, 27757, 27823, 27889, 27954, 28019, 28084, 28149,
+        28213, 28276, 28340, 28403, 28465, 28528, 28590, 28652,
+        28713, 28774, 28835, 28895, 28955, 29015, 29075, 29134,
+        29193, 29252, 29310, 29368, 29426, 29483, 29541, 29598,
+        29654, 29711, 29767, 29823, 29878, 29934, 29989, 30044,
+        30098, 30152, 30207, 30260, 30314, 30367, 30420, 30473,
+        30526, 30578, 30631, 30683, 30734, 30786, 30837, 30888,
+        30939, 30990, 31040, 31090, 31140, 31190, 31239, 31289,
+        31338, 31387, 31436, 31484, 31532, 31581, 31629, 31676,
+        31724, 31771, 31818, 31865, 31912, 31959, 32005, 32052,
+        32098, 32143, 32189, 32235, 32280, 32325, 32370, 32415,
+        32460, 32504, 32549, 32593, 32637, 32681, 32724, 32768,
+    },
+};
+
+/* Decay multiplier per 16-frame step, Q16: [d] reaches -60dB in d x 10ms */
+static const uint16_t mixer_decay[256] = {
+    65535, 51008, 57817, 60284, 61556, 62332, 62855, 63231,
+    63515, 63736, 63914, 64060, 64181, 64285, 64373, 64450,
+    64517, 64577, 64630, 64677, 64720, 64759, 64794, 64826,
+    64855, 64882, 64907, 64930, 64952, 64972, 64991, 65008,
+    65025, 65040, 65055, 65068, 65081, 65094, 65105, 65116,
+    65127, 65137, 65146, 65155, 65164, 65172, 65180, 65187,
+    65195, 65202, 65208, 65215, 65221, 65227, 65233, 65238,
+    65243, 65248, 65253, 65258, 65263, 65267, 65272, 65276,
+    65280, 65284, 65288, 65291, 65295, 65298, 65302, 65305,
+    65308, 65311, 65314, 65317, 65320, 65323, 65326, 65328,
+    65331, 65334, 65336, 65338, 65341, 65343, 65345, 65347,
+    65350, 65352, 65354, 65356, 65358, 65360, 65362, 65363,
+    65365, 65367, 65369, 65370, 65372, 65374, 65375, 65377,
+    65378, 65380, 65381, 65383, 65384, 65385, 65387, 65388,
+    65390, 65391, 65392, 65393, 65395, 65396, 65397, 65398,
+    65399, 65400, 65402, 65403, 65404, 65405, 65406, 65407,
+    65408, 65409, 65410, 65411, 65412, 65413, 65414, 65414,
+    65415, 65416, 65417, 65418, 65419, 65420, 65420, 65421,
+    65422, 65423, 65424, 65424, 65425, 65426, 65427, 65427,
+    65428, 65429, 65429, 65430, 65431, 65431, 65432, 65433,
+    65433, 65434, 65435, 65435, 65436, 65437, 65437, 65438,
+    65438, 65439, 65439, 65440, 65441, 65441, 65442, 65442,
+    65443, 65443, 65444, 65444, 65445, 65445, 65446, 65446,
+    65447, 65447, 65448, 65448, 65449, 65449, 65450, 65450,
+    65451, 65451, 65451, 65452, 65452, 65453, 65453, 65454,
+    65454, 65454, 65455, 65455, 65456, 65456, 65456, 65457,
+    65457, 65457, 65458, 65458, 65459, 65459, 65459, 65460,
+    65460, 65460, 65461, 65461, 65461, 65462, 65462, 65462,
+    65463, 65463, 65463, 65464, 65464, 65464, 65465, 65465,
+    65465, 65466, 65466, 65466, 65466, 65467, 65467, 65467,
+    65468, 65468, 65468, 65468, 65469, 65469, 65469, 65470,
+    65470, 65470, 65470, 65471, 65471, 65471, 65471, 65472,
+};
+
+/* SVF gain tan(pi * f / fs), f = 20 * 900^(c / 255) Hz */
+static const float mixer_svf_g[256] = {
+    1.42475954e-03f, 1.46327804e-03f, 1.50283789e-03f, 1.54346725e-03f,
+    1.58519503e-03f, 1.62805093e-03f, 1.67206545e-03f, 1.71726990e-03f,
+    1.76369648e-03f, 1.81137820e-03f, 1.86034901e-03f, 1.91064376e-03f,
+    1.96229824e-03f, 2.01534921e-03f, 2.06983442e-03f, 2.12579267e-03f,
+    2.18326375e-03f, 2.24228859e-03f, 2.30290919e-03f, 2.36516868e-03f,
+    2.42911138e-03f, 2.49478279e-03f, 2.56222966e-03f, 2.63149998e-03f,
+    2.70264305e-03f, 2.77570951e-03f, 2.85075135e-03f, 2.92782199e-03f,
+    3.00697627e-03f, 3.08827053e-03f, 3.17176263e-03f, 3.25751198e-03f,
+    3.34557963e-03f, 3.43602824e-03f, 3.52892219e-03f, 3.62432760e-03f,
+    3.72231237e-03f, 3.82294623e-03f, 3.92630082e-03f, 4.03244969e-03f,
+    4.14146840e-03f, 4.25343453e-03f, 4.36842778e-03f, 4.48653001e-03f,
+    4.60782526e-03f, 4.73239988e-03f, 4.86034253e-03f, 4.99174428e-03f,
+    5.12669866e-03f, 5.26530174e-03f, 5.40765217e-03f, 5.55385128e-03f,
+    5.70400313e-03f, 5.85821462e-03f, 6.01659551e-03f, 6.17925855e-03f,
+    6.34631954e-03f, 6.51789739e-03f, 6.69411426e-03f, 6.87509559e-03f,
+    7.06097024e-03f, 7.25187052e-03f, 7.44793235e-03f, 7.64929531e-03f,
+    7.85610278e-03f, 8.06850200e-03f, 8.28664421e-03f, 8.51068471e-03f,
+    8.74078306e-03f, 8.97710308e-03f, 9.21981308e-03f, 9.46908588e-03f,
+    9.72509901e-03f, 9.98803479e-03f, 1.02580805e-02f, 1.05354285e-02f,
+    1.08202762e-02f, 1.11128267e-02f, 1.14132882e-02f, 1.17218749e-02f,
+    1.20388066e-02f, 1.23643091e-02f, 1.26986142e-02f, 1.30419603e-02f,
+    1.33945920e-02f, 1.37567605e-02f, 1.41287240e-02f, 1.45107477e-02f,
+    1.49031038e-02f, 1.53060720e-02f, 1.57199397e-02f, 1.61450019e-02f,
+    1.65815618e-02f, 1.70299306e-02f, 1.74904283e-02f, 1.79633833e-02f,
+    1.84491330e-02f, 1.89480240e-02f, 1.94604123e-02f, 1.99866638e-02f,
+    2.05271540e-02f, 2.10822689e-02f, 2.16524048e-02f, 2.22379691e-02f,
+    2.28393800e-02f, 2.34570672e-02f, 2.40914723e-02f, 2.47430487e-02f,
+    2.54122624e-02f, 2.60995920e-02f, 2.68055293e-02f, 2.75305794e-02f,
+    2.82752614e-02f, 2.90401085e-02f, 2.98256686e-02f, 3.06325047e-02f,
+    3.14611952e-02f, 3.23123342e-02f, 3.31865326e-02f, 3.40844177e-02f,
+    3.50066343e-02f, 3.59538451e-02f, 3.69267308e-02f, 3.79259912e-02f,
+    3.89523454e-02f, 4.00065324e-02f, 4.10893119e-02f, 4.22014646e-02f,
+    4.33437929e-02f, 4.45171216e-02f, 4.57222987e-02f, 4.69601959e-02f,
+    4.82317092e-02f, 4.95377599e-02f, 5.08792953e-02f, 5.22572895e-02f,
+    5.36727438e-02f, 5.51266884e-02f, 5.66201823e-02f, 5.81543152e-02f,
+    5.97302075e-02f, 6.13490119e-02f, 6.30119145e-02f, 6.47201351e-02f,
+    6.64749293e-02f, 6.82775888e-02f, 7.01294434e-02f, 7.20318614e-02f,
+    7.39862516e-02f, 7.59940643e-02f, 7.80567927e-02f, 8.01759747e-02f,
+    8.23531942e-02f, 8.45900826e-02f, 8.68883208e-02f, 8.92496408e-02f,
+    9.16758278e-02f, 9.41687217e-02f, 9.67302196e-02f, 9.93622777e-02f,
+    1.02066914e-01f, 1.04846209e-01f, 1.07702312e-01f, 1.10637440e-01f,
+    1.13653881e-01f, 1.16753998e-01f, 1.19940235e-01f, 1.23215113e-01f,
+    1.26581240e-01f, 1.30041313e-01f, 1.33598120e-01f, 1.37254546e-01f,
+    1.41013578e-01f, 1.44878308e-01f, 1.48851940e-01f, 1.52937793e-01f,
+    1.57139308e-01f, 1.61460056e-01f, 1.65903742e-01f, 1.70474211e-01f,
+    1.75175460e-01f, 1.80011642e-01f, 1.84987077e-01f, 1.90106260e-01f,
+    1.95373872e-01f, 2.00794790e-01f, 2.06374098e-01f, 2.12117102e-01f,
+    2.18029343e-01f, 2.24116609e-01f, 2.30384953e-01f, 2.36840712e-01f,
+    2.43490523e-01f, 2.50341343e-01f, 2.57400475e-01f, 2.64675586e-01f,
+    2.72174741e-01f, 2.79906426e-01f, 2.87879580e-01f, 2.96103631e-01f,
+    3.04588537e-01f, 3.13344818e-01f, 3.22383613e-01f, 3.31716721e-01f,
+    3.41356663e-01f, 3.51316737e-01f, 3.61611091e-01f, 3.72254798e-01f,
+    3.83263933e-01f, 3.94655673e-01f, 4.06448397e-01f, 4.18661800e-01f,
+    4.31317025e-01f, 4.44436805e-01f, 4.58045627e-01f, 4.72169914e-01f,
+    4.86838231e-01f, 5.02081520e-01f, 5.17933363e-01f, 5.34430286e-01f,
+    5.51612099e-01f, 5.69522293e-01f, 5.88208488e-01f, 6.07722954e-01f,
+    6.28123210e-01f, 6.49472720e-01f, 6.71841703e-01f, 6.95308075e-01f,
+    7.19958563e-01f, 7.45890004e-01f, 7.73210900e-01f, 8.02043249e-01f,
+    8.32524747e-01f, 8.64811434e-01f, 8.99080888e-01f, 9.35536119e-01f,
+    9.74410335e-01f, 1.01597282e+00f, 1.06053627e+00f, 1.10846594e+00f,
+    1.16019127e+00f, 1.21622068e+00f, 1.27716078e+00f, 1.34374127e+00f,
+    1.41684806e+00f, 1.49756756e+00f, 1.58724695e+00f, 1.68757771e+00f,
+    1.80071335e+00f, 1.92943910e+00f, 2.07742235e+00f, 2.24959246e+00f,
+    2.45273545e+00f, 2.69646006e+00f, 2.99483710e+00f, 3.36933183e+00f,
+};
+
+#endif
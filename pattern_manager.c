@@ -5,10 +5,156 @@
 #include <string.h>
 #include <strings.h>
 
-int Pattern_Save(Pattern *pattern, uint8_t slot) {
-  if (slot < 1 || slot > 100)
+/* Pattern bank (PATTERNS.BNK): header sector + one sector per slot.
+ * Slot N lives at sector N of the file, so load/save/occupancy need no
+ * directory walk once the bank is open. Must be contiguous on the card.
+ */
+#define BANK_FILENAME "PATTERNS.BNK"
+#define BANK_MAGIC "PBNK"
+#define BANK_VERSION 1
+#define BANK_SLOTS 100
+#define BANK_SECTOR_SIZE 512
+#define BANK_FILE_SIZE ((BANK_SLOTS + 1) * BANK_SECTOR_SIZE)
+
+/* Slots, files and the cache all assume a pattern fits in one sector */
+typedef char
+    pattern_fits_sector[(sizeof(Pattern) <= BANK_SECTOR_SIZE) ? 1 : -1];
+
+typedef struct {
+  char magic[4];          /* "PBNK" */
+  uint16_t version;       /* BANK_VERSION */
+  uint16_t slot_count;    /* BANK_SLOTS */
+  uint16_t record_size;   /* sizeof(Pattern) */
+  uint16_t reserved;
+  uint8_t occupied[(BANK_SLOTS + 7) / 8]; /* Bit (slot-1) set = in use */
+} __attribute__((packed)) PatternBankHeader;
+
+#define BANK_BIT_GET(h, slot)                                                  \
+  (((h).occupied[((slot) - 1) >> 3] >> (((slot) - 1) & 7)) & 1)
+#define BANK_BIT_SET(h, slot)                                                  \
+  ((h).occupied[((slot) - 1) >> 3] |= (uint8_t)(1 << (((slot) - 1) & 7)))
+
+/* 0 = not opened yet, 1 = bank ready, -1 = use per-file patterns */
+static int8_t bank_state = 0;
+static uint32_t bank_sector = 0; /* First sector of PATTERNS.BNK */
+static PatternBankHeader bank_header;
+static uint8_t sector_buffer[BANK_SECTOR_SIZE];
+
+/**
+ * @brief Write the bank header (with occupancy bitmap) to sector 0
+ * @return 0 on success, -1 on error
+ */
+static int bank_write_header(void) {
+  memset(sector_buffer, 0, sizeof(sector_buffer));
+  memcpy(sector_buffer, &bank_header, sizeof(bank_header));
+  if (SDCARD_WriteBlock(bank_sector, sector_buffer) != SDCARD_OK)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Create PATTERNS.BNK and copy existing PAT-XXX.PAT files into it
+ * @return 0 on success, negative on error
+ */
+static int bank_create(uint32_t patterns_cluster, FAT32_FileEntry *files,
+                       int count) {
+  if (FAT32_CreateContiguous(patterns_cluster, BANK_FILENAME, BANK_FILE_SIZE,
+                             &bank_sector) != 0)
+    return -1;
+
+  memset(&bank_header, 0, sizeof(bank_header));
+  memcpy(bank_header.magic, BANK_MAGIC, 4);
+  bank_header.version = BANK_VERSION;
+  bank_header.slot_count = BANK_SLOTS;
+  bank_header.record_size = sizeof(Pattern);
+
+  for (int i = 0; i < count; i++) {
+    int slot_num;
+    if (strncmp(files[i].name, "PAT-", 4) != 0 ||
+        sscanf(files[i].name + 4, "%d", &slot_num) != 1 || slot_num < 1 ||
+        slot_num > BANK_SLOTS)
+      continue;
+
+    if (SDCARD_ReadBlock(FAT32_GetFileSector(&files[i]), sector_buffer) !=
+        SDCARD_OK)
+      continue;
+
+    /* Skip records the loader would reject anyway */
+    Pattern *p = (Pattern *)sector_buffer;
+    if (p->step_count == 0 || p->step_count > MAX_STEPS)
+      continue;
+
+    /* Older, shorter files: fields they lack read back as zero */
+    uint32_t record = (files[i].size < sizeof(Pattern)) ? files[i].size
+                                                        : sizeof(Pattern);
+    memset(sector_buffer + record, 0, sizeof(sector_buffer) - record);
+    if (SDCARD_WriteBlock(bank_sector + slot_num, sector_buffer) != SDCARD_OK)
+      return -1;
+    BANK_BIT_SET(bank_header, slot_num);
+  }
+
+  /* Header goes last: an interrupted migration is simply redone */
+  return bank_write_header();
+}
+
+/**
+ * @brief Open (or create) the pattern bank on first use
+ * @return 1 if the bank is usable, -1 to fall back to per-file patterns
+ */
+static int bank_open(void) {
+  if (bank_state != 0)
+    return bank_state;
+
+  uint32_t patterns_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
+  if (patterns_cluster == 0)
+    return -1; /* Retry once the directory exists */
+
+  FAT32_FileEntry files[FAT32_MAX_FILES];
+  int count = FAT32_ListDir(patterns_cluster, files, FAT32_MAX_FILES);
+  if (count < 0)
     return -1;
 
+  for (int i = 0; i < count; i++) {
+    if (strcasecmp(files[i].name, BANK_FILENAME) != 0)
+      continue;
+
+    if (files[i].size >= BANK_FILE_SIZE && FAT32_IsContiguous(&files[i])) {
+      bank_sector = FAT32_GetFileSector(&files[i]);
+      if (SDCARD_ReadBlock(bank_sector, sector_buffer) == SDCARD_OK) {
+        memcpy(&bank_header, sector_buffer, sizeof(bank_header));
+        if (memcmp(bank_header.magic, BANK_MAGIC, 4) == 0 &&
+            bank_header.version == BANK_VERSION &&
+            bank_header.slot_count == BANK_SLOTS &&
+            bank_header.record_size >= PATTERN_V1_SIZE &&
+            bank_header.record_size <= sizeof(Pattern)) {
+          /* Records are zero padded, so shorter ones extend in place */
+          if (bank_header.record_size < sizeof(Pattern)) {
+            bank_header.record_size = sizeof(Pattern);
+            if (bank_write_header() != 0)
+              return -1;
+          }
+          bank_state = 1;
+          return bank_state;
+        }
+      }
+    }
+    break; /* Unusable bank: rebuild it below */
+  }
+
+  /* Bank exists past the listing limit: never overwrite it blindly */
+  if (count == FAT32_MAX_FILES &&
+      FAT32_FileExists(patterns_cluster, BANK_FILENAME)) {
+    bank_state = -1;
+    return bank_state;
+  }
+
+  bank_state = (bank_create(patterns_cluster, files, count) == 0) ? 1 : -1;
+  return bank_state;
+}
+
+/* Per-file PAT-XXX.PAT access, used when the bank cannot be created */
+
+static int file_save(Pattern *pattern, uint8_t slot) {
   // Find PATTERNS directory
   uint32_t patterns_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
   if (patterns_cluster == 0) {
@@ -24,10 +170,7 @@ int Pattern_Save(Pattern *pattern, uint8_t slot) {
                          sizeof(Pattern));
 }
 
-int Pattern_Load(Pattern *pattern, uint8_t slot) {
-  if (slot < 1 || slot > 100)
-    return -1;
-
+static int file_load(Pattern *pattern, uint8_t slot) {
   // Find PATTERNS directory
   uint32_t patterns_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
   if (patterns_cluster == 0)
@@ -37,10 +180,6 @@ int Pattern_Load(Pattern *pattern, uint8_t slot) {
   char filename[13];
   snprintf(filename, sizeof(filename), "PAT-%03d.PAT", slot);
 
-  // Check if file exists
-  if (!FAT32_FileExists(patterns_cluster, filename))
-    return -1;
-
   // Find the file entry
   FAT32_FileEntry files[FAT32_MAX_FILES];
   int count = FAT32_ListDir(patterns_cluster, files, FAT32_MAX_FILES);
@@ -57,28 +196,19 @@ int Pattern_Load(Pattern *pattern, uint8_t slot) {
     return -1;
 
   // Read first sector
-  uint32_t sector = FAT32_GetFileSector(target_file);
-  uint8_t sector_buffer[512];
-
-  if (SDCARD_ReadBlock(sector, sector_buffer) != SDCARD_OK)
+  if (SDCARD_ReadBlock(FAT32_GetFileSector(target_file), sector_buffer) !=
+      SDCARD_OK)
     return -1;
 
-  // Copy binary data to pattern struct
-  if (target_file->size > sizeof(Pattern)) {
-    // File is larger than expected, but we only need sizeof(Pattern)
-  }
-
-  memcpy(pattern, sector_buffer, sizeof(Pattern));
-
-  /* Validation: step_count must be in range [1, MAX_STEPS] */
-  if (pattern->step_count == 0 || pattern->step_count > MAX_STEPS) {
-    return -2; /* Invalid pattern data */
-  }
-
+  // Older, shorter files: fields they lack read back as zero
+  memset(pattern, 0, sizeof(Pattern));
+  memcpy(pattern, sector_buffer,
+         (target_file->size < sizeof(Pattern)) ? target_file->size
+                                               : sizeof(Pattern));
   return 0;
 }
 
-int Pattern_GetOccupiedSlots(uint8_t *slots, int max_slots) {
+static int file_get_occupied(uint8_t *slots, int max_slots) {
   uint32_t patterns_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "PATTERNS");
   if (patterns_cluster == 0)
     return 0;
@@ -100,3 +230,175 @@ int Pattern_GetOccupiedSlots(uint8_t *slots, int max_slots) {
 
   return occupied_count;
 }
+
+/* RAM pattern cache ------------------------------------------------------ */
+
+typedef struct {
+  uint8_t slot;      /* 0 = free */
+  uint32_t last_use; /* LRU stamp */
+  Pattern pattern;
+} PatternCacheEntry;
+
+static PatternCacheEntry cache[PATTERN_CACHE_SLOTS];
+static uint32_t cache_clock = 0;
+static uint32_t cache_hits = 0;
+static uint32_t cache_misses = 0;
+static uint8_t prefetch_slot = 1; /* Next slot the background fill checks */
+
+static PatternCacheEntry *cache_find(uint8_t slot) {
+  for (int i = 0; i < PATTERN_CACHE_SLOTS; i++) {
+    if (cache[i].slot == slot)
+      return &cache[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Get a free entry, evicting the least recently used if allowed
+ * @return Entry, or NULL if full and evict is 0
+ */
+static PatternCacheEntry *cache_claim(int evict) {
+  PatternCacheEntry *victim = NULL;
+  for (int i = 0; i < PATTERN_CACHE_SLOTS; i++) {
+    if (cache[i].slot == 0)
+      return &cache[i];
+    if (!victim || cache[i].last_use < victim->last_use)
+      victim = &cache[i];
+  }
+  return evict ? victim : NULL;
+}
+
+static void cache_store(uint8_t slot, const Pattern *pattern) {
+  PatternCacheEntry *e = cache_find(slot);
+  if (!e)
+    e = cache_claim(1);
+  e->slot = slot;
+  e->last_use = ++cache_clock;
+  memcpy(&e->pattern, pattern, sizeof(Pattern));
+}
+
+/**
+ * @brief Read and validate a slot from the card
+ * @return 0 on success, -1 on error, -2 on invalid pattern data
+ */
+static int read_slot(Pattern *pattern, uint8_t slot) {
+  if (bank_open() == 1) {
+    if (!BANK_BIT_GET(bank_header, slot))
+      return -1;
+    if (SDCARD_ReadBlock(bank_sector + slot, sector_buffer) != SDCARD_OK)
+      return -1;
+    memcpy(pattern, sector_buffer, sizeof(Pattern));
+  } else if (file_load(pattern, slot) != 0) {
+    return -1;
+  }
+
+  /* Validation: step_count must be in range [1, MAX_STEPS] */
+  if (pattern->step_count == 0 || pattern->step_count > MAX_STEPS) {
+    return -2; /* Invalid pattern data */
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Write a slot to the bank
+ * @return 0 on success, -1 on error
+ */
+static int write_slot(Pattern *pattern, uint8_t slot) {
+  memset(sector_buffer, 0, sizeof(sector_buffer));
+  memcpy(sector_buffer, pattern, sizeof(Pattern));
+  if (SDCARD_WriteBlock(bank_sector + slot, sector_buffer) != SDCARD_OK)
+    return -1;
+
+  /* Record first, bitmap second: a torn save never exposes garbage */
+  if (!BANK_BIT_GET(bank_header, slot)) {
+    BANK_BIT_SET(bank_header, slot);
+    return bank_write_header();
+  }
+  return 0;
+}
+
+int Pattern_Save(Pattern *pattern, uint8_t slot) {
+  if (slot < 1 || slot > 100)
+    return -1;
+
+  int res = (bank_open() == 1) ? write_slot(pattern, slot)
+                               : file_save(pattern, slot);
+
+  /* Write-through: RAM copy only ever mirrors what reached the card */
+  PatternCacheEntry *e = cache_find(slot);
+  if (res == 0)
+    cache_store(slot, pattern);
+  else if (e)
+    e->slot = 0;
+
+  return res;
+}
+
+int Pattern_Load(Pattern *pattern, uint8_t slot) {
+  if (slot < 1 || slot > 100)
+    return -1;
+
+  PatternCacheEntry *e = cache_find(slot);
+  if (e) {
+    e->last_use = ++cache_clock;
+    cache_hits++;
+    memcpy(pattern, &e->pattern, sizeof(Pattern));
+    return 0;
+  }
+
+  cache_misses++;
+  int res = read_slot(pattern, slot);
+  if (res == 0)
+    cache_store(slot, pattern);
+  return res;
+}
+
+int Pattern_GetOccupiedSlots(uint8_t *slots, int max_slots) {
+  if (bank_open() != 1)
+    return file_get_occupied(slots, max_slots);
+
+  /* Served from the in-RAM bitmap, no card access */
+  int occupied_count = 0;
+  for (int slot = 1; slot <= BANK_SLOTS && occupied_count < max_slots;
+       slot++) {
+    if (BANK_BIT_GET(bank_header, slot))
+      slots[occupied_count++] = (uint8_t)slot;
+  }
+  return occupied_count;
+}
+
+void Pattern_CachePoll(void) {
+  /* Background fill only from the bank, and never evicts */
+  if (bank_state != 1)
+    return;
+
+  while (prefetch_slot <= BANK_SLOTS) {
+    uint8_t slot = prefetch_slot++;
+    if (!BANK_BIT_GET(bank_header, slot) || cache_find(slot))
+      continue;
+
+    PatternCacheEntry *e = cache_claim(0);
+    if (!e) {
+      prefetch_slot = BANK_SLOTS + 1; /* Cache full: stop filling */
+      return;
+    }
+    if (read_slot(&e->pattern, slot) == 0) {
+      e->slot = slot;
+      e->last_use = 0; /* Prefetched entries are evicted first */
+    }
+    return; /* One sector per call */
+  }
+}
+
+void Pattern_GetCacheStats(PatternCacheStats *stats) {
+  stats->hits = cache_hits;
+  stats->misses = cache_misses;
+  stats->capacity = PATTERN_CACHE_SLOTS;
+  stats->resident = 0;
+  for (int i = 0; i < PATTERN_CACHE_SLOTS; i++) {
+    if (cache[i].slot != 0)
+      stats->resident++;
+  }
+  stats->bytes = sizeof(cache);
+}
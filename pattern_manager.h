@@ -4,10 +4,34 @@
 #include "sequencer.h"
 #include <stdint.h>
 
+/* Patterns kept in RAM (520 bytes each: one 512-byte Pattern plus its
+ * slot and LRU stamp), override with -D. Kept small: every slot comes
+ * out of the same 128KB as the sample arena and the effects RAM. */
+#ifndef PATTERN_CACHE_SLOTS
+#define PATTERN_CACHE_SLOTS 4
+#endif
+
+/**
+ * @brief Pattern cache statistics
+ */
+typedef struct {
+  uint32_t hits;     /* Loads served from RAM */
+  uint32_t misses;   /* Loads that had to read the card */
+  uint8_t resident;  /* Slots currently held in RAM */
+  uint8_t capacity;  /* PATTERN_CACHE_SLOTS */
+  uint32_t bytes;    /* RAM used by the cache */
+} PatternCacheStats;
+
+/* Patterns live in /PATTERNS/PATTERNS.BNK (one sector per slot). The bank is
+ * created on first use from any existing PAT-XXX.PAT files; if it cannot be
+ * created the per-file layout is used instead.
+ */
+
 /**
  * @brief Save pattern to a slot
  * @param pattern Pointer to pattern to save
  * @param slot Slot number (1-100)
+ * @details Written to the card first, then mirrored into the RAM cache
  * @return 0 on success, -1 on error
  */
 int Pattern_Save(Pattern *pattern, uint8_t slot);
@@ -16,7 +40,8 @@ int Pattern_Save(Pattern *pattern, uint8_t slot);
  * @brief Load pattern from a slot
  * @param pattern Pointer to load pattern into
  * @param slot Slot number (1-100)
- * @return 0 on success, -1 on error
+ * @details Served from the RAM cache when resident, otherwise read and cached
+ * @return 0 on success, -1 on error, -2 on invalid pattern data
  */
 int Pattern_Load(Pattern *pattern, uint8_t slot);
 
@@ -24,8 +49,21 @@ int Pattern_Load(Pattern *pattern, uint8_t slot);
  * @brief Get list of occupied slots for patterns
  * @param slots Array to store occupied slot numbers
  * @param max_slots Maximum number of slots to find
- * @return Number of occupied slots found
+ * @return Number of occupied slots found (from RAM once the bank is open)
  */
 int Pattern_GetOccupiedSlots(uint8_t *slots, int max_slots);
 
+/**
+ * @brief Fill the pattern cache in the background
+ * @details Reads at most one occupied slot per call until the cache is full.
+ *          Call from the main loop.
+ */
+void Pattern_CachePoll(void);
+
+/**
+ * @brief Get pattern cache statistics
+ * @param stats Structure to fill
+ */
+void Pattern_GetCacheStats(PatternCacheStats *stats);
+
 #endif
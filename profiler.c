@@ -0,0 +1,130 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLE
+
+#include <stddef.h>
+#include <string.h>
+
+#define PROF_DEPTH 8 /* Nesting: main loop, SD, interrupts of each level */
+
+static const volatile uint32_t *cycle_counter = NULL;
+static uint32_t last_switch = 0;    /* Cycle count when `current` began */
+static uint32_t snapshot_start = 0; /* Cycle count of the last snapshot */
+static uint8_t current = PROF_OTHER;
+
+/* Sources interrupted by Enter, and when each Enter happened */
+static uint8_t depth = 0;
+static uint8_t stack[PROF_DEPTH];
+static uint32_t entered[PROF_DEPTH];
+
+/* Since the last snapshot */
+static uint32_t acc_cycles[PROF_SOURCES];
+static uint32_t acc_calls[PROF_SOURCES];
+static uint32_t acc_max[PROF_SOURCES];
+
+/* Enter and Exit run from every interrupt level: keep each switch whole */
+static inline uint32_t irq_save(void) {
+#if defined(__arm__)
+  uint32_t primask;
+  __asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask) : : "memory");
+  return primask;
+#else
+  return 0;
+#endif
+}
+
+static inline void irq_restore(uint32_t primask) {
+#if defined(__arm__)
+  __asm volatile("msr primask, %0" : : "r"(primask) : "memory");
+#else
+  (void)primask;
+#endif
+}
+
+/**
+ * @brief Charge the time since the last switch to the running source
+ * @return Current cycle count
+ */
+static uint32_t charge(void) {
+  uint32_t now = *cycle_counter;
+  acc_cycles[current] += now - last_switch;
+  last_switch = now;
+  return now;
+}
+
+void Profiler_Init(const volatile uint32_t *counter) {
+  uint32_t primask = irq_save();
+  cycle_counter = counter;
+  current = PROF_OTHER;
+  depth = 0;
+  memset(acc_cycles, 0, sizeof(acc_cycles));
+  memset(acc_calls, 0, sizeof(acc_calls));
+  memset(acc_max, 0, sizeof(acc_max));
+  if (counter) {
+    last_switch = *counter;
+    snapshot_start = last_switch;
+  }
+  irq_restore(primask);
+}
+
+void Profiler_Enter(uint8_t source) {
+  if (!cycle_counter || source >= PROF_SOURCES)
+    return;
+
+  uint32_t primask = irq_save();
+  uint32_t now = charge();
+  if (depth < PROF_DEPTH) {
+    stack[depth] = current;
+    entered[depth] = now;
+  }
+  depth++;
+  current = source;
+  acc_calls[source]++;
+  irq_restore(primask);
+}
+
+void Profiler_Exit(void) {
+  if (!cycle_counter)
+    return;
+
+  uint32_t primask = irq_save();
+  uint32_t now = charge();
+  if (depth > 0) {
+    depth--;
+    /* Deeper than the stack: lose the attribution, keep the balance */
+    if (depth < PROF_DEPTH) {
+      uint32_t took = now - entered[depth];
+      if (took > acc_max[current])
+        acc_max[current] = took;
+      current = stack[depth];
+    }
+  }
+  irq_restore(primask);
+}
+
+void Profiler_Snapshot(ProfilerStats *stats) {
+  memset(stats, 0, sizeof(*stats));
+  if (!cycle_counter)
+    return;
+
+  uint32_t primask = irq_save();
+  uint32_t now = charge();
+  stats->elapsed = now - snapshot_start;
+  snapshot_start = now;
+  memcpy(stats->cycles, acc_cycles, sizeof(acc_cycles));
+  memcpy(stats->calls, acc_calls, sizeof(acc_calls));
+  memcpy(stats->max_cycles, acc_max, sizeof(acc_max));
+  memset(acc_cycles, 0, sizeof(acc_cycles));
+  memset(acc_calls, 0, sizeof(acc_calls));
+  memset(acc_max, 0, sizeof(acc_max));
+  irq_restore(primask);
+
+  if (stats->elapsed == 0)
+    return;
+  for (int i = 0; i < PROF_SOURCES; i++)
+    stats->load[i] =
+        (uint16_t)((uint64_t)stats->cycles[i] * 1000 / stats->elapsed);
+  stats->busy = (uint16_t)(1000 - stats->load[PROF_IDLE]);
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+/* Build with -DPROFILER_ENABLE=0 (make PROFILER=0) to compile it all out */
+#ifndef PROFILER_ENABLE
+#define PROFILER_ENABLE 1
+#endif
+
+/* Where time goes: interrupts, then main loop work */
+#define PROF_AUDIO 0    /* DMA1_Stream4: mixer render */
+#define PROF_CLOCK 1    /* TIM2: sequencer steps */
+#define PROF_PADS 2     /* EXTI15_10: trigger pads */
+#define PROF_INPUT 3    /* EXTI0/1/9_5: encoder and buttons */
+#define PROF_DEBOUNCE 4 /* TIM5: button debounce */
+#define PROF_SYSTICK 5  /* SysTick: millisecond tick */
+#define PROF_UI 6       /* Display drawing */
+#define PROF_SD 7       /* SD card block transfers */
+#define PROF_EVENTS 8   /* Button event handling (menus, loads, saves) */
+#define PROF_IDLE 9     /* Waiting for an interrupt */
+#define PROF_OTHER 10   /* Rest of the main loop */
+#define PROF_SOURCES 11
+
+/**
+ * @brief Profile snapshot (time since the previous snapshot)
+ * @details Time is exclusive: an interrupt taken during SD I/O counts
+ *          for the interrupt, not for the SD card.
+ */
+typedef struct {
+  uint32_t elapsed;                  /* Cycles covered by the snapshot */
+  uint32_t cycles[PROF_SOURCES];     /* Cycles spent in each source */
+  uint32_t calls[PROF_SOURCES];      /* Entries into each source */
+  uint32_t max_cycles[PROF_SOURCES]; /* Longest single entry */
+  uint16_t load[PROF_SOURCES];       /* Share of elapsed, per mille */
+  uint16_t busy;                     /* Everything but idle, per mille */
+} ProfilerStats;
+
+#if PROFILER_ENABLE
+
+/**
+ * @brief Start profiling against a free-running cycle counter
+ * @details Time before the first Enter counts as PROF_OTHER.
+ * @param counter Counter register (e.g. the DWT cycle counter)
+ */
+void Profiler_Init(const volatile uint32_t *counter);
+
+/**
+ * @brief Start charging time to a source
+ * @details Pairs with Profiler_Exit and nests (interrupts, calls).
+ * @param source PROF_* value
+ */
+void Profiler_Enter(uint8_t source);
+
+/**
+ * @brief Go back to charging the source that was running before Enter
+ */
+void Profiler_Exit(void);
+
+/**
+ * @brief Take the time since the previous snapshot and start a new one
+ * @param stats Structure to fill
+ */
+void Profiler_Snapshot(ProfilerStats *stats);
+
+#define PROFILE_ENTER(source) Profiler_Enter(source)
+#define PROFILE_EXIT() Profiler_Exit()
+
+#else
+
+#define PROFILE_ENTER(source) ((void)0)
+#define PROFILE_EXIT() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+/* Build with -DRAMFUNC_ENABLE=1 (make PROFILE=release) to run the marked
+ * functions from SRAM: STM32F411.ld links them into .ramfunc, copied from
+ * flash by the startup code like .data. Only the audio interrupt's per
+ * sample code is marked (the mixer's voice, filter and master loops, and
+ * ratchet restarts); once per block work (the command queues, effects
+ * pass) and the clock interrupt, at most 120 times a second, stay in
+ * flash behind the ART cache. .ramfunc counts against the same 128KB as
+ * everything else, so a set that outgrows it fails the link. */
+#ifndef RAMFUNC_ENABLE
+#define RAMFUNC_ENABLE 0
+#endif
+
+#if RAMFUNC_ENABLE && defined(__arm__)
+#define RAMFUNC __attribute__((section(".ramfunc")))
+#else
+#define RAMFUNC
+#endif
+
+#endif
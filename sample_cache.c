@@ -0,0 +1,195 @@
+#include "sample_cache.h"
+#include <string.h>
+
+/* Cache entry: one decoded WAV living somewhere in the arena */
+typedef struct {
+  uint32_t first_cluster; /* File identity (with file_size) */
+  uint32_t file_size;
+  uint32_t offset;   /* Start in arena (samples) */
+  uint32_t length;   /* Loaded samples (capacity until committed) */
+  uint32_t last_use; /* LRU stamp */
+  uint8_t refcount;  /* Channels currently using this entry */
+  uint8_t in_use;    /* Entry occupies arena space */
+  uint8_t committed; /* Sample data is valid */
+} SampleCacheEntry;
+
+static int16_t arena[SAMPLE_CACHE_ARENA_SAMPLES];
+static SampleCacheEntry entries[SAMPLE_CACHE_MAX_ENTRIES];
+static uint32_t use_clock = 0;
+static uint32_t stat_hits = 0;
+static uint32_t stat_misses = 0;
+static uint32_t stat_evictions = 0;
+
+void SampleCache_Init(void) {
+  memset(entries, 0, sizeof(entries));
+  use_clock = 0;
+  stat_hits = 0;
+  stat_misses = 0;
+  stat_evictions = 0;
+}
+
+static int valid_handle(int handle) {
+  return handle >= 0 && handle < SAMPLE_CACHE_MAX_ENTRIES &&
+         entries[handle].in_use;
+}
+
+int SampleCache_Find(uint32_t first_cluster, uint32_t file_size) {
+  for (int i = 0; i < SAMPLE_CACHE_MAX_ENTRIES; i++) {
+    SampleCacheEntry *e = &entries[i];
+    if (e->in_use && e->committed && e->first_cluster == first_cluster &&
+        e->file_size == file_size) {
+      e->refcount++;
+      e->last_use = ++use_clock;
+      stat_hits++;
+      return i;
+    }
+  }
+  stat_misses++;
+  return -1;
+}
+
+/**
+ * @brief Find a free arena gap of the requested size (first fit)
+ * @return Offset in samples, or SAMPLE_CACHE_ARENA_SAMPLES if none
+ */
+static uint32_t find_gap(uint32_t samples) {
+  /* Candidate starts: arena start and the end of every resident entry */
+  for (int c = -1; c < SAMPLE_CACHE_MAX_ENTRIES; c++) {
+    uint32_t start = 0;
+    if (c >= 0) {
+      if (!entries[c].in_use)
+        continue;
+      start = entries[c].offset + entries[c].length;
+    }
+    if (start + samples > SAMPLE_CACHE_ARENA_SAMPLES)
+      continue;
+
+    int overlaps = 0;
+    for (int i = 0; i < SAMPLE_CACHE_MAX_ENTRIES; i++) {
+      if (!entries[i].in_use)
+        continue;
+      if (start < entries[i].offset + entries[i].length &&
+          entries[i].offset < start + samples) {
+        overlaps = 1;
+        break;
+      }
+    }
+    if (!overlaps)
+      return start;
+  }
+  return SAMPLE_CACHE_ARENA_SAMPLES;
+}
+
+/**
+ * @brief Evict the least recently used unreferenced entry
+ * @return 1 if an entry was evicted, 0 if everything is referenced
+ */
+static int evict_lru(void) {
+  int victim = -1;
+  for (int i = 0; i < SAMPLE_CACHE_MAX_ENTRIES; i++) {
+    if (entries[i].in_use && entries[i].refcount == 0) {
+      if (victim < 0 || entries[i].last_use < entries[victim].last_use)
+        victim = i;
+    }
+  }
+  if (victim < 0)
+    return 0;
+
+  entries[victim].in_use = 0;
+  entries[victim].committed = 0;
+  stat_evictions++;
+  return 1;
+}
+
+int SampleCache_Allocate(uint32_t first_cluster, uint32_t file_size,
+                         uint32_t max_samples) {
+  if (max_samples == 0 || max_samples > SAMPLE_CACHE_ARENA_SAMPLES)
+    return -1;
+
+  while (1) {
+    int slot = -1;
+    for (int i = 0; i < SAMPLE_CACHE_MAX_ENTRIES; i++) {
+      if (!entries[i].in_use) {
+        slot = i;
+        break;
+      }
+    }
+
+    uint32_t offset = (slot >= 0) ? find_gap(max_samples)
+                                  : SAMPLE_CACHE_ARENA_SAMPLES;
+    if (offset < SAMPLE_CACHE_ARENA_SAMPLES) {
+      SampleCacheEntry *e = &entries[slot];
+      e->first_cluster = first_cluster;
+      e->file_size = file_size;
+      e->offset = offset;
+      e->length = max_samples;
+      e->last_use = ++use_clock;
+      e->refcount = 1;
+      e->in_use = 1;
+      e->committed = 0;
+      return slot;
+    }
+
+    /* No entry slot or no gap: make room and retry */
+    if (!evict_lru())
+      return -1;
+  }
+}
+
+void SampleCache_Commit(int handle, uint32_t length) {
+  if (!valid_handle(handle))
+    return;
+  if (length < entries[handle].length)
+    entries[handle].length = length; /* Return the tail to the arena */
+  entries[handle].committed = 1;
+}
+
+void SampleCache_AddRef(int handle) {
+  if (!valid_handle(handle))
+    return;
+  entries[handle].refcount++;
+  entries[handle].last_use = ++use_clock;
+}
+
+void SampleCache_Release(int handle) {
+  if (!valid_handle(handle))
+    return;
+
+  SampleCacheEntry *e = &entries[handle];
+  if (e->refcount > 0)
+    e->refcount--;
+
+  /* Keep loaded samples resident for later kits, drop failed loads */
+  if (e->refcount == 0 && !e->committed)
+    e->in_use = 0;
+}
+
+int16_t *SampleCache_GetData(int handle) {
+  if (!valid_handle(handle))
+    return NULL;
+  return &arena[entries[handle].offset];
+}
+
+uint32_t SampleCache_GetLength(int handle) {
+  if (!valid_handle(handle))
+    return 0;
+  return entries[handle].length;
+}
+
+void SampleCache_GetStats(SampleCacheStats *stats) {
+  stats->hits = stat_hits;
+  stats->misses = stat_misses;
+  stats->evictions = stat_evictions;
+  stats->resident = 0;
+  stats->referenced = 0;
+  stats->used_samples = 0;
+
+  for (int i = 0; i < SAMPLE_CACHE_MAX_ENTRIES; i++) {
+    if (!entries[i].in_use)
+      continue;
+    stats->resident++;
+    stats->used_samples += entries[i].length;
+    if (entries[i].refcount > 0)
+      stats->referenced++;
+  }
+}
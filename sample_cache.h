@@ -0,0 +1,89 @@
+#ifndef SAMPLE_CACHE_H
+#define SAMPLE_CACHE_H
+
+#include <stdint.h>
+
+/* Shared sample arena (same 96KB budget as the old 6 x 16KB buffers) */
+#define SAMPLE_CACHE_ARENA_SAMPLES (6 * 8192)
+#define SAMPLE_CACHE_MAX_ENTRIES 16
+
+/**
+ * @brief Sample cache statistics
+ */
+typedef struct {
+  uint32_t hits;      /* Lookups served from RAM */
+  uint32_t misses;    /* Lookups that had to stream from SD */
+  uint32_t evictions; /* Unreferenced entries dropped to make room */
+  uint8_t resident;   /* Entries currently holding sample data */
+  uint8_t referenced; /* Entries currently used by at least one channel */
+  uint32_t used_samples; /* Arena samples occupied by resident entries */
+} SampleCacheStats;
+
+/**
+ * @brief Initialize sample cache (drops all entries and resets counters)
+ */
+void SampleCache_Init(void);
+
+/**
+ * @brief Look up a resident sample by file identity
+ * @param first_cluster First cluster of the WAV file
+ * @param file_size Size of the WAV file in bytes
+ * @return Handle with its reference taken on hit, -1 on miss
+ */
+int SampleCache_Find(uint32_t first_cluster, uint32_t file_size);
+
+/**
+ * @brief Reserve arena space for a sample that is about to be streamed
+ * @details Evicts least recently used unreferenced entries if needed.
+ *          The entry is not visible to SampleCache_Find until committed.
+ * @param first_cluster First cluster of the WAV file
+ * @param file_size Size of the WAV file in bytes
+ * @param max_samples Upper bound of samples that will be written
+ * @return Handle with one reference taken, -1 if no space could be found
+ */
+int SampleCache_Allocate(uint32_t first_cluster, uint32_t file_size,
+                         uint32_t max_samples);
+
+/**
+ * @brief Mark an allocated entry as loaded and trim it to its real length
+ * @param handle Handle returned by SampleCache_Allocate
+ * @param length Number of samples actually loaded
+ */
+void SampleCache_Commit(int handle, uint32_t length);
+
+/**
+ * @brief Take an additional reference to an entry
+ * @details Used when several channels share one entry (e.g. baked kits)
+ * @param handle Entry handle
+ */
+void SampleCache_AddRef(int handle);
+
+/**
+ * @brief Drop one reference to an entry
+ * @details Committed entries stay resident until evicted; uncommitted
+ *          entries are freed immediately.
+ * @param handle Handle (negative values are ignored)
+ */
+void SampleCache_Release(int handle);
+
+/**
+ * @brief Get sample data of an entry
+ * @param handle Entry handle
+ * @return Pointer into the arena, NULL for invalid handles
+ */
+int16_t *SampleCache_GetData(int handle);
+
+/**
+ * @brief Get sample length of an entry
+ * @param handle Entry handle
+ * @return Length in samples (capacity for uncommitted entries)
+ */
+uint32_t SampleCache_GetLength(int handle);
+
+/**
+ * @brief Get cache statistics
+ * @param stats Structure to fill
+ */
+void SampleCache_GetStats(SampleCacheStats *stats);
+
+#endif
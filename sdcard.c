@@ -1,11 +1,15 @@
 #include "sdcard.h"
+#include "profiler.h"
 #include "sdcard_spi.h"
+#include "trace.h"
 #include <stdint.h>
 
 /* SD Card Commands */
 #define CMD0 0    /* GO_IDLE_STATE */
 #define CMD8 8    /* SEND_IF_COND */
+#define CMD12 12  /* STOP_TRANSMISSION */
 #define CMD17 17  /* READ_SINGLE_BLOCK */
+#define CMD18 18  /* READ_MULTIPLE_BLOCK */
 #define CMD24 24  /* WRITE_SINGLE_BLOCK */
 #define CMD55 55  /* APP_CMD */
 #define CMD58 58  /* READ_OCR */
@@ -43,6 +47,10 @@ static uint8_t SDCARD_SendCommand(uint8_t cmd, uint32_t arg) {
   else
     SDCARD_SPI_TransmitReceive(0xFF);
 
+  /* CMD12 is followed by a stuff byte before R1 */
+  if (cmd == CMD12)
+    SDCARD_SPI_TransmitReceive(0xFF);
+
   /* Wait for response (not 0xFF) */
   do {
     response = SDCARD_SPI_TransmitReceive(0xFF);
@@ -147,7 +155,10 @@ int SDCARD_Init(void) {
   return SDCARD_OK;
 }
 
-int SDCARD_ReadBlock(uint32_t block_addr, uint8_t *buffer) {
+/**
+ * @brief Read one block over SPI
+ */
+static int SDCARD_ReadBlockSPI(uint32_t block_addr, uint8_t *buffer) {
   uint8_t response;
   uint16_t timeout;
 
@@ -194,7 +205,81 @@ int SDCARD_ReadBlock(uint32_t block_addr, uint8_t *buffer) {
   return SDCARD_OK;
 }
 
-int SDCARD_WriteBlock(uint32_t block_addr, const uint8_t *buffer) {
+/**
+ * @brief Read consecutive blocks over SPI
+ */
+static int SDCARD_ReadMultiBlockSPI(uint32_t block_addr, uint32_t count,
+                                    uint8_t *buffer) {
+  uint8_t response;
+  uint16_t timeout;
+
+  if (count == 0) {
+    return SDCARD_OK;
+  }
+  if (count == 1) {
+    return SDCARD_ReadBlockSPI(block_addr, buffer);
+  }
+
+  /* For non-SDHC cards, convert block address to byte address */
+  if (card_type != SDCARD_TYPE_SDHC) {
+    block_addr *= 512;
+  }
+
+  /* Select card */
+  SDCARD_SPI_CS_Low();
+
+  /* CMD18: Read multiple blocks (card streams until CMD12) */
+  response = SDCARD_SendCommand(CMD18, block_addr);
+  if (response != R1_READY) {
+    SDCARD_SPI_CS_High();
+    return SDCARD_ERROR_READ;
+  }
+
+  int result = SDCARD_OK;
+  for (uint32_t blk = 0; blk < count; blk++) {
+    /* Wait for data start token */
+    timeout = 0xFFFF;
+    do {
+      response = SDCARD_SPI_TransmitReceive(0xFF);
+      timeout--;
+    } while ((response != DATA_START_TOKEN) && (timeout > 0));
+
+    if (timeout == 0) {
+      result = SDCARD_ERROR_TIMEOUT;
+      break;
+    }
+
+    /* Read 512 bytes */
+    uint8_t *dst = buffer + (blk * 512);
+    for (int i = 0; i < 512; i++) {
+      dst[i] = SDCARD_SPI_TransmitReceive(0xFF);
+    }
+
+    /* Read CRC (2 bytes, ignored) */
+    SDCARD_SPI_TransmitReceive(0xFF);
+    SDCARD_SPI_TransmitReceive(0xFF);
+  }
+
+  /* CMD12: Stop transmission, then wait while card signals busy */
+  SDCARD_SendCommand(CMD12, 0);
+  uint32_t busy_timeout = 0xFFFF;
+  do {
+    response = SDCARD_SPI_TransmitReceive(0xFF);
+    busy_timeout--;
+  } while ((response == 0x00) && (busy_timeout > 0));
+
+  /* Deselect card */
+  SDCARD_SPI_CS_High();
+  SDCARD_SPI_TransmitReceive(0xFF);
+
+  return result;
+}
+
+/**
+ * @brief Write one block over SPI
+ */
+static int SDCARD_WriteBlockSPI(uint32_t block_addr,
+                                const uint8_t *buffer) {
   uint8_t response;
   uint16_t timeout;
 
@@ -262,3 +347,32 @@ int SDCARD_WriteBlock(uint32_t block_addr, const uint8_t *buffer) {
 
   return SDCARD_OK;
 }
+
+/* Public transfers: charged to the SD card in the CPU profile */
+int SDCARD_ReadBlock(uint32_t block_addr, uint8_t *buffer) {
+  PROFILE_ENTER(PROF_SD);
+  TRACE(TRACE_SD_BEGIN, CMD17, 1);
+  int result = SDCARD_ReadBlockSPI(block_addr, buffer);
+  TRACE(TRACE_SD_END, result, 0);
+  PROFILE_EXIT();
+  return result;
+}
+
+int SDCARD_ReadMultiBlock(uint32_t block_addr, uint32_t count,
+                          uint8_t *buffer) {
+  PROFILE_ENTER(PROF_SD);
+  TRACE(TRACE_SD_BEGIN, CMD18, (count > 255) ? 255 : count);
+  int result = SDCARD_ReadMultiBlockSPI(block_addr, count, buffer);
+  TRACE(TRACE_SD_END, result, 0);
+  PROFILE_EXIT();
+  return result;
+}
+
+int SDCARD_WriteBlock(uint32_t block_addr, const uint8_t *buffer) {
+  PROFILE_ENTER(PROF_SD);
+  TRACE(TRACE_SD_BEGIN, CMD24, 1);
+  int result = SDCARD_WriteBlockSPI(block_addr, buffer);
+  TRACE(TRACE_SD_END, result, 0);
+  PROFILE_EXIT();
+  return result;
+}
@@ -30,6 +30,16 @@ int SDCARD_Init(void);
  */
 int SDCARD_ReadBlock(uint32_t block_addr, uint8_t *buffer);
 
+/**
+ * @brief Read consecutive 512-byte blocks with one CMD18 transfer
+ * @param block_addr First block address (for SDHC) or block index (for SD)
+ * @param count Number of blocks to read
+ * @param buffer Buffer to store count * 512 bytes
+ * @return SDCARD_OK on success, error code otherwise
+ */
+int SDCARD_ReadMultiBlock(uint32_t block_addr, uint32_t count,
+                          uint8_t *buffer);
+
 /**
  * @brief Write a single 512-byte block to SD card
  * @param block_addr Block address (for SDHC) or byte address (for SD)
@@ -1,23 +1,76 @@
 #include "sequencer.h"
+#include "audio_fx.h"
 #include "audio_mixer.h"
 #include "sequencer_clock.h"
+#include "trace.h"
 #include <string.h>
 
+/* Interrupt masking (host builds have no interrupts: barrier only) */
+#if defined(__arm__)
+#define IRQ_DISABLE() __asm volatile("cpsid i" : : : "memory")
+#define IRQ_ENABLE() __asm volatile("cpsie i" : : : "memory")
+#else
+#define IRQ_DISABLE() __asm volatile("" : : : "memory")
+#define IRQ_ENABLE() __asm volatile("" : : : "memory")
+#endif
+
 /* Sequencer state */
 static Pattern current_pattern = {0};
 static volatile uint8_t current_step = 0;
 static volatile uint8_t playing = 0;
 static volatile uint8_t pulse_count = 0;
 
+/* Per-track position (polymeter); reset on every master bar */
+#define DEFAULT_PULSES_PER_STEP 6 /* 16th notes at 24 PPQN */
+#define ALL_TRACKS ((1 << NUM_CHANNELS) - 1)
+
+/* Trig bitmaps mirroring current_pattern.steps (bit set = velocity > 0) */
+static volatile uint32_t track_mask[NUM_CHANNELS]; /* Bit per step */
+static volatile uint8_t step_column[MAX_STEPS];    /* Bit per track */
+static volatile uint8_t tracks_aligned = 1; /* All tracks on the master step */
+
+/* Steps already played live by the recorder, skipped once */
+static uint8_t skip_step[NUM_CHANNELS];
+static volatile uint8_t skip_pending = 0; /* Bit per track */
+
+/* Trig condition state */
+#define DEFAULT_SEED 0x2545F491
+static volatile uint32_t track_loop[NUM_CHANNELS]; /* Track loops played */
+static volatile uint8_t last_condition = 0; /* Last outcome, bit per track */
+static volatile uint8_t fill_active = 0;
+static uint32_t rng_seed = DEFAULT_SEED;
+static uint32_t rng_state = DEFAULT_SEED;
+
+/* Audio samples per 24 PPQN pulse at 1 BPM */
+#define SAMPLES_PER_PULSE_1BPM ((uint32_t)AUDIO_SAMPLE_RATE * 60 / 24)
+static volatile uint8_t track_step[NUM_CHANNELS];
+static volatile uint8_t track_pulse[NUM_CHANNELS];
+
 /* Double buffering for seamless pattern switching */
 static Pattern next_pattern_buffer = {0};
 static volatile uint8_t next_pattern_ready = 0;
 static volatile uint8_t queued_slot = 0;
 
-/* Forward declaration */
+/* Kit switched in at the same loop boundary as a queued pattern */
+static SequencerKit next_kit_buffer;
+static volatile uint8_t next_kit_ready = 0;
+
+/* Completed loops, and the loop at which the last queued pattern started */
+static volatile uint32_t loop_count = 0;
+static volatile uint32_t swap_loop = 0;
+
 /* Forward declaration */
 static void sequencer_clock_callback(uint8_t pulse);
-static void TriggerCurrentStep(void);
+static void TriggerCurrentStep(uint8_t mask);
+static void ResetTracks(void);
+static uint8_t TrackLength(uint8_t ch);
+static uint8_t TrackPulses(uint8_t ch);
+static uint8_t RatchetNibble(uint8_t ch, uint8_t step);
+static uint8_t ConditionPasses(uint8_t ch, uint8_t condition);
+static void UpdateStepMask(uint8_t ch, uint8_t step);
+static void RebuildMasks(void);
+static uint8_t TracksAligned(void);
+static void ApplyQueuedKit(void);
 
 void Sequencer_Init(void) {
   /* Initialize pattern with defaults */
@@ -27,10 +80,12 @@ void Sequencer_Init(void) {
 
   /* Clear all steps */
   memset(current_pattern.steps, 0, sizeof(current_pattern.steps));
+  RebuildMasks();
 
   /* Initialize clock */
   Clock_Init();
   Clock_SetBPM(current_pattern.bpm);
+  AudioFx_SetTempo(current_pattern.bpm);
   Clock_SetCallback(sequencer_clock_callback);
 
   /* Reset state */
@@ -42,10 +97,16 @@ void Sequencer_Init(void) {
 void Sequencer_Start(void) {
   current_step = 0;
   pulse_count = 0;
+  ResetTracks();
+  tracks_aligned = TracksAligned();
+  skip_pending = 0;
+  memset((void *)track_loop, 0, sizeof(track_loop));
+  last_condition = 0;
+  rng_state = rng_seed;
   playing = 1;
 
   /* Trigger first step immediately */
-  TriggerCurrentStep();
+  TriggerCurrentStep(ALL_TRACKS);
 
   Clock_Start();
 }
@@ -55,6 +116,7 @@ void Sequencer_Stop(void) {
   Clock_Stop();
   current_step = 0;
   pulse_count = 0;
+  ResetTracks();
 }
 
 uint8_t Sequencer_IsPlaying(void) { return playing; }
@@ -63,9 +125,18 @@ uint8_t Sequencer_GetCurrentStep(void) { return current_step; }
 
 Pattern *Sequencer_GetPattern(void) { return &current_pattern; }
 
+void Sequencer_LoadPattern(const Pattern *pattern) {
+  uint16_t current_bpm = current_pattern.bpm;
+  memcpy(&current_pattern, pattern, sizeof(Pattern));
+  current_pattern.bpm = current_bpm; /* Keep the running tempo */
+  RebuildMasks();
+  tracks_aligned = 0; /* Re-checked on the next master bar */
+}
+
 void Sequencer_SetStep(uint8_t channel, uint8_t step, uint8_t value) {
   if (channel < NUM_CHANNELS && step < MAX_STEPS) {
     current_pattern.steps[channel][step] = value;
+    UpdateStepMask(channel, step);
   }
 }
 
@@ -83,6 +154,7 @@ void Sequencer_ToggleStep(uint8_t channel, uint8_t step) {
     } else {
       current_pattern.steps[channel][step] = 0;
     }
+    UpdateStepMask(channel, step);
   }
 }
 
@@ -99,19 +171,113 @@ void Sequencer_CycleStep(uint8_t channel, uint8_t step) {
       current_pattern.steps[channel][step] = 32; /* x0.125 */
     else
       current_pattern.steps[channel][step] = 0; /* OFF */
+    UpdateStepMask(channel, step);
+  }
+}
+
+void Sequencer_SetRatchet(uint8_t channel, uint8_t step, uint8_t hits,
+                          uint8_t ramp) {
+  if (channel < NUM_CHANNELS && step < MAX_STEPS && hits >= 1 &&
+      hits <= SEQ_MAX_RATCHET) {
+    uint8_t nibble = (uint8_t)((hits - 1) | (ramp ? SEQ_RATCHET_RAMP : 0));
+    uint8_t shift = (step & 1) ? 4 : 0;
+    uint8_t *cell = &current_pattern.ratchets[channel][step / 2];
+    *cell = (uint8_t)((*cell & ~(0x0F << shift)) | (nibble << shift));
   }
 }
 
+uint8_t Sequencer_GetRatchet(uint8_t channel, uint8_t step, uint8_t *ramp) {
+  uint8_t nibble = 0;
+  if (channel < NUM_CHANNELS && step < MAX_STEPS)
+    nibble = RatchetNibble(channel, step);
+  if (ramp)
+    *ramp = (nibble & SEQ_RATCHET_RAMP) ? 1 : 0;
+  return (uint8_t)((nibble & SEQ_RATCHET_HITS_MASK) + 1);
+}
+
+void Sequencer_SetCondition(uint8_t channel, uint8_t step, uint8_t condition) {
+  if (channel < NUM_CHANNELS && step < MAX_STEPS) {
+    current_pattern.conditions[channel][step] = condition;
+  }
+}
+
+uint8_t Sequencer_GetCondition(uint8_t channel, uint8_t step) {
+  if (channel < NUM_CHANNELS && step < MAX_STEPS) {
+    return current_pattern.conditions[channel][step];
+  }
+  return 0;
+}
+
+void Sequencer_SetFill(uint8_t on) { fill_active = on ? 1 : 0; }
+
+uint8_t Sequencer_GetFill(void) { return fill_active; }
+
+void Sequencer_SetSeed(uint32_t seed) {
+  rng_seed = seed ? seed : DEFAULT_SEED;
+}
+
 void Sequencer_SetBPM(uint16_t bpm) {
   current_pattern.bpm = bpm;
   Clock_SetBPM(bpm);
+  AudioFx_SetTempo(bpm);
 }
 
 uint16_t Sequencer_GetBPM(void) { return current_pattern.bpm; }
 
+void Sequencer_SetTrackLength(uint8_t channel, uint8_t length) {
+  if (channel < NUM_CHANNELS && length <= MAX_STEPS) {
+    current_pattern.track_length[channel] = length;
+    tracks_aligned = 0;
+  }
+}
+
+uint8_t Sequencer_GetTrackLength(uint8_t channel) {
+  return (channel < NUM_CHANNELS) ? TrackLength(channel) : 0;
+}
+
+void Sequencer_SetTrackPulses(uint8_t channel, uint8_t pulses) {
+  if (channel < NUM_CHANNELS && pulses <= SEQ_MAX_PULSES_PER_STEP) {
+    current_pattern.track_pulses[channel] = pulses;
+    tracks_aligned = 0;
+  }
+}
+
+uint8_t Sequencer_GetTrackPulses(uint8_t channel) {
+  return (channel < NUM_CHANNELS) ? TrackPulses(channel) : 0;
+}
+
+uint8_t Sequencer_GetTrackStep(uint8_t channel) {
+  return (channel < NUM_CHANNELS) ? track_step[channel] : 0;
+}
+
+uint8_t Sequencer_GetTrackPhase(uint8_t channel) {
+  if (channel >= NUM_CHANNELS)
+    return 0;
+  uint32_t pulses = TrackPulses(channel);
+  uint32_t elapsed =
+      (uint32_t)track_pulse[channel] * 256 + Clock_GetPulsePhase();
+  return (uint8_t)(elapsed / pulses);
+}
+
+void Sequencer_SkipTrig(uint8_t channel, uint8_t step) {
+  if (channel < NUM_CHANNELS && step < MAX_STEPS) {
+    skip_step[channel] = step;
+    skip_pending |= (uint8_t)(1 << channel);
+  }
+}
+
+uint32_t Sequencer_GetTrackMask(uint8_t channel) {
+  return (channel < NUM_CHANNELS) ? track_mask[channel] : 0;
+}
+
+uint8_t Sequencer_GetStepColumn(uint8_t step) {
+  return (step < MAX_STEPS) ? step_column[step] : 0;
+}
+
 void Sequencer_SetStepCount(uint8_t count) {
   if (count >= 1 && count <= MAX_STEPS) {
     current_pattern.step_count = count;
+    tracks_aligned = 0;
   }
 }
 
@@ -119,17 +285,230 @@ uint8_t Sequencer_GetStepCount(void) { return current_pattern.step_count; }
 
 void Sequencer_ClearPattern(void) {
   memset(current_pattern.steps, 0, sizeof(current_pattern.steps));
+  RebuildMasks();
+}
+
+/**
+ * @brief Effective loop length of a track
+ */
+static uint8_t TrackLength(uint8_t ch) {
+  uint8_t length = current_pattern.track_length[ch];
+  if (length == 0 || length > MAX_STEPS)
+    return current_pattern.step_count;
+  return length;
+}
+
+/**
+ * @brief Effective clock pulses per step of a track
+ */
+static uint8_t TrackPulses(uint8_t ch) {
+  uint8_t pulses = current_pattern.track_pulses[ch];
+  return pulses ? pulses : DEFAULT_PULSES_PER_STEP;
+}
+
+/**
+ * @brief Ratchet setting of a step (SEQ_RATCHET_* bits)
+ */
+static uint8_t RatchetNibble(uint8_t ch, uint8_t step) {
+  uint8_t cell = current_pattern.ratchets[ch][step / 2];
+  return (step & 1) ? (cell >> 4) : (cell & 0x0F);
+}
+
+/**
+ * @brief Bring the trig bitmaps in line with one edited step
+ */
+static void UpdateStepMask(uint8_t ch, uint8_t step) {
+  uint32_t step_bit = 1UL << step;
+  uint8_t track_bit = (uint8_t)(1 << ch);
+
+  /* Read-modify-write must not race a pattern swap in the clock interrupt */
+  IRQ_DISABLE();
+  if (current_pattern.steps[ch][step]) {
+    track_mask[ch] |= step_bit;
+    step_column[step] |= track_bit;
+  } else {
+    track_mask[ch] &= ~step_bit;
+    step_column[step] &= (uint8_t)~track_bit;
+  }
+  IRQ_ENABLE();
+}
+
+/**
+ * @brief Recompute the trig bitmaps from the whole pattern
+ */
+static void RebuildMasks(void) {
+  uint8_t column[MAX_STEPS] = {0};
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+    uint32_t bits = 0;
+    for (uint8_t step = 0; step < MAX_STEPS; step++) {
+      if (current_pattern.steps[ch][step]) {
+        bits |= 1UL << step;
+        column[step] |= (uint8_t)(1 << ch);
+      }
+    }
+    track_mask[ch] = bits;
+  }
+  memcpy((void *)step_column, column, sizeof(column));
+}
+
+/**
+ * @brief Check if every track runs on the master step grid
+ */
+static uint8_t TracksAligned(void) {
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+    if (TrackLength(ch) != current_pattern.step_count ||
+        TrackPulses(ch) != DEFAULT_PULSES_PER_STEP)
+      return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief xorshift32 step
+ */
+static uint32_t NextRandom(void) {
+  uint32_t x = rng_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rng_state = x;
+  return x;
+}
+
+/**
+ * @brief Evaluate a trig condition
+ * @details Every kind is computed and the result picked by table, so the
+ *          cost is the same for any condition (one generator step and one
+ *          division).
+ * @return 1 if the step plays
+ */
+static uint8_t ConditionPasses(uint8_t ch, uint8_t condition) {
+  uint32_t rnd = NextRandom();
+
+  /* Probability; 0 and anything above 100 % always play */
+  uint32_t percent = condition & 0x7F;
+  uint32_t chance = (percent - 1 < 100) ? percent : 100;
+  uint8_t prob = (((rnd >> 16) * 100) >> 16) < chance;
+
+  /* Loop N:M, counted in this track's own loops */
+  uint32_t n = condition & 0x07;
+  uint32_t m = ((condition >> 3) & 0x07) + 1;
+  uint8_t loop = (track_loop[ch] % m) == n;
+
+  /* FILL, NOT FILL, PRE, NOT PRE */
+  uint8_t pre = (last_condition >> ch) & 1;
+  uint8_t flags = (uint8_t)(fill_active | ((fill_active ^ 1) << 1) |
+                            (pre << 2) | ((pre ^ 1) << 3));
+  uint8_t special = (flags >> (condition & 0x03)) & 1;
+
+  const uint8_t outcome[4] = {prob, prob, loop, special};
+  uint8_t pass = outcome[condition >> 6];
+
+  /* PRE refers to the last other condition; plain trigs don't count */
+  uint8_t record = (condition != SEQ_COND_ALWAYS) &&
+                   ((condition & 0xFE) != SEQ_COND_PRE);
+  uint8_t bit = (uint8_t)(record << ch);
+  last_condition = (uint8_t)((last_condition & ~bit) | ((pass << ch) & bit));
+
+  return pass;
+}
+
+/**
+ * @brief Put every track back on its first step
+ */
+static void ResetTracks(void) {
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+    track_step[ch] = 0;
+    track_pulse[ch] = 0;
+  }
 }
 
 /**
  * @brief Helper to trigger samples for current step
+ * @param mask Tracks that entered a new step
+ */
+static void TriggerCurrentStep(uint8_t mask) {
+  /* Tracks with a trig on their current step: one lookup when aligned */
+  uint8_t due;
+  if (tracks_aligned) {
+    due = step_column[track_step[0]];
+  } else {
+    due = 0;
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+      due |= (uint8_t)(((track_mask[ch] >> track_step[ch]) & 1) << ch);
+  }
+  due &= mask;
+
+  /* Live-recorded hits already sounded; a skip lasts one step entry */
+  uint8_t skip = skip_pending & mask;
+  if (skip) {
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+      if ((skip & (1 << ch)) && skip_step[ch] == track_step[ch])
+        due &= (uint8_t)~(1 << ch);
+    }
+    skip_pending &= (uint8_t)~skip;
+  }
+
+  for (uint8_t ch = 0; due; ch++, due >>= 1) {
+    if (!(due & 1))
+      continue;
+
+    uint8_t step = track_step[ch];
+    uint8_t velocity = current_pattern.steps[ch][step];
+    if (!ConditionPasses(ch, current_pattern.conditions[ch][step]))
+      continue;
+
+    TRACE(TRACE_TRIGGER, ch, velocity);
+    uint8_t ratchet = RatchetNibble(ch, step);
+    if (ratchet & SEQ_RATCHET_HITS_MASK) {
+      /* Remaining hits are timed by the mixer in samples, not pulses */
+      uint8_t hits = (ratchet & SEQ_RATCHET_HITS_MASK) + 1;
+      uint32_t interval = SAMPLES_PER_PULSE_1BPM * TrackPulses(ch) /
+                          ((uint32_t)Clock_GetBPM() * hits);
+      AudioMixer_TriggerRepeat(ch, velocity, hits, interval,
+                               (ratchet & SEQ_RATCHET_RAMP) ? 1 : 0);
+    } else {
+      AudioMixer_Trigger(ch, velocity);
+    }
+  }
+}
+
+/**
+ * @brief Advance each track's own clock by one pulse
+ * @return Mask of tracks that entered a new step
  */
-static void TriggerCurrentStep(void) {
+static uint8_t AdvanceTracks(void) {
+  uint8_t mask = 0;
   for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
-    if (current_pattern.steps[ch][current_step] > 0) {
-      AudioMixer_Trigger(ch, current_pattern.steps[ch][current_step]);
+    if (++track_pulse[ch] >= TrackPulses(ch)) {
+      track_pulse[ch] = 0;
+      if (++track_step[ch] >= TrackLength(ch)) {
+        track_step[ch] = 0;
+        track_loop[ch]++;
+      }
+      mask |= (1 << ch);
     }
   }
+  return mask;
+}
+
+/**
+ * @brief Point all mixer channels at the queued kit
+ */
+static void ApplyQueuedKit(void) {
+  /* Applied in place, not queued: the downbeat is triggered right after
+   * and must already play the new kit's settings */
+  for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+    AudioVoice voice = {next_kit_buffer.volumes[ch],
+                        next_kit_buffer.pans[ch],
+                        next_kit_buffer.holds[ch],
+                        next_kit_buffer.decays[ch],
+                        next_kit_buffer.filter_modes[ch],
+                        next_kit_buffer.cutoffs[ch],
+                        next_kit_buffer.resonances[ch]};
+    AudioMixer_LoadVoice(ch, next_kit_buffer.samples[ch],
+                         next_kit_buffer.lengths[ch], &voice);
+  }
 }
 
 /**
@@ -142,8 +521,9 @@ static void sequencer_clock_callback(uint8_t pulse) {
     return;
 
   pulse_count++;
+  uint8_t bar_reset = 0;
 
-  /* Trigger on every 6th pulse (16th notes at 24 PPQN)
+  /* Master step on every 6th pulse (16th notes at 24 PPQN)
    * 24 PPQN / 4 = 6 pulses per 16th note
    */
   if (pulse_count >= 6) {
@@ -153,19 +533,40 @@ static void sequencer_clock_callback(uint8_t pulse) {
     current_step++;
     if (current_step >= current_pattern.step_count) {
       current_step = 0;
+      loop_count++;
+      bar_reset = 1;
+
+      /* Kit first, so the new pattern's first step plays the new kit */
+      if (next_kit_ready) {
+        ApplyQueuedKit();
+        next_kit_ready = 0;
+      }
 
       /* Seamlessly swap pattern if one is queued */
       if (next_pattern_ready) {
         uint16_t current_bpm = current_pattern.bpm;
         memcpy(&current_pattern, &next_pattern_buffer, sizeof(Pattern));
         current_pattern.bpm = current_bpm; /* Ignore loaded BPM */
+        RebuildMasks();
         next_pattern_ready = 0;
+        swap_loop = loop_count;
         /* Note: BPM update intentionally disabled per user request */
       }
     }
+    TRACE(TRACE_STEP, current_step, bar_reset);
+  }
 
-    /* Trigger audio samples */
-    TriggerCurrentStep();
+  /* Master bar realigns all tracks; otherwise each runs its own clock */
+  if (bar_reset) {
+    ResetTracks();
+    tracks_aligned = TracksAligned();
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+      track_loop[ch]++;
+    TriggerCurrentStep(ALL_TRACKS);
+  } else {
+    uint8_t mask = AdvanceTracks();
+    if (mask)
+      TriggerCurrentStep(mask);
   }
 }
 
@@ -178,3 +579,24 @@ void Sequencer_QueuePattern(Pattern *new_pattern, uint8_t slot) {
 uint8_t Sequencer_IsPatternQueued(void) { return next_pattern_ready; }
 
 uint8_t Sequencer_GetQueuedSlot(void) { return queued_slot; }
+
+void Sequencer_QueueKit(const SequencerKit *kit) {
+  next_kit_ready = 0;
+  memcpy(&next_kit_buffer, kit, sizeof(SequencerKit));
+  next_kit_ready = 1;
+}
+
+uint8_t Sequencer_IsKitQueued(void) { return next_kit_ready; }
+
+uint8_t Sequencer_CancelKit(void) {
+  /* Test-and-clear must not race the clock interrupt */
+  IRQ_DISABLE();
+  uint8_t pending = next_kit_ready;
+  next_kit_ready = 0;
+  IRQ_ENABLE();
+  return pending;
+}
+
+uint32_t Sequencer_GetLoopCount(void) { return loop_count; }
+
+uint32_t Sequencer_GetSwapLoop(void) { return swap_loop; }
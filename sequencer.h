@@ -5,6 +5,23 @@
 
 #define NUM_CHANNELS 6
 #define MAX_STEPS 32
+#define SEQ_MAX_PULSES_PER_STEP 96 /* One step per bar at 24 PPQN */
+#define SEQ_MAX_RATCHET 8          /* Hits per step */
+
+/* Ratchet nibble: bits 0-2 = extra hits (0-7), bit 3 = velocity ramp */
+#define SEQ_RATCHET_HITS_MASK 0x07
+#define SEQ_RATCHET_RAMP 0x08
+
+/* Trig condition byte: 0xxxxxxx = probability, 10mmmnnn = loop N:M,
+ * 110000xx = fill / previous */
+#define SEQ_COND_ALWAYS 0x00
+#define SEQ_COND_PROB(pct) ((uint8_t)(pct)) /* 1-99 % chance */
+#define SEQ_COND_LOOP(n, m)                                                    \
+  ((uint8_t)(0x80 | (((m) - 1) << 3) | ((n) - 1))) /* Nth of every M (1-8) */
+#define SEQ_COND_FILL 0xC0     /* Only while fill is held */
+#define SEQ_COND_NOT_FILL 0xC1 /* Only while fill is off */
+#define SEQ_COND_PRE 0xC2      /* Last condition on this track passed */
+#define SEQ_COND_NOT_PRE 0xC3  /* Last condition on this track failed */
 
 /**
  * @brief Pattern structure
@@ -14,8 +31,32 @@ typedef struct {
   uint8_t step_count;                     /* Active steps (1-32) */
   uint16_t bpm;                           /* Beats per minute */
   char name[16];                          /* Pattern name */
+  /* Polymeter (added after the 212-byte layout; zero = previous behaviour) */
+  uint8_t track_length[NUM_CHANNELS]; /* Steps per track loop, 0 = step_count */
+  uint8_t track_pulses[NUM_CHANNELS]; /* 24 PPQN pulses per step, 0 = 6 */
+  /* Ratchets, one nibble per step (even step = low nibble), 0 = single hit */
+  uint8_t ratchets[NUM_CHANNELS][MAX_STEPS / 2];
+  uint8_t conditions[NUM_CHANNELS][MAX_STEPS]; /* SEQ_COND_*, 0 = always */
 } Pattern;
 
+/* Size of patterns saved before per-track settings existed */
+#define PATTERN_V1_SIZE 212
+
+/**
+ * @brief Mixer settings for a kit switched in by the sequencer
+ */
+typedef struct {
+  int16_t *samples[NUM_CHANNELS];
+  uint32_t lengths[NUM_CHANNELS];
+  uint8_t volumes[NUM_CHANNELS];
+  uint8_t pans[NUM_CHANNELS];
+  uint8_t holds[NUM_CHANNELS];
+  uint8_t decays[NUM_CHANNELS];
+  uint8_t filter_modes[NUM_CHANNELS];
+  uint8_t cutoffs[NUM_CHANNELS];
+  uint8_t resonances[NUM_CHANNELS];
+} SequencerKit;
+
 /**
  * @brief Initialize sequencer
  */
@@ -49,6 +90,14 @@ uint8_t Sequencer_GetCurrentStep(void);
  */
 Pattern *Sequencer_GetPattern(void);
 
+/**
+ * @brief Replace the current pattern, keeping the running tempo
+ * @details Use instead of writing through Sequencer_GetPattern(), so the
+ *          trig bitmaps follow the new steps.
+ * @param pattern Pattern to copy
+ */
+void Sequencer_LoadPattern(const Pattern *pattern);
+
 /**
  * @brief Set step value
  * @param channel Channel (0-3)
@@ -79,6 +128,64 @@ void Sequencer_ToggleStep(uint8_t channel, uint8_t step);
  */
 void Sequencer_CycleStep(uint8_t channel, uint8_t step);
 
+/**
+ * @brief Set step ratchet
+ * @details The hits are spread evenly over the track's step length and
+ *          timed by the audio mixer, so 3, 5 or 7 hits per 16th are exact.
+ * @param channel Channel (0-5)
+ * @param step Step (0-31)
+ * @param hits Hits per step (1-8), 1 = normal trigger
+ * @param ramp 1 = velocity rises towards the step velocity, 0 = flat
+ */
+void Sequencer_SetRatchet(uint8_t channel, uint8_t step, uint8_t hits,
+                          uint8_t ramp);
+
+/**
+ * @brief Get step ratchet
+ * @param channel Channel (0-5)
+ * @param step Step (0-31)
+ * @param ramp Receives the velocity ramp flag (may be NULL)
+ * @return Hits per step (1-8)
+ */
+uint8_t Sequencer_GetRatchet(uint8_t channel, uint8_t step, uint8_t *ramp);
+
+/**
+ * @brief Set step trig condition
+ * @param channel Channel (0-5)
+ * @param step Step (0-31)
+ * @param condition SEQ_COND_* value
+ */
+void Sequencer_SetCondition(uint8_t channel, uint8_t step, uint8_t condition);
+
+/**
+ * @brief Get step trig condition
+ * @param channel Channel (0-5)
+ * @param step Step (0-31)
+ * @return SEQ_COND_* value
+ */
+uint8_t Sequencer_GetCondition(uint8_t channel, uint8_t step);
+
+/**
+ * @brief Set fill state (for SEQ_COND_FILL / SEQ_COND_NOT_FILL)
+ * @param on 1 = fill active, 0 = off
+ */
+void Sequencer_SetFill(uint8_t on);
+
+/**
+ * @brief Get fill state
+ * @return 1 if fill is active, 0 otherwise
+ */
+uint8_t Sequencer_GetFill(void);
+
+/**
+ * @brief Seed the probability generator
+ * @details The generator restarts from this seed on every
+ *          Sequencer_Start(), so a run with the same seed and input is
+ *          repeated exactly.
+ * @param seed Any value (0 selects the default seed)
+ */
+void Sequencer_SetSeed(uint32_t seed);
+
 /**
  * @brief Set BPM
  * @param bpm Beats per minute (40-300)
@@ -91,6 +198,76 @@ void Sequencer_SetBPM(uint16_t bpm);
  */
 uint16_t Sequencer_GetBPM(void);
 
+/**
+ * @brief Set a track's own loop length (polymeter)
+ * @param channel Channel (0-5)
+ * @param length Steps (1-32), 0 = follow the pattern step count
+ */
+void Sequencer_SetTrackLength(uint8_t channel, uint8_t length);
+
+/**
+ * @brief Get a track's effective loop length
+ * @param channel Channel (0-5)
+ * @return Steps per track loop
+ */
+uint8_t Sequencer_GetTrackLength(uint8_t channel);
+
+/**
+ * @brief Set a track's clock division
+ * @details 6 = 16th notes; 3 = twice as fast, 12 = half speed, 4 = 16th
+ *          triplets, etc. All tracks restart together on the master bar
+ *          (every step_count 16ths).
+ * @param channel Channel (0-5)
+ * @param pulses 24 PPQN pulses per step (1-96), 0 = default (6)
+ */
+void Sequencer_SetTrackPulses(uint8_t channel, uint8_t pulses);
+
+/**
+ * @brief Get a track's effective clock division
+ * @param channel Channel (0-5)
+ * @return 24 PPQN pulses per step
+ */
+uint8_t Sequencer_GetTrackPulses(uint8_t channel);
+
+/**
+ * @brief Get the step a track is currently playing
+ * @param channel Channel (0-5)
+ * @return Step (0-31)
+ */
+uint8_t Sequencer_GetTrackStep(uint8_t channel);
+
+/**
+ * @brief Get how far a track is into its current step
+ * @details Includes the position between clock pulses. Call at clock
+ *          interrupt priority (or with it masked) for a consistent value.
+ * @param channel Channel (0-5)
+ * @return Fraction of the step elapsed (0-255)
+ */
+uint8_t Sequencer_GetTrackPhase(uint8_t channel);
+
+/**
+ * @brief Suppress a step's trig the next time the track enters it
+ * @details For hits already played live and recorded ahead of the
+ *          playhead. Only the track's next step entry is checked.
+ * @param channel Channel (0-5)
+ * @param step Step (0-31)
+ */
+void Sequencer_SkipTrig(uint8_t channel, uint8_t step);
+
+/**
+ * @brief Get a track's trig bitmap
+ * @param channel Channel (0-5)
+ * @return Bit N set if step N has a trig
+ */
+uint32_t Sequencer_GetTrackMask(uint8_t channel);
+
+/**
+ * @brief Get the tracks with a trig on a step
+ * @param step Step (0-31)
+ * @return Bit N set if channel N has a trig
+ */
+uint8_t Sequencer_GetStepColumn(uint8_t step);
+
 /**
  * @brief Set step count
  * @param count Number of steps (1-32)
@@ -127,4 +304,36 @@ uint8_t Sequencer_IsPatternQueued(void);
  */
 uint8_t Sequencer_GetQueuedSlot(void);
 
+/**
+ * @brief Queue a kit for the next loop boundary
+ * @details Applied in the clock interrupt right before the first step of
+ *          the next loop, together with any queued pattern.
+ * @param kit Sample pointers and mix settings (copied)
+ */
+void Sequencer_QueueKit(const SequencerKit *kit);
+
+/**
+ * @brief Check if a kit is queued
+ * @return 1 if queued, 0 otherwise
+ */
+uint8_t Sequencer_IsKitQueued(void);
+
+/**
+ * @brief Withdraw a queued kit
+ * @return 1 if the kit was still pending, 0 if it had already been applied
+ */
+uint8_t Sequencer_CancelKit(void);
+
+/**
+ * @brief Get number of completed pattern loops
+ * @return Loop counter (wraps)
+ */
+uint32_t Sequencer_GetLoopCount(void);
+
+/**
+ * @brief Get the loop counter value at which the last queued pattern started
+ * @return Loop counter value
+ */
+uint32_t Sequencer_GetSwapLoop(void);
+
 #endif
@@ -1,4 +1,6 @@
 #include "sequencer_clock.h"
+#include "profiler.h"
+#include "trace.h"
 #include <stdint.h>
 
 /* STM32F411 Register Definitions */
@@ -145,17 +147,26 @@ uint8_t Clock_IsRunning(void) { return clock_running; }
 
 uint8_t Clock_GetPulse(void) { return current_pulse; }
 
+uint8_t Clock_GetPulsePhase(void) {
+  if (TIM2_SR & TIM_SR_UIF)
+    return 255;
+  return (uint8_t)((TIM2_CNT * 256) / (TIM2_ARR + 1));
+}
+
 void Clock_SetCallback(ClockCallback callback) { clock_callback = callback; }
 
 /**
  * @brief TIM2 interrupt handler
  */
 void TIM2_IRQHandler(void) {
+  PROFILE_ENTER(PROF_CLOCK);
   if (TIM2_SR & TIM_SR_UIF) {
     /* Clear interrupt flag */
     TIM2_SR = ~TIM_SR_UIF;
 
     if (clock_running) {
+      TRACE(TRACE_CLOCK, current_pulse, 0);
+
       /* Call callback if set */
       if (clock_callback) {
         clock_callback(current_pulse);
@@ -168,4 +179,5 @@ void TIM2_IRQHandler(void) {
       }
     }
   }
+  PROFILE_EXIT();
 }
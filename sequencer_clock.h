@@ -44,6 +44,15 @@ uint8_t Clock_IsRunning(void);
  */
 uint8_t Clock_GetPulse(void);
 
+/**
+ * @brief Get position inside the current pulse
+ * @details Read from the TIM2 counter, so input events can be placed
+ *          between pulses. Reads 255 once the pulse has ended but its
+ *          interrupt has not run yet.
+ * @return Fraction of the pulse elapsed (0-255)
+ */
+uint8_t Clock_GetPulsePhase(void);
+
 /**
  * @brief Clock callback function type
  * @param pulse Current pulse (0-23)
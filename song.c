@@ -0,0 +1,302 @@
+#include "song.h"
+#include "fat32.h"
+#include "pattern_manager.h"
+#include "sdcard.h"
+#include "sequencer.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+/* Millisecond tick (main.c) */
+uint32_t HAL_GetTick(void);
+
+/* Prefetch lead time never drops below this */
+#define SONG_WINDOW_MIN_MS 20
+
+/* Prefetch state of the next entry */
+#define SONG_IDLE 0   /* Nothing prepared yet */
+#define SONG_STAGED 1 /* Pattern (and kit) in RAM, not yet handed over */
+#define SONG_QUEUED 2 /* Handed to the sequencer for the next boundary */
+
+/* Chain */
+static SongEntry entries[SONG_MAX_ENTRIES];
+static uint8_t entry_count = 0;
+
+/* Playback */
+static uint8_t active = 0;
+static uint8_t position = 0;
+static uint32_t entry_start_loop = 0; /* Loop counter when entry began */
+static uint8_t live_kit_slot = 0;     /* Kit the song last switched to */
+static Drumset *live_drumset = NULL;
+
+/* Next entry */
+static uint8_t stage_state = SONG_IDLE;
+static Pattern next_pattern;
+static uint8_t next_kit_staged = 0;   /* Kit ready in the staging area */
+static uint8_t next_kit_fallback = 0; /* Kit must be loaded after the swap */
+
+/* Timing */
+static uint32_t latency_ms = 0;  /* Smoothed prefetch duration */
+static uint32_t poll_gap_ms = 0; /* Smoothed time between polls */
+static uint32_t last_poll_ms = 0;
+static uint32_t stat_transitions = 0;
+static uint32_t stat_late = 0;
+
+/**
+ * @brief Append an entry, clamping repeats and dropping a bad kit slot
+ */
+static void add_entry(int pattern_slot, int repeats, int kit_slot) {
+  if (pattern_slot < 1 || pattern_slot > 100)
+    return;
+
+  SongEntry *e = &entries[entry_count++];
+  e->pattern_slot = (uint8_t)pattern_slot;
+  e->repeats = (uint8_t)((repeats < 1)     ? 1
+                         : (repeats > 255) ? 255
+                                           : repeats);
+  e->kit_slot = (kit_slot >= 1 && kit_slot <= 100) ? (uint8_t)kit_slot : 0;
+}
+
+int Song_Load(uint8_t slot) {
+  if (slot < 1 || slot > 100)
+    return -1;
+
+  uint32_t songs_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "SONGS");
+  if (songs_cluster == 0)
+    return -1;
+
+  char filename[13];
+  snprintf(filename, sizeof(filename), "SONG-%03d.SNG", slot);
+
+  FAT32_FileEntry files[FAT32_MAX_FILES];
+  int count = FAT32_ListDir(songs_cluster, files, FAT32_MAX_FILES);
+
+  FAT32_FileEntry *target_file = NULL;
+  for (int i = 0; i < count; i++) {
+    if (strcasecmp(files[i].name, filename) == 0) {
+      target_file = &files[i];
+      break;
+    }
+  }
+  if (!target_file)
+    return -1;
+
+  /* 64 entries fit in two sectors; the second needs a linear file */
+  static char buffer[1024 + 1];
+  uint32_t size = target_file->size;
+  if (size > 512 && !FAT32_IsContiguous(target_file))
+    size = 512;
+  if (size > 1024)
+    size = 1024;
+
+  uint32_t sector = FAT32_GetFileSector(target_file);
+  for (uint32_t offset = 0; offset < size; offset += 512) {
+    if (SDCARD_ReadBlock(sector++, (uint8_t *)buffer + offset) != SDCARD_OK)
+      return -1;
+  }
+  buffer[size] = '\0';
+
+  if (active)
+    Song_Stop();
+
+  entry_count = 0;
+  char *line = buffer;
+  while (line && *line && entry_count < SONG_MAX_ENTRIES) {
+    int pattern_slot, repeats, kit_slot = 0;
+    int parsed = sscanf(line, "%d,%d,%d", &pattern_slot, &repeats, &kit_slot);
+
+    if (parsed >= 2)
+      add_entry(pattern_slot, repeats, kit_slot);
+
+    line = strchr(line, '\n');
+    if (line)
+      line++;
+  }
+
+  return (entry_count > 0) ? entry_count : -1;
+}
+
+int Song_SetChain(const SongEntry *chain, uint8_t count) {
+  if (active)
+    Song_Stop();
+
+  entry_count = 0;
+  for (uint8_t i = 0; i < count && entry_count < SONG_MAX_ENTRIES; i++)
+    add_entry(chain[i].pattern_slot, chain[i].repeats, chain[i].kit_slot);
+
+  return (entry_count > 0) ? entry_count : -1;
+}
+
+int Song_Start(Drumset *drumset) {
+  if (entry_count == 0)
+    return -1;
+
+  if (active)
+    Song_Stop();
+
+  /* First entry applies right away, keeping the current tempo */
+  if (Pattern_Load(&next_pattern, entries[0].pattern_slot) != 0)
+    return -1;
+  Sequencer_LoadPattern(&next_pattern);
+
+  live_kit_slot = 0;
+  if (entries[0].kit_slot &&
+      Drumset_LoadFromSlot(drumset, entries[0].kit_slot) == 0)
+    live_kit_slot = entries[0].kit_slot;
+
+  live_drumset = drumset;
+  position = 0;
+  entry_start_loop = Sequencer_GetLoopCount();
+  stage_state = SONG_IDLE;
+  last_poll_ms = 0;
+  stat_transitions = 0;
+  stat_late = 0;
+  active = 1;
+  return 0;
+}
+
+void Song_Stop(void) {
+  if (!active)
+    return;
+
+  if (stage_state == SONG_QUEUED && next_kit_staged) {
+    /* Kit may already be playing: keep ownership consistent with the mixer */
+    if (Sequencer_CancelKit())
+      Drumset_DropStaged();
+    else
+      Drumset_CommitStaged(live_drumset);
+  } else if (stage_state == SONG_STAGED && next_kit_staged) {
+    Drumset_DropStaged();
+  }
+
+  stage_state = SONG_IDLE;
+  next_kit_staged = 0;
+  active = 0;
+}
+
+uint8_t Song_IsActive(void) { return active; }
+
+uint8_t Song_GetPosition(void) { return position; }
+
+uint8_t Song_GetPatternSlot(void) {
+  return active ? entries[position].pattern_slot : 0;
+}
+
+/**
+ * @brief Load the next entry's pattern and kit into RAM
+ */
+static void stage_entry(uint8_t index) {
+  SongEntry *e = &entries[index];
+  uint32_t start = HAL_GetTick();
+
+  /* Missing pattern: keep playing the current one */
+  if (Pattern_Load(&next_pattern, e->pattern_slot) != 0)
+    memcpy(&next_pattern, Sequencer_GetPattern(), sizeof(Pattern));
+
+  next_kit_staged = 0;
+  next_kit_fallback = 0;
+  if (e->kit_slot && e->kit_slot != live_kit_slot) {
+    if (Drumset_Stage(e->kit_slot) == 0)
+      next_kit_staged = 1;
+    else
+      next_kit_fallback = 1; /* No room to hold both kits */
+  }
+
+  /* Track slow loads at once, forget them slowly */
+  uint32_t took = HAL_GetTick() - start;
+  if (took > latency_ms)
+    latency_ms = took;
+  else
+    latency_ms = (latency_ms * 7 + took) / 8;
+}
+
+uint8_t Song_Poll(void) {
+  if (!active)
+    return 0;
+
+  uint32_t now = HAL_GetTick();
+  if (last_poll_ms != 0)
+    poll_gap_ms = (poll_gap_ms * 3 + (now - last_poll_ms)) / 4;
+  last_poll_ms = now;
+
+  SongEntry *cur = &entries[position];
+  uint8_t next = (uint8_t)((position + 1) % entry_count);
+  uint32_t due = entry_start_loop + cur->repeats;
+  uint8_t events = 0;
+
+  /* Boundary passed: the sequencer swapped in the queued entry */
+  if (stage_state == SONG_QUEUED && !Sequencer_IsPatternQueued()) {
+    uint32_t started = Sequencer_GetSwapLoop();
+    if ((int32_t)(started - due) > 0)
+      stat_late++;
+    stat_transitions++;
+
+    if (next_kit_staged) {
+      Drumset_CommitStaged(live_drumset);
+      live_kit_slot = entries[next].kit_slot;
+      events |= SONG_EVENT_KIT;
+    } else if (next_kit_fallback) {
+      stat_late++;
+      if (Drumset_LoadFromSlot(live_drumset, entries[next].kit_slot) == 0)
+        live_kit_slot = entries[next].kit_slot;
+      events |= SONG_EVENT_KIT;
+    }
+
+    position = next;
+    entry_start_loop = started;
+    stage_state = SONG_IDLE;
+    next_kit_staged = 0;
+    next_kit_fallback = 0;
+    return events | SONG_EVENT_PATTERN;
+  }
+
+  if (!Sequencer_IsPlaying())
+    return events;
+
+  int32_t loops_left = (int32_t)(due - Sequencer_GetLoopCount());
+
+  if (stage_state == SONG_IDLE) {
+    /* Time until the entry ends; the current step counts as already over */
+    uint32_t step_ms = 15000 / Sequencer_GetBPM();
+    uint32_t steps = Sequencer_GetStepCount();
+    uint32_t to_boundary = 0;
+    if (loops_left > 0)
+      to_boundary = ((uint32_t)(loops_left - 1) * steps + steps - 1 -
+                     Sequencer_GetCurrentStep()) *
+                    step_ms;
+
+    if (to_boundary <= SONG_WINDOW_MIN_MS + 2 * (latency_ms + poll_gap_ms)) {
+      stage_entry(next);
+      stage_state = SONG_STAGED;
+    }
+  }
+
+  /* Hand over during the entry's last loop so it swaps at its end */
+  if (stage_state == SONG_STAGED && loops_left <= 1) {
+    if (next_kit_staged) {
+      const Drumset *staged = Drumset_GetStaged();
+      SequencerKit kit;
+      memcpy(kit.samples, staged->samples, sizeof(kit.samples));
+      memcpy(kit.lengths, staged->lengths, sizeof(kit.lengths));
+      memcpy(kit.volumes, staged->volumes, sizeof(kit.volumes));
+      memcpy(kit.pans, staged->pans, sizeof(kit.pans));
+      memcpy(kit.holds, staged->holds, sizeof(kit.holds));
+      memcpy(kit.decays, staged->decays, sizeof(kit.decays));
+      memcpy(kit.filter_modes, staged->filter_modes, sizeof(kit.filter_modes));
+      memcpy(kit.cutoffs, staged->cutoffs, sizeof(kit.cutoffs));
+      memcpy(kit.resonances, staged->resonances, sizeof(kit.resonances));
+      Sequencer_QueueKit(&kit);
+    }
+    Sequencer_QueuePattern(&next_pattern, entries[next].pattern_slot);
+    stage_state = SONG_QUEUED;
+  }
+
+  return events;
+}
+
+void Song_GetStats(SongStats *stats) {
+  stats->transitions = stat_transitions;
+  stats->late_transitions = stat_late;
+  stats->latency_ms = latency_ms;
+  stats->window_ms = SONG_WINDOW_MIN_MS + 2 * (latency_ms + poll_gap_ms);
+}
@@ -0,0 +1,95 @@
+#ifndef SONG_H
+#define SONG_H
+
+#include "wav_loader.h"
+#include <stdint.h>
+
+#define SONG_MAX_ENTRIES 64
+
+/* Song_Poll event flags */
+#define SONG_EVENT_PATTERN (1 << 0) /* Next entry's pattern started */
+#define SONG_EVENT_KIT (1 << 1)     /* Live kit changed */
+
+/**
+ * @brief One step of a song chain
+ */
+typedef struct {
+  uint8_t pattern_slot; /* Pattern slot (1-100) */
+  uint8_t repeats;      /* Loops to play (1-255) */
+  uint8_t kit_slot;     /* Kit slot (1-100), 0 = keep current kit */
+} SongEntry;
+
+/**
+ * @brief Song engine statistics
+ */
+typedef struct {
+  uint32_t transitions;      /* Entry changes played */
+  uint32_t late_transitions; /* Entry changes that missed their boundary */
+  uint32_t latency_ms;       /* Smoothed pattern + kit prefetch time */
+  uint32_t window_ms;        /* Current prefetch lead time */
+} SongStats;
+
+/**
+ * @brief Load a song chain from /SONGS/SONG-XXX.SNG
+ * @details Text file, one "pattern,repeats,kit" line per entry
+ * @param slot Slot number (1-100)
+ * @return Number of entries loaded, -1 on error
+ */
+int Song_Load(uint8_t slot);
+
+/**
+ * @brief Use a chain built in RAM instead of a song file
+ * @details Entries are clamped as Song_Load does; invalid ones are skipped.
+ * @param chain Entries to copy
+ * @param count Number of entries (up to SONG_MAX_ENTRIES)
+ * @return Number of entries kept, -1 if none
+ */
+int Song_SetChain(const SongEntry *chain, uint8_t count);
+
+/**
+ * @brief Start the loaded song from its first entry
+ * @details Loads the first pattern (and kit) immediately
+ * @param drumset Live drumset, updated on kit changes
+ * @return 0 on success, -1 if no song is loaded or the pattern is missing
+ */
+int Song_Start(Drumset *drumset);
+
+/**
+ * @brief Leave song mode (the current pattern keeps playing)
+ */
+void Song_Stop(void);
+
+/**
+ * @brief Check if song mode is active
+ * @return 1 if active, 0 otherwise
+ */
+uint8_t Song_IsActive(void);
+
+/**
+ * @brief Get the entry currently playing
+ * @return Entry index (0-based)
+ */
+uint8_t Song_GetPosition(void);
+
+/**
+ * @brief Get the pattern slot of the entry currently playing
+ * @return Pattern slot (1-100), 0 if song mode is off
+ */
+uint8_t Song_GetPatternSlot(void);
+
+/**
+ * @brief Run the song engine
+ * @details Prefetches the next entry once its boundary is closer than the
+ *          prefetch window and queues it during the last loop of the
+ *          current entry. Call from the main loop.
+ * @return SONG_EVENT_* flags
+ */
+uint8_t Song_Poll(void);
+
+/**
+ * @brief Get song engine statistics
+ * @param stats Structure to fill
+ */
+void Song_GetStats(SongStats *stats);
+
+#endif
@@ -1,5 +1,6 @@
 #include "st7789.h"
 #include "font.h"
+#include "profiler.h"
 #include "spi.h"
 
 /* STM32F411 Register Definitions */
@@ -10,9 +11,16 @@
 /* SPI Control Register Bits */
 #define SPI_SR_BSY (1 << 7)
 
-/* GPIOA Registers */
+/* GPIOA Registers (host build: plain variables, see host/host_spi.c) */
+#ifndef HOST_BUILD
 #define GPIOA_MODER (*(volatile uint32_t *)(GPIOA_BASE + 0x00))
 #define GPIOA_BSRR (*(volatile uint32_t *)(GPIOA_BASE + 0x18))
+#else
+extern volatile uint32_t host_gpioa_moder;
+extern volatile uint32_t host_gpioa_bsrr;
+#define GPIOA_MODER host_gpioa_moder
+#define GPIOA_BSRR host_gpioa_bsrr
+#endif
 
 /* ST7789 Control Pins */
 #define PIN_CS 4  /* Chip Select */
@@ -155,6 +163,7 @@ void ST7789_SetAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1,
  * @param color RGB565 color value
  */
 void ST7789_Fill(uint16_t color) {
+  PROFILE_ENTER(PROF_UI);
   ST7789_SetAddressWindow(0, 0, ST7789_WIDTH - 1, ST7789_HEIGHT - 1);
 
   DC_DATA();
@@ -170,6 +179,7 @@ void ST7789_Fill(uint16_t color) {
   SPI_SetDataSize8();
 
   CS_HIGH();
+  PROFILE_EXIT();
 }
 
 /**
@@ -189,6 +199,7 @@ void ST7789_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
   if ((y + h - 1) >= ST7789_HEIGHT)
     h = ST7789_HEIGHT - y;
 
+  PROFILE_ENTER(PROF_UI);
   ST7789_SetAddressWindow(x, y, x + w - 1, y + h - 1);
 
   DC_DATA();
@@ -205,6 +216,7 @@ void ST7789_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
   SPI_SetDataSize8();
 
   CS_HIGH();
+  PROFILE_EXIT();
 }
 
 /**
@@ -245,6 +257,7 @@ void ST7789_DrawChar(uint16_t x, uint16_t y, char c, uint16_t color,
     return;
 
   uint8_t char_index = c - 32;
+  PROFILE_ENTER(PROF_UI);
 
   /* Draw 6x8 area to ensure full cell clearing for flicker-free overwriting */
   for (int i = 0; i < 6; i++) {
@@ -270,6 +283,7 @@ void ST7789_DrawChar(uint16_t x, uint16_t y, char c, uint16_t color,
       }
     }
   }
+  PROFILE_EXIT();
 }
 
 /**
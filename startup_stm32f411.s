@@ -13,6 +13,13 @@ defined in linker script */
 .word _sdata
 /* end address for the .data section. defined in linker script */
 .word _edata
+/* start address for the initialization values of the .ramfunc section.
+defined in linker script */
+.word _siramfunc
+/* start address for the .ramfunc section. defined in linker script */
+.word _sramfunc
+/* end address for the .ramfunc section. defined in linker script */
+.word _eramfunc
 /* start address for the .bss section. defined in linker script */
 .word _sbss
 /* end address for the .bss section. defined in linker script */
@@ -42,6 +49,23 @@ LoopCopyDataInit:
   cmp r4, r1
   bcc CopyDataInit
 
+/* Copy the RAM-resident code (.ramfunc) from flash to SRAM */
+  ldr r0, =_sramfunc
+  ldr r1, =_eramfunc
+  ldr r2, =_siramfunc
+  movs r3, #0
+  b LoopCopyRamfunc
+
+CopyRamfunc:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyRamfunc:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyRamfunc
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
   ldr r4, =_ebss
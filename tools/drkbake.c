@@ -0,0 +1,177 @@
+/*
+ * drkbake - build a baked kit (.DRK) on the host from a .DRM and its WAVs
+ *
+ * Usage: drkbake <sd_root> <KIT-XXX.DRM> <KIT-XXX.DRK>
+ *
+ * Sample paths in the .DRM are resolved relative to <sd_root>, with the
+ * same SAMPLES/<name> fallback the firmware uses. The output matches what
+ * Drumset_Bake() writes on the device (see drk_format.h).
+ */
+#include "drk_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Same per-sample limit as the firmware loader (16KB) */
+#define MAX_SAMPLE_SIZE (16 * 1024 / 2)
+
+static uint32_t read_le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+/**
+ * @brief Load a 44.1kHz 16-bit mono WAV
+ * @return Number of samples (capped to MAX_SAMPLE_SIZE), -1 on error
+ */
+static int load_wav(const char *path, int16_t *out) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return -1;
+
+  uint8_t riff[12];
+  if (fread(riff, 1, 12, f) != 12 || memcmp(riff, "RIFF", 4) != 0 ||
+      memcmp(riff + 8, "WAVE", 4) != 0) {
+    fclose(f);
+    return -1;
+  }
+
+  int fmt_ok = 0;
+  uint8_t chunk[8];
+  while (fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = read_le32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if (size < 16 || fread(fmt, 1, 16, f) != 16)
+        break;
+      fmt_ok = read_le16(fmt) == 1 && read_le16(fmt + 2) == 1 &&
+               read_le32(fmt + 4) == 44100 && read_le16(fmt + 14) == 16;
+      fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (!fmt_ok)
+        break;
+      uint32_t samples = size / 2;
+      if (samples > MAX_SAMPLE_SIZE)
+        samples = MAX_SAMPLE_SIZE;
+      uint8_t *raw = malloc(samples * 2);
+      size_t got = raw ? fread(raw, 2, samples, f) : 0;
+      for (size_t i = 0; i < got; i++)
+        out[i] = (int16_t)read_le16(raw + i * 2);
+      free(raw);
+      fclose(f);
+      return (int)got;
+    } else {
+      fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+    }
+  }
+
+  fclose(f);
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 4) {
+    fprintf(stderr, "usage: %s <sd_root> <KIT-XXX.DRM> <KIT-XXX.DRK>\n",
+            argv[0]);
+    return 1;
+  }
+
+  FILE *drm = fopen(argv[2], "r");
+  if (!drm) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  static int16_t pcm[DRK_CHANNELS][MAX_SAMPLE_SIZE];
+  DRKHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, DRK_MAGIC, 4);
+  header.version = DRK_VERSION;
+  header.num_channels = DRK_CHANNELS;
+
+  uint32_t next_sector = 1;
+  char line[160];
+  for (int ch = 0; ch < DRK_CHANNELS && fgets(line, sizeof(line), drm); ch++) {
+    int channel_num, volume, pan, hold = 0, decay = 0;
+    int filter = 0, cutoff = 255, resonance = 0;
+    char sample_path[DRK_PATH_LEN];
+    int parsed = sscanf(line, "%d,%63[^,],%d,%d,%d,%d,%d,%d,%d", &channel_num,
+                        sample_path, &volume, &pan, &hold, &decay, &filter,
+                        &cutoff, &resonance);
+    if ((parsed != 4 && parsed != 6 && parsed != 9) || channel_num != ch) {
+      fprintf(stderr, "%s: bad line %d\n", argv[2], ch + 1);
+      fclose(drm);
+      return 1;
+    }
+
+    DRKChannel *c = &header.channels[ch];
+    c->volume = (uint8_t)volume;
+    c->pan = (uint8_t)pan;
+    c->hold = (uint8_t)hold;
+    c->decay = (uint8_t)decay;
+    c->filter_mode = (uint8_t)filter;
+    c->cutoff = (uint8_t)cutoff;
+    c->resonance = (uint8_t)resonance;
+    snprintf(c->path, DRK_PATH_LEN, "%s", sample_path);
+
+    if (strcmp(sample_path, "EMPTY") == 0)
+      continue;
+
+    char full[512];
+    snprintf(full, sizeof(full), "%s/%s", argv[1], sample_path);
+    int n = load_wav(full, pcm[ch]);
+    if (n <= 0) {
+      const char *fname = strrchr(sample_path, '/');
+      snprintf(full, sizeof(full), "%s/SAMPLES/%s", argv[1],
+               fname ? fname + 1 : sample_path);
+      n = load_wav(full, pcm[ch]);
+    }
+    if (n <= 0) {
+      fprintf(stderr, "warning: channel %d: cannot load %s\n", ch + 1,
+              sample_path);
+      continue;
+    }
+
+    c->data_sector = next_sector;
+    c->length = (uint32_t)n;
+    next_sector += (c->length * 2 + DRK_SECTOR_SIZE - 1) / DRK_SECTOR_SIZE;
+  }
+  fclose(drm);
+  header.pcm_sectors = next_sector - 1;
+
+  FILE *out = fopen(argv[3], "wb");
+  if (!out) {
+    perror(argv[3]);
+    return 1;
+  }
+
+  uint8_t sector[DRK_SECTOR_SIZE];
+  memset(sector, 0, sizeof(sector));
+  memcpy(sector, &header, sizeof(header));
+  fwrite(sector, 1, sizeof(sector), out);
+
+  for (int ch = 0; ch < DRK_CHANNELS; ch++) {
+    DRKChannel *c = &header.channels[ch];
+    if (c->data_sector == 0)
+      continue;
+
+    uint32_t sectors = (c->length * 2 + DRK_SECTOR_SIZE - 1) / DRK_SECTOR_SIZE;
+    for (uint32_t s = 0; s < sectors; s++) {
+      memset(sector, 0, sizeof(sector));
+      for (uint32_t i = 0; i < DRK_SECTOR_SIZE / 2; i++) {
+        uint32_t idx = s * (DRK_SECTOR_SIZE / 2) + i;
+        if (idx >= c->length)
+          break;
+        sector[i * 2] = (uint8_t)(pcm[ch][idx] & 0xFF);
+        sector[i * 2 + 1] = (uint8_t)((pcm[ch][idx] >> 8) & 0xFF);
+      }
+      fwrite(sector, 1, sizeof(sector), out);
+    }
+  }
+
+  fclose(out);
+  printf("%s: %u PCM sectors\n", argv[3], header.pcm_sectors);
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * mixtables - generate the mixer's gain tables (mixer_tables.h)
+ *
+ * Usage: mixtables > mixer_tables.h
+ *
+ * All gains are Q15 (32768 = unity):
+ *   mixer_pan_law[p]        Right gain for pan p (left gain = [255 - p]).
+ *                           Constant power (sin/cos), scaled by sqrt(2) so
+ *                           a centered channel stays at unity as before.
+ *   mixer_velocity[c][v]    Velocity v (0-255) through curve c.
+ *
+ * mixer_decay[d] is Q16: the envelope multiplier per ENV_BLOCK frames for
+ * a decay of d x 10ms to -60dB.
+ *
+ * mixer_svf_g[c] is the prewarped state-variable filter gain tan(pi*f/fs)
+ * for cutoff c, exponential from CUTOFF_MIN to CUTOFF_MAX Hz.
+ */
+#include <math.h>
+#include <stdio.h>
+
+#define PI 3.14159265358979323846
+#define SAMPLE_RATE 44100.0
+#define ENV_BLOCK 16 /* Frames per envelope step, as in audio_mixer.c */
+#define CUTOFF_MIN 20.0
+#define CUTOFF_MAX 18000.0
+
+/* Curve shapes: higher = steeper */
+#define EXP_K 4.0  /* (e^(k*x) - 1) / (e^k - 1) */
+#define LOG_K 15.0 /* log(1 + k*x) / log(1 + k) */
+
+static void print_row(const char *indent, const unsigned *values, int count) {
+  for (int i = 0; i < count; i++) {
+    if (i % 8 == 0)
+      printf("%s", indent);
+    printf("%5u,%s", values[i], (i % 8 == 7 || i == count - 1) ? "\n" : " ");
+  }
+}
+
+static unsigned q15(double x) { return (unsigned)lround(x * 32768.0); }
+
+int main(void) {
+  unsigned table[256];
+
+  printf("/* Generated by tools/mixtables.c - do not edit */\n");
+  printf("#ifndef MIXER_TABLES_H\n#define MIXER_TABLES_H\n\n");
+  printf("#include <stdint.h>\n\n");
+
+  printf("/* Constant-power pan, Q15: right gain = [pan], left = [255 - pan] "
+         "*/\n");
+  printf("static const uint16_t mixer_pan_law[256] = {\n");
+  for (int p = 0; p < 256; p++)
+    table[p] = q15(sqrt(2.0) * sin(p / 255.0 * PI / 2));
+  print_row("    ", table, 256);
+  printf("};\n\n");
+
+  printf("/* Velocity curves, Q15: linear, exponential, logarithmic */\n");
+  printf("static const uint16_t mixer_velocity[3][256] = {\n");
+  for (int c = 0; c < 3; c++) {
+    for (int v = 0; v < 256; v++) {
+      double x = v / 255.0;
+      if (c == 1)
+        x = (exp(EXP_K * x) - 1) / (exp(EXP_K) - 1);
+      else if (c == 2)
+        x = log(1 + LOG_K * x) / log(1 + LOG_K);
+      table[v] = q15(x);
+    }
+    printf("    {\n");
+    print_row("        ", table, 256);
+    printf("    },\n");
+  }
+  printf("};\n\n");
+
+  printf("/* Decay multiplier per %d-frame step, Q16: [d] reaches -60dB in "
+         "d x 10ms */\n",
+         ENV_BLOCK);
+  printf("static const uint16_t mixer_decay[256] = {\n");
+  table[0] = 65535; /* Unused: decay 0 means no envelope */
+  for (int d = 1; d < 256; d++) {
+    double steps = d * 0.01 * SAMPLE_RATE / ENV_BLOCK;
+    unsigned k = (unsigned)lround(pow(10.0, -3.0 / steps) * 65536.0);
+    table[d] = (k > 65535) ? 65535 : k;
+  }
+  print_row("    ", table, 256);
+  printf("};\n\n");
+
+  printf("/* SVF gain tan(pi * f / fs), f = %g * %g^(c / 255) Hz */\n",
+         CUTOFF_MIN, CUTOFF_MAX / CUTOFF_MIN);
+  printf("static const float mixer_svf_g[256] = {\n");
+  for (int c = 0; c < 256; c++) {
+    double f = CUTOFF_MIN * pow(CUTOFF_MAX / CUTOFF_MIN, c / 255.0);
+    if (c % 4 == 0)
+      printf("    ");
+    printf("%.8ef,%s", tan(PI * f / SAMPLE_RATE), (c % 4 == 3) ? "\n" : " ");
+  }
+  printf("};\n\n#endif\n");
+  return 0;
+}
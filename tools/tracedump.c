@@ -0,0 +1,251 @@
+/*
+ * tracedump - turn a trace dump into a Chrome trace (chrome://tracing,
+ * Perfetto)
+ *
+ * Usage: tracedump <dump.bin> [out.json]
+ *
+ * The dump is what Trace_Dump() writes (see trace.h): a header, then the
+ * ring. Captured over SWO it may still be wrapped in ITM packets; those are
+ * unwrapped here (stimulus port 0). Events come out oldest first on one
+ * timeline per source: audio interrupt, clock, sequencer, pads, SD card
+ * and display. Entries that were being written when the dump started are
+ * dropped.
+ */
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Timelines */
+#define TID_AUDIO 1
+#define TID_CLOCK 2
+#define TID_SEQUENCER 3
+#define TID_PADS 4
+#define TID_SD 5
+#define TID_UI 6
+#define TID_COUNT 7
+
+static const char *tid_names[TID_COUNT] = {
+    "", "audio interrupt", "clock (TIM2)", "sequencer", "pads", "SD card",
+    "display"};
+
+static uint32_t read_le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+/**
+ * @brief Pull stimulus port 0 payloads out of an ITM packet stream
+ * @return Payload length
+ */
+static size_t itm_unwrap(const uint8_t *in, size_t len, uint8_t *out) {
+  static const size_t sizes[4] = {0, 1, 2, 4};
+  size_t n = 0;
+  size_t i = 0;
+
+  while (i < len) {
+    uint8_t h = in[i++];
+    if (h & 0x03) {
+      /* Source packet: software (bit 2 clear) on port h >> 3 */
+      size_t size = sizes[h & 0x03];
+      if (i + size > len)
+        break;
+      if (!(h & 0x04) && (h >> 3) == 0) {
+        memcpy(out + n, in + i, size);
+        n += size;
+      }
+      i += size;
+    } else if (h & 0x80) {
+      /* Timestamp or extension: continuation bytes follow */
+      while (i < len && (in[i++] & 0x80))
+        ;
+    }
+    /* Sync (0x00) and overflow (0x70) carry nothing */
+  }
+  return n;
+}
+
+static void emit(FILE *out, int *first, const char *name, char ph, int tid,
+                 double ts, const char *args) {
+  fprintf(out, "%s\n  {\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,"
+               "\"ts\":%.3f",
+          *first ? "" : ",", name, ph, tid, ts);
+  if (ph == 'i')
+    fprintf(out, ",\"s\":\"%c\"", (tid == 0) ? 'g' : 't');
+  if (args)
+    fprintf(out, ",\"args\":{%s}", args);
+  fprintf(out, "}");
+  *first = 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s <dump.bin> [out.json]\n", argv[0]);
+    return 1;
+  }
+
+  FILE *f = fopen(argv[1], "rb");
+  if (!f) {
+    perror(argv[1]);
+    return 1;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *raw = malloc(size > 0 ? (size_t)size : 1);
+  uint8_t *data = malloc(size > 0 ? (size_t)size : 1);
+  if (!raw || !data || fread(raw, 1, (size_t)size, f) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", argv[1]);
+    return 1;
+  }
+  fclose(f);
+
+  /* Plain dump, or ITM packets around it */
+  size_t len = (size_t)size;
+  if (len >= 4 && memcmp(raw, TRACE_MAGIC, 4) == 0)
+    memcpy(data, raw, len);
+  else
+    len = itm_unwrap(raw, len, data);
+
+  size_t start = 0;
+  while (start + 4 <= len && memcmp(data + start, TRACE_MAGIC, 4) != 0)
+    start++;
+  if (start + TRACE_HEADER_SIZE > len) {
+    fprintf(stderr, "%s: no trace header found\n", argv[1]);
+    return 1;
+  }
+
+  const uint8_t *hdr = data + start;
+  uint16_t version = read_le16(hdr + 4);
+  uint32_t entries = read_le16(hdr + 6);
+  uint32_t head = read_le32(hdr + 8);
+  uint32_t cycles_us = read_le32(hdr + 12);
+  const uint8_t *ring = hdr + TRACE_HEADER_SIZE;
+
+  if (version != TRACE_VERSION || entries == 0 || cycles_us == 0) {
+    fprintf(stderr, "%s: unsupported trace (version %u)\n", argv[1],
+            version);
+    return 1;
+  }
+  if ((size_t)(ring - data) + entries * 8 > len) {
+    fprintf(stderr, "%s: truncated (%u entries expected)\n", argv[1],
+            entries);
+    return 1;
+  }
+
+  FILE *out = stdout;
+  if (argc == 3) {
+    out = fopen(argv[2], "w");
+    if (!out) {
+      perror(argv[2]);
+      return 1;
+    }
+  }
+
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  int first = 1;
+  for (int t = 1; t < TID_COUNT; t++) {
+    char args[64];
+    snprintf(args, sizeof(args), "\"name\":\"%s\"", tid_names[t]);
+    fprintf(out, "%s\n  {\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%d,\"args\":{%s}}",
+            first ? "" : ",", t, args);
+    first = 0;
+  }
+
+  /* Oldest first; time unwrapped from the 32-bit counter */
+  uint32_t oldest = (head > entries) ? head - entries : 0;
+  uint32_t kept = 0, dropped = 0, prev = 0;
+  int open[TID_COUNT] = {0};
+  double now = 0;
+
+  for (uint32_t index = oldest; index != head; index++) {
+    const uint8_t *e = ring + (index % entries) * 8;
+    if (e[7] != (uint8_t)(index / entries)) {
+      dropped++;
+      continue;
+    }
+
+    uint32_t time = read_le32(e);
+    if (kept > 0)
+      now += (double)(int32_t)(time - prev) / cycles_us;
+    prev = time;
+    kept++;
+
+    uint8_t a = e[5], b = e[6];
+    char args[96];
+    switch (e[4]) {
+    case TRACE_CLOCK:
+      snprintf(args, sizeof(args), "\"pulse\":%u", a);
+      emit(out, &first, "pulse", 'i', TID_CLOCK, now, args);
+      break;
+    case TRACE_STEP:
+      snprintf(args, sizeof(args), "\"step\":%u,\"bar\":%u", a, b);
+      emit(out, &first, "step", 'i', TID_SEQUENCER, now, args);
+      break;
+    case TRACE_TRIGGER:
+    case TRACE_PAD:
+      snprintf(args, sizeof(args), "\"channel\":%u,\"velocity\":%u", a, b);
+      emit(out, &first, "hit", 'i',
+           (e[4] == TRACE_PAD) ? TID_PADS : TID_SEQUENCER, now, args);
+      break;
+    case TRACE_RENDER_BEGIN:
+      snprintf(args, sizeof(args), "\"frames\":%u", 64u << (a & 3));
+      emit(out, &first, "render", 'B', TID_AUDIO, now, args);
+      open[TID_AUDIO]++;
+      break;
+    case TRACE_RENDER_END:
+      if (!open[TID_AUDIO])
+        break; /* Began before the window */
+      snprintf(args, sizeof(args), "\"late\":%u,\"margin_frames\":%u", a,
+               b * 4u);
+      emit(out, &first, "render", 'E', TID_AUDIO, now, args);
+      open[TID_AUDIO]--;
+      break;
+    case TRACE_UNDERRUN:
+      emit(out, &first, "UNDERRUN", 'i', 0, now, NULL);
+      break;
+    case TRACE_SD_BEGIN: {
+      char name[16];
+      snprintf(name, sizeof(name), "CMD%u", a);
+      snprintf(args, sizeof(args), "\"blocks\":%u", b);
+      emit(out, &first, name, 'B', TID_SD, now, args);
+      open[TID_SD]++;
+      break;
+    }
+    case TRACE_SD_END:
+      if (!open[TID_SD])
+        break;
+      snprintf(args, sizeof(args), "\"result\":%d", (int8_t)a);
+      emit(out, &first, "", 'E', TID_SD, now, args);
+      open[TID_SD]--;
+      break;
+    case TRACE_UI_BEGIN:
+      snprintf(args, sizeof(args), "\"full\":%u", a);
+      emit(out, &first, "redraw", 'B', TID_UI, now, args);
+      open[TID_UI]++;
+      break;
+    case TRACE_UI_END:
+      if (!open[TID_UI])
+        break;
+      emit(out, &first, "redraw", 'E', TID_UI, now, NULL);
+      open[TID_UI]--;
+      break;
+    default:
+      snprintf(args, sizeof(args), "\"type\":%u,\"a\":%u,\"b\":%u", e[4], a,
+               b);
+      emit(out, &first, "unknown", 'i', 0, now, args);
+      break;
+    }
+  }
+  fprintf(out, "\n]}\n");
+  if (out != stdout)
+    fclose(out);
+
+  fprintf(stderr, "%u events over %.3fms, %u dropped\n", kept, now / 1000,
+          dropped);
+  free(raw);
+  free(data);
+  return 0;
+}
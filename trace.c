@@ -0,0 +1,147 @@
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#include <stddef.h>
+#include <string.h>
+
+/* Index masking needs a power of two */
+typedef char trace_entries_pow2[(TRACE_ENTRIES & (TRACE_ENTRIES - 1)) ? -1
+                                                                       : 1];
+
+/* ITM (SWO) */
+#define ITM_STIM0 (*(volatile uint32_t *)0xE0000000)
+#define ITM_TER (*(volatile uint32_t *)0xE0000E00)
+#define ITM_TCR (*(volatile uint32_t *)0xE0000E80)
+
+static TraceEntry ring[TRACE_ENTRIES];
+static uint32_t head = 0; /* Events reserved so far (next index) */
+static const volatile uint32_t *cycle_counter = NULL;
+static uint32_t cycles_us = 1;
+static volatile uint8_t frozen = 0;
+
+/* Freezing and restarting the ring must not interleave with a
+ * Trace_Record from an interrupt: both run with interrupts masked */
+static inline uint32_t irq_save(void) {
+#if defined(__arm__)
+  uint32_t primask;
+  __asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask) : : "memory");
+  return primask;
+#else
+  return 0;
+#endif
+}
+
+static inline void irq_restore(uint32_t primask) {
+#if defined(__arm__)
+  __asm volatile("msr primask, %0" : : "r"(primask) : "memory");
+#else
+  (void)primask;
+#endif
+}
+
+/**
+ * @brief Empty the ring and record against a counter (interrupts masked)
+ */
+static void restart(const volatile uint32_t *counter,
+                    uint32_t cycles_per_us) {
+  memset(ring, 0xFF, sizeof(ring)); /* Lap 255: nothing valid yet */
+  head = 0;
+  cycles_us = cycles_per_us ? cycles_per_us : 1;
+  frozen = 0;
+  cycle_counter = counter;
+}
+
+void Trace_Init(const volatile uint32_t *counter, uint32_t cycles_per_us) {
+  uint32_t primask = irq_save();
+  restart(counter, cycles_per_us);
+  irq_restore(primask);
+}
+
+void Trace_Record(uint8_t type, uint8_t a, uint8_t b) {
+  if (!cycle_counter || frozen)
+    return;
+
+  /* Reserve a slot; interrupts that preempt us take the next ones */
+  uint32_t index = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+  TraceEntry *e = &ring[index & (TRACE_ENTRIES - 1)];
+  e->time = *cycle_counter;
+  e->type = type;
+  e->a = a;
+  e->b = b;
+  __asm volatile("" : : : "memory"); /* Entry before lap */
+  e->lap = (uint8_t)(index / TRACE_ENTRIES);
+}
+
+void Trace_Freeze(void) { frozen = 1; }
+
+uint8_t Trace_IsFrozen(void) { return frozen; }
+
+static void put_le16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+  put_le16(p, (uint16_t)v);
+  put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+int Trace_Dump(TraceWriter writer) {
+  uint8_t header[TRACE_HEADER_SIZE];
+  int result = 0;
+
+  /* Freeze and take the count in one go */
+  uint32_t primask = irq_save();
+  frozen = 1;
+  uint32_t recorded = head;
+  irq_restore(primask);
+
+  memcpy(header, TRACE_MAGIC, 4);
+  put_le16(header + 4, TRACE_VERSION);
+  put_le16(header + 6, TRACE_ENTRIES);
+  put_le32(header + 8, recorded);
+  put_le32(header + 12, cycles_us);
+  if (writer(header, sizeof(header)) != 0)
+    result = -1;
+
+  for (uint32_t i = 0; i < TRACE_ENTRIES && result == 0; i++) {
+    uint8_t raw[sizeof(TraceEntry)];
+    put_le32(raw, ring[i].time);
+    raw[4] = ring[i].type;
+    raw[5] = ring[i].a;
+    raw[6] = ring[i].b;
+    raw[7] = ring[i].lap;
+    if (writer(raw, sizeof(raw)) != 0)
+      result = -1;
+  }
+
+  /* Start a fresh window */
+  primask = irq_save();
+  restart(cycle_counter, cycles_us);
+  irq_restore(primask);
+  return result;
+}
+
+/**
+ * @brief Send bytes to ITM stimulus port 0, a word at a time
+ */
+static int itm_write(const uint8_t *data, uint32_t len) {
+  for (uint32_t i = 0; i < len; i += 4) {
+    uint32_t word = 0;
+    for (uint32_t k = 0; k < 4 && i + k < len; k++)
+      word |= (uint32_t)data[i + k] << (8 * k);
+    while (ITM_STIM0 == 0) /* FIFO full */
+      ;
+    ITM_STIM0 = word;
+  }
+  return 0;
+}
+
+int Trace_DumpITM(void) {
+  if (!(ITM_TCR & 1) || !(ITM_TER & 1))
+    return -1;
+  return Trace_Dump(itm_write);
+}
+
+#endif
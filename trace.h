@@ -0,0 +1,110 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/* Build with -DTRACE_ENABLE=0 (make TRACE=0) to compile it all out */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+
+/* Ring size in events (power of two, 8 bytes each: 1KB by default, about
+ * 150ms of playback: renders, clock pulses, steps and hits) */
+#ifndef TRACE_ENTRIES
+#define TRACE_ENTRIES 128
+#endif
+
+/* Event types (a, b) */
+#define TRACE_CLOCK 1        /* TIM2 pulse (pulse 0-23) */
+#define TRACE_STEP 2         /* Master step (step, 1 at the bar start) */
+#define TRACE_TRIGGER 3      /* Sequencer hit (channel, velocity) */
+#define TRACE_PAD 4          /* Pad hit (channel, velocity) */
+#define TRACE_RENDER_BEGIN 5 /* Audio interrupt entry (latency mode) */
+#define TRACE_RENDER_END 6   /* Audio interrupt exit (late, margin / 4) */
+#define TRACE_UNDERRUN 7     /* Render the DMA overtook; ring freezes */
+#define TRACE_SD_BEGIN 8     /* SD transfer (command, blocks) */
+#define TRACE_SD_END 9       /* SD transfer done (result) */
+#define TRACE_UI_BEGIN 10    /* Screen redraw */
+#define TRACE_UI_END 11      /* Screen redraw done */
+
+/* Dump layout, little-endian: magic, version (16 bits), entries (16),
+ * head (32, events recorded), cycles per microsecond (32), then the ring
+ * as 8-byte entries */
+#define TRACE_MAGIC "DTRC"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 16
+
+/**
+ * @brief One event in the ring
+ * @details `lap` is written last: (index / TRACE_ENTRIES) & 0xFF. An entry
+ *          whose lap does not match its index is stale or half written.
+ */
+typedef struct {
+  uint32_t time; /* Cycle counter */
+  uint8_t type;  /* TRACE_* */
+  uint8_t a;
+  uint8_t b;
+  uint8_t lap;
+} TraceEntry;
+
+/**
+ * @brief Receives the dump
+ * @param data Bytes to send
+ * @param len Number of bytes
+ * @return 0 on success, negative to abort the dump
+ */
+typedef int (*TraceWriter)(const uint8_t *data, uint32_t len);
+
+#if TRACE_ENABLE
+
+/**
+ * @brief Start tracing against a free-running cycle counter
+ * @param counter Counter register (e.g. the DWT cycle counter)
+ * @param cycles_per_us Counter cycles per microsecond (for the decoder)
+ */
+void Trace_Init(const volatile uint32_t *counter, uint32_t cycles_per_us);
+
+/**
+ * @brief Record an event
+ * @details Lock-free: safe from any interrupt level. Does nothing while
+ *          frozen.
+ * @param type TRACE_* value
+ * @param a First argument
+ * @param b Second argument
+ */
+void Trace_Record(uint8_t type, uint8_t a, uint8_t b);
+
+/**
+ * @brief Stop recording so the events leading up to now are kept
+ */
+void Trace_Freeze(void);
+
+/**
+ * @brief Check if recording is frozen
+ * @return 1 if frozen, 0 otherwise
+ */
+uint8_t Trace_IsFrozen(void);
+
+/**
+ * @brief Write the header and the ring, then record again
+ * @details Recording pauses while writing. Main loop only.
+ * @param writer Destination
+ * @return 0 on success, -1 if the writer failed
+ */
+int Trace_Dump(TraceWriter writer);
+
+/**
+ * @brief Dump over SWO (ITM stimulus port 0)
+ * @return 0 on success, -1 if no debugger has enabled the ITM port
+ */
+int Trace_DumpITM(void);
+
+#define TRACE(type, a, b) Trace_Record((type), (uint8_t)(a), (uint8_t)(b))
+
+#else
+
+#define TRACE(type, a, b) ((void)0)
+
+#endif
+
+#endif
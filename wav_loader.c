@@ -1,6 +1,8 @@
 #include "wav_loader.h"
 #include "audio_mixer.h"
+#include "drk_format.h"
 #include "fat32.h"
+#include "sample_cache.h"
 #include "sdcard.h"
 #include <stdio.h>
 #include <string.h>
@@ -26,9 +28,55 @@ typedef struct {
 /* Static buffer for reading sectors */
 static uint8_t sector_buffer[512];
 
-/* Static sample buffers (6 channels x 16KB each = 96KB) */
+/* Baked kit header (static to keep it off the UI stack) */
+static DRKHeader drk_header;
+
+/* Per-sample limit (16KB); storage lives in the shared sample cache */
 #define MAX_SAMPLE_SIZE (16 * 1024 / 2) // 16KB = 8192 samples
-static int16_t sample_buffers[NUM_CHANNELS][MAX_SAMPLE_SIZE];
+
+/* Cache handle held by each channel (-1 = none) */
+static int channel_handles[NUM_CHANNELS] = {-1, -1, -1, -1, -1, -1};
+
+/* File identity of each channel's sample (valid while a handle is held) */
+typedef struct {
+  uint32_t first_cluster;
+  uint32_t size;
+} SampleIdentity;
+
+static SampleIdentity channel_ids[NUM_CHANNELS];
+
+/* Where a kit load lands: the live channels or the staging area */
+typedef struct {
+  Drumset *drumset;
+  int *handles;
+  SampleIdentity *ids;
+  uint8_t live; /* 1 = channels feed the mixer directly */
+} KitTarget;
+
+/* Kit prepared ahead of a pattern boundary (see Drumset_Stage) */
+static Drumset staged_drumset;
+static int staged_handles[NUM_CHANNELS] = {-1, -1, -1, -1, -1, -1};
+static SampleIdentity staged_ids[NUM_CHANNELS];
+static uint8_t staged_slot = 0; /* 0 = nothing staged */
+
+static KitTarget live_target(Drumset *drumset) {
+  KitTarget target = {drumset, channel_handles, channel_ids, 1};
+  return target;
+}
+
+/**
+ * @brief Drop a channel's reference to its cached sample
+ * @details Stops the mixer voice first; AudioMixer_SetSample returns only
+ *          once the audio interrupt can no longer read the old buffer, so
+ *          the arena region can be reused straight after
+ */
+static void release_channel(KitTarget *target, uint8_t channel) {
+  if (target->live) {
+    AudioMixer_SetSample(channel, NULL, 0);
+  }
+  SampleCache_Release(target->handles[channel]);
+  target->handles[channel] = -1;
+}
 
 /**
  * @brief Load WAV file into provided buffer
@@ -124,18 +172,51 @@ static int load_wav_to_buffer(FAT32_FileEntry *file_entry, int16_t *buffer,
   return samples_copied;
 }
 
-int WAV_LoadSample(FAT32_FileEntry *file_entry, uint8_t channel_idx,
-                   Drumset *drumset) {
-  if (channel_idx >= NUM_CHANNELS) {
-    return -1;
-  }
+/**
+ * @brief Load a WAV into one channel of a kit target
+ * @return Number of samples loaded, or negative on error
+ */
+static int bind_sample(KitTarget *target, FAT32_FileEntry *file_entry,
+                       uint8_t channel_idx) {
+  Drumset *drumset = target->drumset;
+  release_channel(target, channel_idx);
+
+  /* Shared or recently used sample: no SD access needed */
+  int handle =
+      SampleCache_Find(file_entry->first_cluster, file_entry->size);
+  int samples_loaded;
+
+  if (handle >= 0) {
+    samples_loaded = SampleCache_GetLength(handle);
+  } else {
+    /* Reserve worst-case space, trimmed to the real length on commit */
+    uint32_t max_samples =
+        (file_entry->size > 44) ? (file_entry->size - 44) / 2 : 1;
+    if (max_samples > MAX_SAMPLE_SIZE) {
+      max_samples = MAX_SAMPLE_SIZE;
+    }
 
-  /* Load this file */
-  drumset->samples[channel_idx] = sample_buffers[channel_idx];
-  int samples_loaded = load_wav_to_buffer(
-      file_entry, sample_buffers[channel_idx], MAX_SAMPLE_SIZE);
+    handle = SampleCache_Allocate(file_entry->first_cluster, file_entry->size,
+                                  max_samples);
+    if (handle < 0) {
+      samples_loaded = -7; /* Sample arena full */
+    } else {
+      samples_loaded = load_wav_to_buffer(
+          file_entry, SampleCache_GetData(handle), max_samples);
+      if (samples_loaded > 0) {
+        SampleCache_Commit(handle, samples_loaded);
+      } else {
+        SampleCache_Release(handle);
+        handle = -1;
+      }
+    }
+  }
 
   if (samples_loaded > 0) {
+    target->handles[channel_idx] = handle;
+    target->ids[channel_idx].first_cluster = file_entry->first_cluster;
+    target->ids[channel_idx].size = file_entry->size;
+    drumset->samples[channel_idx] = SampleCache_GetData(handle);
     drumset->lengths[channel_idx] = samples_loaded;
 
     /* Use filename (without .wav) as label */
@@ -154,32 +235,39 @@ int WAV_LoadSample(FAT32_FileEntry *file_entry, uint8_t channel_idx,
      */
 
     /* Update AudioMixer with new sample */
-    AudioMixer_SetSample(channel_idx, sample_buffers[channel_idx],
-                         samples_loaded);
-  } else {
-    /* Clear channel on error */
-    drumset->lengths[channel_idx] = 1000;
-    for (uint32_t j = 0; j < 1000; j++) {
-      sample_buffers[channel_idx][j] = 0;
+    if (target->live) {
+      AudioMixer_SetSample(channel_idx, drumset->samples[channel_idx],
+                           samples_loaded);
     }
+  } else {
+    /* Channel stays silent on error */
+    drumset->samples[channel_idx] = NULL;
+    drumset->lengths[channel_idx] = 0;
   }
 
   return samples_loaded;
 }
 
-void WAV_UnloadChannel(uint8_t channel, Drumset *drumset) {
-  if (channel >= NUM_CHANNELS)
-    return;
-
-  /* Clear sample buffer */
-  drumset->lengths[channel] = 0;
-  for (uint32_t i = 0; i < 1000; i++) {
-    sample_buffers[channel][i] = 0;
+int WAV_LoadSample(FAT32_FileEntry *file_entry, uint8_t channel_idx,
+                   Drumset *drumset) {
+  if (channel_idx >= NUM_CHANNELS) {
+    return -1;
   }
 
-  /* Update audio mixer to stop playing this channel */
-  drumset->samples[channel] = sample_buffers[channel];
-  AudioMixer_SetSample(channel, sample_buffers[channel], 0);
+  KitTarget target = live_target(drumset);
+  return bind_sample(&target, file_entry, channel_idx);
+}
+
+/**
+ * @brief Empty one channel of a kit target
+ */
+static void unbind_channel(KitTarget *target, uint8_t channel) {
+  Drumset *drumset = target->drumset;
+
+  /* Stop the voice and drop the cache reference (sample stays resident) */
+  release_channel(target, channel);
+  drumset->samples[channel] = NULL;
+  drumset->lengths[channel] = 0;
 
   /* Set name to EMPTY */
   strncpy(drumset->sample_names[channel], "EMPTY",
@@ -189,19 +277,116 @@ void WAV_UnloadChannel(uint8_t channel, Drumset *drumset) {
   drumset->sample_paths[channel][0] = '\0';
 }
 
-int Drumset_Save(Drumset *drumset, uint8_t slot) {
-  if (slot < 1 || slot > 100) {
-    return -1;
+void WAV_UnloadChannel(uint8_t channel, Drumset *drumset) {
+  if (channel >= NUM_CHANNELS)
+    return;
+
+  KitTarget target = live_target(drumset);
+  unbind_channel(&target, channel);
+}
+
+/**
+ * @brief Build the path stored for a channel in kit files
+ * @param out Buffer of at least 64 bytes
+ */
+static void build_sample_path(Drumset *drumset, int ch, char *out) {
+  const char *sample_name = drumset->sample_names[ch];
+
+  if (strcmp(sample_name, "EMPTY") == 0) {
+    strcpy(out, "EMPTY");
+  } else {
+    // Use stored full path if available, otherwise fallback to default
+    // SAMPLES/
+    if (strlen(drumset->sample_paths[ch]) > 0) {
+      strncpy(out, drumset->sample_paths[ch], 63);
+      out[63] = '\0';
+    } else {
+      snprintf(out, 64, "SAMPLES/%s.WAV", sample_name);
+    }
   }
+}
 
-  // Find or create DRUMSETS directory
-  uint32_t drumsets_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "DRUMSETS");
-  if (drumsets_cluster == 0) {
-    // DRUMSETS folder doesn't exist - for now, return error
-    // TODO: Create directory if needed
-    return -1;
+/**
+ * @brief Write KIT-XXX.DRK (header sector + sector-aligned PCM)
+ * @return 0 on success, negative on error
+ */
+static int bake_to_slot(Drumset *drumset, uint32_t drumsets_cluster,
+                        uint8_t slot) {
+  memset(&drk_header, 0, sizeof(drk_header));
+  memcpy(drk_header.magic, DRK_MAGIC, 4);
+  drk_header.version = DRK_VERSION;
+  drk_header.num_channels = DRK_CHANNELS;
+
+  /* Lay out channels back to back, each starting on a sector */
+  uint32_t next_sector = 1;
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    DRKChannel *c = &drk_header.channels[ch];
+    c->volume = drumset->volumes[ch];
+    c->pan = drumset->pans[ch];
+    c->hold = drumset->holds[ch];
+    c->decay = drumset->decays[ch];
+    c->filter_mode = drumset->filter_modes[ch];
+    c->cutoff = drumset->cutoffs[ch];
+    c->resonance = drumset->resonances[ch];
+    build_sample_path(drumset, ch, c->path);
+
+    if (drumset->samples[ch] != NULL && drumset->lengths[ch] > 0) {
+      c->data_sector = next_sector;
+      c->length = drumset->lengths[ch];
+      next_sector += (c->length * 2 + DRK_SECTOR_SIZE - 1) / DRK_SECTOR_SIZE;
+    }
+  }
+  drk_header.pcm_sectors = next_sector - 1;
+
+  char filename[13];
+  snprintf(filename, sizeof(filename), "KIT-%03d.DRK", slot);
+
+  uint32_t first_sector;
+  int res = FAT32_CreateContiguous(drumsets_cluster, filename,
+                                   next_sector * DRK_SECTOR_SIZE,
+                                   &first_sector);
+  if (res != 0) {
+    return res;
   }
 
+  memset(sector_buffer, 0, sizeof(sector_buffer));
+  memcpy(sector_buffer, &drk_header, sizeof(drk_header));
+  if (SDCARD_WriteBlock(first_sector, sector_buffer) != SDCARD_OK) {
+    return -5;
+  }
+
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    DRKChannel *c = &drk_header.channels[ch];
+    if (c->data_sector == 0) {
+      continue;
+    }
+
+    const uint8_t *src = (const uint8_t *)drumset->samples[ch];
+    uint32_t bytes_left = c->length * 2;
+    uint32_t sector = first_sector + c->data_sector;
+
+    while (bytes_left > 0) {
+      uint32_t chunk =
+          (bytes_left > DRK_SECTOR_SIZE) ? DRK_SECTOR_SIZE : bytes_left;
+      memset(sector_buffer, 0, sizeof(sector_buffer));
+      memcpy(sector_buffer, src, chunk);
+      if (SDCARD_WriteBlock(sector++, sector_buffer) != SDCARD_OK) {
+        return -5;
+      }
+      src += chunk;
+      bytes_left -= chunk;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Write KIT-XXX.DRM text file
+ * @return 0 on success, negative on error
+ */
+static int save_to_slot(Drumset *drumset, uint32_t drumsets_cluster,
+                        uint8_t slot) {
   // Generate filename: KIT-XXX.DRM
   char filename[13];
   snprintf(filename, sizeof(filename), "KIT-%03d.DRM", slot);
@@ -211,30 +396,26 @@ int Drumset_Save(Drumset *drumset, uint8_t slot) {
   int offset = 0;
 
   for (int ch = 0; ch < NUM_CHANNELS; ch++) {
-    // Format: channel,sample_path,volume,pan\n
-    // For sample path, use relative path from SAMPLES folder
-    const char *sample_name = drumset->sample_names[ch];
-
-    // Build sample path
-    // Build sample path
+    // Format: channel,sample_path,volume,pan[,hold,decay[,filter,cutoff,
+    // resonance]]\n - trailing fields are left out while at their defaults
+    // so the file stays within one sector
     char sample_path[64];
-    if (strcmp(sample_name, "EMPTY") == 0) {
-      strcpy(sample_path, "EMPTY");
-    } else {
-      // Use stored full path if available, otherwise fallback to default
-      // SAMPLES/
-      if (strlen(drumset->sample_paths[ch]) > 0) {
-        strncpy(sample_path, drumset->sample_paths[ch], sizeof(sample_path));
-        sample_path[sizeof(sample_path) - 1] = '\0';
-      } else {
-        snprintf(sample_path, sizeof(sample_path), "SAMPLES/%s.WAV",
-                 sample_name);
-      }
+    build_sample_path(drumset, ch, sample_path);
+
+    char tail[24] = "";
+    if (drumset->filter_modes[ch] != AUDIO_FILTER_OFF ||
+        drumset->cutoffs[ch] != 255 || drumset->resonances[ch] != 0) {
+      snprintf(tail, sizeof(tail), ",%d,%d,%d,%d,%d", drumset->holds[ch],
+               drumset->decays[ch], drumset->filter_modes[ch],
+               drumset->cutoffs[ch], drumset->resonances[ch]);
+    } else if (drumset->holds[ch] != 0 || drumset->decays[ch] != 0) {
+      snprintf(tail, sizeof(tail), ",%d,%d", drumset->holds[ch],
+               drumset->decays[ch]);
     }
 
-    int written =
-        snprintf(buffer + offset, sizeof(buffer) - offset, "%d,%s,%d,%d\n", ch,
-                 sample_path, drumset->volumes[ch], drumset->pans[ch]);
+    int written = snprintf(buffer + offset, sizeof(buffer) - offset,
+                           "%d,%s,%d,%d%s\n", ch, sample_path,
+                           drumset->volumes[ch], drumset->pans[ch], tail);
 
     if (written < 0 || (offset + (uint32_t)written) >= sizeof(buffer)) {
       return -1; // Buffer overflow
@@ -247,11 +428,310 @@ int Drumset_Save(Drumset *drumset, uint8_t slot) {
   return FAT32_WriteFile(drumsets_cluster, filename, (uint8_t *)buffer, offset);
 }
 
-int Drumset_LoadFromSlot(Drumset *drumset, uint8_t slot) {
+int Drumset_Save(Drumset *drumset, uint8_t slot) {
+  if (slot < 1 || slot > 100) {
+    return -1;
+  }
+
+  // Find or create DRUMSETS directory
+  uint32_t drumsets_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "DRUMSETS");
+  if (drumsets_cluster == 0) {
+    // DRUMSETS folder doesn't exist - for now, return error
+    // TODO: Create directory if needed
+    return -1;
+  }
+
+  int res = save_to_slot(drumset, drumsets_cluster, slot);
+  if (res != 0) {
+    return res;
+  }
+
+  /* Keep an existing baked copy in sync (it is preferred on load) */
+  char baked_name[13];
+  snprintf(baked_name, sizeof(baked_name), "KIT-%03d.DRK", slot);
+  if (FAT32_FileExists(drumsets_cluster, baked_name)) {
+    return bake_to_slot(drumset, drumsets_cluster, slot);
+  }
+
+  return 0;
+}
+
+int Drumset_Bake(Drumset *drumset, uint8_t slot) {
   if (slot < 1 || slot > 100) {
     return -1;
   }
 
+  uint32_t drumsets_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "DRUMSETS");
+  if (drumsets_cluster == 0) {
+    return -1;
+  }
+
+  /* The .DRM stays the editable source of truth */
+  int res = save_to_slot(drumset, drumsets_cluster, slot);
+  if (res != 0) {
+    return res;
+  }
+
+  return bake_to_slot(drumset, drumsets_cluster, slot);
+}
+
+/**
+ * @brief Load a baked kit with one multi-block read of its PCM region
+ * @param baked_file Directory entry of KIT-XXX.DRK
+ * @return 0 on success, -1 if the file is unusable (caller falls back)
+ */
+static int load_baked(KitTarget *target, FAT32_FileEntry *baked_file) {
+  Drumset *drumset = target->drumset;
+
+  /* Single-seek loading needs the clusters back to back */
+  if (!FAT32_IsContiguous(baked_file)) {
+    return -1;
+  }
+
+  uint32_t first_sector = FAT32_GetFileSector(baked_file);
+  if (first_sector == 0 ||
+      SDCARD_ReadBlock(first_sector, sector_buffer) != SDCARD_OK) {
+    return -1;
+  }
+
+  memcpy(&drk_header, sector_buffer, sizeof(drk_header));
+
+  if (memcmp(drk_header.magic, DRK_MAGIC, 4) != 0 ||
+      drk_header.version != DRK_VERSION || drk_header.num_channels != DRK_CHANNELS) {
+    return -1;
+  }
+
+  const uint32_t samples_per_sector = DRK_SECTOR_SIZE / 2;
+  uint32_t pcm_samples = drk_header.pcm_sectors * samples_per_sector;
+  if (pcm_samples > SAMPLE_CACHE_ARENA_SAMPLES ||
+      (drk_header.pcm_sectors + 1) * DRK_SECTOR_SIZE > baked_file->size) {
+    return -1;
+  }
+
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    DRKChannel *c = &drk_header.channels[ch];
+    if (c->data_sector == 0) {
+      continue;
+    }
+    if (c->length > MAX_SAMPLE_SIZE ||
+        (c->data_sector - 1) * samples_per_sector + c->length > pcm_samples) {
+      return -1;
+    }
+  }
+
+  /* Whole PCM region lives in one cache entry keyed by the .DRK. It is
+   * read before the kit is touched: the old channels keep their samples
+   * (and their arena space) until it is in, so a failed read leaves the
+   * kit as it was. Only when both kits do not fit in the arena do the old
+   * samples go first (as on the .DRM path); the kit is then left empty,
+   * never pointing at freed samples. */
+  int handle = -1;
+  if (drk_header.pcm_sectors > 0) {
+    handle = SampleCache_Find(baked_file->first_cluster, baked_file->size);
+    if (handle < 0) {
+      handle = SampleCache_Allocate(baked_file->first_cluster,
+                                    baked_file->size, pcm_samples);
+      if (handle < 0) {
+        for (int ch = 0; ch < NUM_CHANNELS; ch++)
+          unbind_channel(target, ch);
+        handle = SampleCache_Allocate(baked_file->first_cluster,
+                                      baked_file->size, pcm_samples);
+      }
+      if (handle < 0) {
+        return -1;
+      }
+      if (SDCARD_ReadMultiBlock(first_sector + 1, drk_header.pcm_sectors,
+                                (uint8_t *)SampleCache_GetData(handle)) !=
+          SDCARD_OK) {
+        SampleCache_Release(handle);
+        return -1;
+      }
+      SampleCache_Commit(handle, pcm_samples);
+    }
+  }
+
+  /* Now swap: mix settings, then the channels */
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    drumset->volumes[ch] = drk_header.channels[ch].volume;
+    drumset->pans[ch] = drk_header.channels[ch].pan;
+    drumset->holds[ch] = drk_header.channels[ch].hold;
+    drumset->decays[ch] = drk_header.channels[ch].decay;
+    drumset->filter_modes[ch] = drk_header.channels[ch].filter_mode;
+    drumset->cutoffs[ch] = drk_header.channels[ch].cutoff;
+    drumset->resonances[ch] = drk_header.channels[ch].resonance;
+    if (drumset->filter_modes[ch] == AUDIO_FILTER_OFF &&
+        drumset->cutoffs[ch] == 0)
+      drumset->cutoffs[ch] = 255; /* Older files: open filter */
+    if (target->live) {
+      AudioMixer_SetVolume(ch, drumset->volumes[ch]);
+      AudioMixer_SetPan(ch, drumset->pans[ch]);
+      AudioMixer_SetEnvelope(ch, drumset->holds[ch], drumset->decays[ch]);
+      AudioMixer_SetFilter(ch, drumset->filter_modes[ch], drumset->cutoffs[ch],
+                           drumset->resonances[ch]);
+    }
+    release_channel(target, ch);
+  }
+
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    DRKChannel *c = &drk_header.channels[ch];
+    c->path[DRK_PATH_LEN - 1] = '\0';
+
+    if (c->data_sector == 0 || c->length == 0) {
+      unbind_channel(target, ch);
+      continue;
+    }
+
+    SampleCache_AddRef(handle);
+    target->handles[ch] = handle;
+    target->ids[ch].first_cluster = baked_file->first_cluster;
+    target->ids[ch].size = baked_file->size;
+
+    drumset->samples[ch] = SampleCache_GetData(handle) +
+                           (c->data_sector - 1) * samples_per_sector;
+    drumset->lengths[ch] = c->length;
+
+    strncpy(drumset->sample_paths[ch], c->path, 63);
+    drumset->sample_paths[ch][63] = '\0';
+
+    /* Label from the file part of the path (without extension) */
+    const char *fname = strrchr(c->path, '/');
+    fname = fname ? fname + 1 : c->path;
+    strncpy(drumset->sample_names[ch], fname,
+            sizeof(drumset->sample_names[ch]) - 1);
+    drumset->sample_names[ch][sizeof(drumset->sample_names[ch]) - 1] = '\0';
+    char *dot = strchr(drumset->sample_names[ch], '.');
+    if (dot)
+      *dot = '\0';
+
+    if (target->live) {
+      AudioMixer_SetSample(ch, drumset->samples[ch], c->length);
+    }
+  }
+
+  /* Drop the loader's own reference; channels keep theirs */
+  SampleCache_Release(handle);
+  return 0;
+}
+
+/* Directory lookups memoized for the duration of one kit load */
+#define DIR_MEMO_SIZE 4
+
+typedef struct {
+  uint32_t parent;
+  uint32_t cluster;
+  char name[FAT32_FILENAME_LEN];
+} DirMemo;
+
+static DirMemo dir_memo[DIR_MEMO_SIZE];
+static int dir_memo_count = 0;
+
+/* Last listed directory (kits usually pull all samples from one folder) */
+static FAT32_FileEntry listed_files[FAT32_MAX_FILES];
+static int listed_count = 0;
+static uint32_t listed_cluster = 0;
+
+static void reset_lookup_memo(void) {
+  dir_memo_count = 0;
+  listed_cluster = 0;
+  listed_count = 0;
+}
+
+static uint32_t find_dir_memo(uint32_t parent, const char *name) {
+  for (int i = 0; i < dir_memo_count; i++) {
+    if (dir_memo[i].parent == parent &&
+        strcasecmp(dir_memo[i].name, name) == 0) {
+      return dir_memo[i].cluster;
+    }
+  }
+
+  uint32_t cluster = FAT32_FindDir(parent, name);
+  if (cluster != 0 && dir_memo_count < DIR_MEMO_SIZE) {
+    dir_memo[dir_memo_count].parent = parent;
+    dir_memo[dir_memo_count].cluster = cluster;
+    strncpy(dir_memo[dir_memo_count].name, name, FAT32_FILENAME_LEN - 1);
+    dir_memo[dir_memo_count].name[FAT32_FILENAME_LEN - 1] = '\0';
+    dir_memo_count++;
+  }
+  return cluster;
+}
+
+static int find_file_memo(uint32_t dir_cluster, const char *name,
+                          FAT32_FileEntry *out) {
+  if (dir_cluster != listed_cluster) {
+    listed_count = FAT32_ListDir(dir_cluster, listed_files, FAT32_MAX_FILES);
+    listed_cluster = (listed_count >= 0) ? dir_cluster : 0;
+  }
+
+  for (int f = 0; f < listed_count; f++) {
+    if (strcasecmp(listed_files[f].name, name) == 0) {
+      *out = listed_files[f];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Resolve a kit sample path to its directory entry
+ * @details Tries the stored path first, then falls back to SAMPLES/<name>
+ * @param sample_path Path relative to SD root (or bare name in SAMPLES/)
+ * @param out File entry of the sample
+ * @return 1 if found, 0 otherwise
+ */
+static int resolve_sample_path(const char *sample_path, FAT32_FileEntry *out) {
+  /* Check if path contains '/' */
+  const char *last_slash = strrchr(sample_path, '/');
+  if (last_slash) {
+    // Path traversal logic
+    uint32_t curr_clus = FAT32_GetRootCluster();
+
+    char path_copy[64];
+    strncpy(path_copy, sample_path, 63);
+    path_copy[63] = '\0';
+
+    char *token = strtok(path_copy, "/");
+    int found_path = 1;
+    char file_name[16] = {0};
+
+    while (token != NULL) {
+      if (strchr(token, '.') != NULL) {
+        // This is the file
+        strncpy(file_name, token, 15);
+        break;
+      }
+
+      // This is a directory
+      curr_clus = find_dir_memo(curr_clus, token);
+      if (curr_clus == 0) {
+        found_path = 0;
+        break;
+      }
+      token = strtok(NULL, "/");
+    }
+
+    if (found_path && strlen(file_name) > 0 &&
+        find_file_memo(curr_clus, file_name, out)) {
+      return 1;
+    }
+  }
+
+  // Fallback (and legacy paths): look for the bare filename in SAMPLES/
+  const char *fname = last_slash ? last_slash + 1 : sample_path;
+  uint32_t samples_clus = find_dir_memo(FAT32_GetRootCluster(), "SAMPLES");
+  if (samples_clus && find_file_memo(samples_clus, fname, out)) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Load KIT-XXX.DRK or KIT-XXX.DRM into a kit target
+ * @return 0 on success, -1 on error
+ */
+static int load_kit(KitTarget *target, uint8_t slot) {
+  Drumset *drumset = target->drumset;
+
   // Find DRUMSETS directory
   uint32_t drumsets_cluster = FAT32_FindDir(FAT32_GetRootCluster(), "DRUMSETS");
   if (drumsets_cluster == 0) {
@@ -262,23 +742,29 @@ int Drumset_LoadFromSlot(Drumset *drumset, uint8_t slot) {
   char filename[13];
   snprintf(filename, sizeof(filename), "KIT-%03d.DRM", slot);
 
-  // Check if file exists
-  if (!FAT32_FileExists(drumsets_cluster, filename)) {
-    return -1;
-  }
-
-  // Find the file entry to read it
+  // Find the file entry to read it (missing file -> not in listing)
   FAT32_FileEntry files[FAT32_MAX_FILES];
   int count = FAT32_ListDir(drumsets_cluster, files, FAT32_MAX_FILES);
 
+  char baked_name[13];
+  snprintf(baked_name, sizeof(baked_name), "KIT-%03d.DRK", slot);
+
   FAT32_FileEntry *target_file = NULL;
+  FAT32_FileEntry *baked_file = NULL;
   for (int i = 0; i < count; i++) {
     if (strcasecmp(files[i].name, filename) == 0) {
       target_file = &files[i];
-      break;
+    } else if (strcasecmp(files[i].name, baked_name) == 0) {
+      baked_file = &files[i];
     }
   }
 
+  // Baked kit: single multi-block read, falls back to .DRM if unusable
+  if (baked_file && load_baked(target, baked_file) == 0) {
+    snprintf(drumset->name, sizeof(drumset->name), "KIT-%03d", slot);
+    return 0;
+  }
+
   if (!target_file) {
     return -1;
   }
@@ -294,157 +780,165 @@ int Drumset_LoadFromSlot(Drumset *drumset, uint8_t slot) {
   // Null-terminate to prevent parsing junk in the rest of the sector
   if (target_file->size < 512) {
     buffer[target_file->size] = '\0';
+  } else {
+    buffer[511] = '\0';
   }
 
-  // Parse text format
+  // Pass 1: parse all lines and apply mixer settings immediately
+  char paths[NUM_CHANNELS][64];
+  int parsed_channels = 0;
+
   char *line = (char *)buffer;
   for (int ch = 0; ch < NUM_CHANNELS; ch++) {
     int channel_num;
-    char sample_path[64];
     int volume, pan;
+    int hold = 0, decay = 0;
+    int filter = AUDIO_FILTER_OFF, cutoff = 255, resonance = 0;
 
-    // Parse line: channel,sample_path,volume,pan
-    int parsed = sscanf(line, "%d,%63[^,],%d,%d", &channel_num, sample_path,
-                        &volume, &pan);
+    // Parse line: channel,sample_path,volume,pan[,hold,decay[,filter,cutoff,
+    // resonance]]
+    int parsed = sscanf(line, "%d,%63[^,],%d,%d,%d,%d,%d,%d,%d", &channel_num,
+                        paths[ch], &volume, &pan, &hold, &decay, &filter,
+                        &cutoff, &resonance);
 
-    if (parsed != 4 || channel_num != ch) {
-      // Allow partial reads or end of file? If error, maybe stop or continue?
-      // For robustness, try next line? But format is strict.
-      // If parsing failed, maybe buffer ended?
+    if ((parsed != 4 && parsed != 6 && parsed != 9) || channel_num != ch ||
+        filter < AUDIO_FILTER_OFF || filter > AUDIO_FILTER_HP) {
       break;
     }
 
-    // Set volume and pan
+    // Set volume, pan, envelope and filter
     drumset->volumes[ch] = volume;
     drumset->pans[ch] = pan;
+    drumset->holds[ch] = hold;
+    drumset->decays[ch] = decay;
+    drumset->filter_modes[ch] = filter;
+    drumset->cutoffs[ch] = cutoff;
+    drumset->resonances[ch] = resonance;
 
     // Apply to AudioMixer
-    AudioMixer_SetVolume(ch, volume);
-    AudioMixer_SetPan(ch, pan);
+    if (target->live) {
+      AudioMixer_SetVolume(ch, volume);
+      AudioMixer_SetPan(ch, pan);
+      AudioMixer_SetEnvelope(ch, hold, decay);
+      AudioMixer_SetFilter(ch, filter, cutoff, resonance);
+    }
+    parsed_channels++;
 
-    // Load sample
-    if (strcmp(sample_path, "EMPTY") == 0) {
-      WAV_UnloadChannel(ch, drumset);
+    // Move to next line
+    line = strchr(line, '\n');
+    if (line) {
+      line++; // Skip newline
     } else {
+      break;
+    }
+  }
+
+  // Pass 2: only stream channels whose resolved file differs
+  reset_lookup_memo();
+
+  for (int ch = 0; ch < parsed_channels; ch++) {
+    if (strcmp(paths[ch], "EMPTY") == 0) {
+      unbind_channel(target, ch);
+      continue;
+    }
+
+    static FAT32_FileEntry sample_file;
+    int loaded = 0;
+
+    if (resolve_sample_path(paths[ch], &sample_file)) {
+      if (target->handles[ch] >= 0 &&
+          target->ids[ch].first_cluster == sample_file.first_cluster &&
+          target->ids[ch].size == sample_file.size) {
+        loaded = 1; /* Same file already playing on this channel */
+      } else if (bind_sample(target, &sample_file, ch) > 0) {
+        loaded = 1;
+      }
+    }
+
+    if (loaded) {
       /* Store path */
-      strncpy(drumset->sample_paths[ch], sample_path, 63);
+      strncpy(drumset->sample_paths[ch], paths[ch], 63);
       drumset->sample_paths[ch][63] = '\0';
+    } else {
+      unbind_channel(target, ch);
+      drumset->volumes[ch] = 255;
+      drumset->pans[ch] = 128;
+      drumset->holds[ch] = 0;
+      drumset->decays[ch] = 0;
+      drumset->filter_modes[ch] = AUDIO_FILTER_OFF;
+      drumset->cutoffs[ch] = 255;
+      drumset->resonances[ch] = 0;
+    }
+  }
 
-      int loaded = 0;
+  // Set Kit Name
+  snprintf(drumset->name, sizeof(drumset->name), "KIT-%03d", slot);
 
-      /* Check if path contains '/' */
-      const char *last_slash = strrchr(sample_path, '/');
-      if (last_slash) {
-        // Path traversal logic
-        uint32_t curr_clus = FAT32_GetRootCluster();
+  return 0;
+}
 
-        char path_copy[64];
-        strncpy(path_copy, sample_path, 63);
-        path_copy[63] = '\0';
+int Drumset_LoadFromSlot(Drumset *drumset, uint8_t slot) {
+  if (slot < 1 || slot > 100) {
+    return -1;
+  }
 
-        char *token = strtok(path_copy, "/");
-        int found_path = 1;
-        char file_name[16] = {0};
+  KitTarget target = live_target(drumset);
+  return load_kit(&target, slot);
+}
 
-        while (token != NULL) {
-          if (strchr(token, '.') != NULL) {
-            // This is the file
-            strncpy(file_name, token, 15);
-            break;
-          }
+void Drumset_DropStaged(void) {
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    SampleCache_Release(staged_handles[ch]);
+    staged_handles[ch] = -1;
+  }
+  staged_slot = 0;
+}
 
-          // This is a directory
-          curr_clus = FAT32_FindDir(curr_clus, token);
-          if (curr_clus == 0) {
-            found_path = 0;
-            break;
-          }
-          token = strtok(NULL, "/");
-        }
+int Drumset_Stage(uint8_t slot) {
+  if (slot < 1 || slot > 100) {
+    return -1;
+  }
 
-        if (found_path && strlen(file_name) > 0) {
-          static FAT32_FileEntry sample_file;
-          FAT32_FileEntry dir_files[FAT32_MAX_FILES];
-          int cnt = FAT32_ListDir(curr_clus, dir_files, FAT32_MAX_FILES);
-          int found_file = 0;
-          for (int f = 0; f < cnt; f++) {
-            if (strcasecmp(dir_files[f].name, file_name) == 0) {
-              sample_file = dir_files[f];
-              found_file = 1;
-              break;
-            }
-          }
+  Drumset_DropStaged();
 
-          if (found_file) {
-            if (WAV_LoadSample(&sample_file, ch, drumset) > 0) {
-              loaded = 1;
-            }
-          }
-        }
+  memset(&staged_drumset, 0, sizeof(staged_drumset));
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    strcpy(staged_drumset.sample_names[ch], "EMPTY");
+    staged_drumset.volumes[ch] = 255;
+    staged_drumset.pans[ch] = 128;
+    staged_drumset.cutoffs[ch] = 255;
+  }
 
-      } else {
-        // Fallback to SAMPLES/ lookup
-        uint32_t samples_clus =
-            FAT32_FindDir(FAT32_GetRootCluster(), "SAMPLES");
-        if (samples_clus) {
-          FAT32_FileEntry dir_files[FAT32_MAX_FILES];
-          int cnt = FAT32_ListDir(samples_clus, dir_files, FAT32_MAX_FILES);
-          for (int f = 0; f < cnt; f++) {
-            if (strcasecmp(dir_files[f].name, sample_path) == 0) {
-              if (WAV_LoadSample(&dir_files[f], ch, drumset) > 0) {
-                loaded = 1;
-              }
-              break;
-            }
-          }
-        }
-      }
+  /* Same loader as the live kit, but nothing reaches the mixer */
+  KitTarget target = {&staged_drumset, staged_handles, staged_ids, 0};
+  if (load_kit(&target, slot) != 0) {
+    Drumset_DropStaged();
+    return -1;
+  }
 
-      if (!loaded) {
-        // Legacy Fallback: Try extracting filename and looking in SAMPLES/
-        // Ensure we don't try if we already tried SAMPLES/ above
-        const char *fname = strrchr(sample_path, '/');
-        if (fname)
-          fname++;
-        else
-          fname = sample_path;
-
-        uint32_t samples_clus =
-            FAT32_FindDir(FAT32_GetRootCluster(), "SAMPLES");
-        if (samples_clus) {
-          static FAT32_FileEntry dir_files[FAT32_MAX_FILES];
-          int cnt = FAT32_ListDir(samples_clus, dir_files, FAT32_MAX_FILES);
-          for (int f = 0; f < cnt; f++) {
-            if (strcasecmp(dir_files[f].name, fname) == 0) {
-              if (WAV_LoadSample(&dir_files[f], ch, drumset) > 0) {
-                loaded = 1;
-              }
-              break;
-            }
-          }
-        }
-      }
+  staged_slot = slot;
+  return 0;
+}
 
-      if (!loaded) {
-        WAV_UnloadChannel(ch, drumset);
-        drumset->volumes[ch] = 255;
-        drumset->pans[ch] = 128;
-      }
-    }
+const Drumset *Drumset_GetStaged(void) {
+  return staged_slot ? &staged_drumset : NULL;
+}
 
-    // Move to next line
-    line = strchr(line, '\n');
-    if (line) {
-      line++; // Skip newline
-    } else {
-      break;
-    }
+void Drumset_CommitStaged(Drumset *drumset) {
+  if (!staged_slot) {
+    return;
   }
 
-  // Set Kit Name
-  snprintf(drumset->name, sizeof(drumset->name), "KIT-%03d", slot);
+  /* Mixer already plays the staged samples; only hand over the references */
+  for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+    SampleCache_Release(channel_handles[ch]);
+    channel_handles[ch] = staged_handles[ch];
+    channel_ids[ch] = staged_ids[ch];
+    staged_handles[ch] = -1;
+  }
 
-  return 0;
+  memcpy(drumset, &staged_drumset, sizeof(Drumset));
+  staged_slot = 0;
 }
 
 int Drumset_GetOccupiedSlots(uint8_t *slots, int max_slots) {
@@ -460,13 +954,23 @@ int Drumset_GetOccupiedSlots(uint8_t *slots, int max_slots) {
   int occupied_count = 0;
 
   for (int i = 0; i < count && occupied_count < max_slots; i++) {
-    // Check if filename matches KIT-XXX.DRM pattern
+    // Check if filename matches KIT-XXX.DRM / KIT-XXX.DRK pattern
     if (strncmp(files[i].name, "KIT-", 4) == 0) {
       // Extract slot number
       int slot_num;
       if (sscanf(files[i].name + 4, "%d", &slot_num) == 1) {
         if (slot_num >= 1 && slot_num <= 100) {
-          slots[occupied_count++] = slot_num;
+          // A baked kit and its .DRM share one slot
+          int listed = 0;
+          for (int j = 0; j < occupied_count; j++) {
+            if (slots[j] == slot_num) {
+              listed = 1;
+              break;
+            }
+          }
+          if (!listed) {
+            slots[occupied_count++] = slot_num;
+          }
         }
       }
     }
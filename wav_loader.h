@@ -15,6 +15,11 @@ typedef struct {
   uint32_t lengths[NUM_CHANNELS];
   uint8_t volumes[NUM_CHANNELS];
   uint8_t pans[NUM_CHANNELS];
+  uint8_t holds[NUM_CHANNELS];  /* Envelope hold, 10ms units */
+  uint8_t decays[NUM_CHANNELS]; /* Envelope decay, 10ms units (0=off) */
+  uint8_t filter_modes[NUM_CHANNELS]; /* AUDIO_FILTER_* */
+  uint8_t cutoffs[NUM_CHANNELS];      /* 0-255 (20Hz-18kHz) */
+  uint8_t resonances[NUM_CHANNELS];   /* 0-255 */
   char sample_names[NUM_CHANNELS][16];
   char sample_paths[NUM_CHANNELS][64];
 } Drumset;
@@ -44,14 +49,54 @@ void WAV_UnloadChannel(uint8_t channel, Drumset *drumset);
  */
 int Drumset_Save(Drumset *drumset, uint8_t slot);
 
+/**
+ * @brief Save drumset and write a baked copy (KIT-XXX.DRK) to a slot
+ * @details The baked file holds all PCM in one contiguous file so the kit
+ *          loads with a single multi-block read.
+ * @param drumset Drumset to bake
+ * @param slot Slot number (1-100)
+ * @return 0 on success, negative on error
+ */
+int Drumset_Bake(Drumset *drumset, uint8_t slot);
+
 /**
  * @brief Load drumset from a slot
+ * @details Prefers KIT-XXX.DRK when present and usable, else KIT-XXX.DRM
  * @param drumset Drumset structure to load into
  * @param slot Slot number (1-100)
  * @return 0 on success, -1 on error
  */
 int Drumset_LoadFromSlot(Drumset *drumset, uint8_t slot);
 
+/**
+ * @brief Load a kit into the staging area without touching the mixer
+ * @details Samples are pulled into the sample cache and held there, so the
+ *          kit can be switched in at a pattern boundary with no SD access.
+ *          Replaces any previously staged kit.
+ * @param slot Slot number (1-100)
+ * @return 0 on success, -1 on error
+ */
+int Drumset_Stage(uint8_t slot);
+
+/**
+ * @brief Get the staged kit
+ * @return Staged drumset, NULL if nothing is staged
+ */
+const Drumset *Drumset_GetStaged(void);
+
+/**
+ * @brief Make the staged kit the live kit
+ * @details Only transfers ownership; the caller must already have pointed
+ *          the mixer at the staged samples (e.g. via Sequencer_QueueKit).
+ * @param drumset Live drumset structure to overwrite
+ */
+void Drumset_CommitStaged(Drumset *drumset);
+
+/**
+ * @brief Discard the staged kit and release its samples
+ */
+void Drumset_DropStaged(void);
+
 /**
  * @brief Get list of occupied slots
  * @param slots Array to store occupied slot numbers